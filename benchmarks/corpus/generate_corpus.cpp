@@ -0,0 +1,290 @@
+// Writes a synthetic Lox program of a requested size, for measuring how
+// the scanner and parser scale. The same seed and options always give
+// the same bytes: the generator draws from mt19937_64, whose output the
+// standard fixes, and never from the library's distributions.
+//
+// Usage: cpplox_corpus [--size=N[K|M|G]] [--seed=N] [--depth=N]
+//                      [--string-length=N] [--identifiers=W] [--nesting=W]
+//                      [--strings=W] [--comments=W] [--numbers=W] [output]
+//
+// The weights pick how often each kind of statement is written:
+//   identifiers  `var name = other.field(arg, arg) + name;`
+//   nesting      an expression parenthesized up to --depth levels deep;
+//                --depth is capped at the deepest the parser accepts
+//   strings      `print "...";` around --string-length characters long
+//   comments     a `//` line of words
+//   numbers      a declaration summing integer and decimal literals
+// Every program is valid Lox that parses cleanly; running it is another
+// matter, as names are declared in no particular order.
+
+// std
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// User defined
+#include "Parser.hpp"
+
+namespace {
+
+struct Options {
+  uint64_t size = 1 << 20;
+  uint64_t seed = 1;
+  uint64_t depth = 32;
+  uint64_t string_length = 256;
+  // identifiers, nesting, strings, comments, numbers
+  uint64_t weights[5] = {4, 1, 1, 1, 2};
+  std::string output = "-";
+};
+
+uint64_t ParseCount(const std::string &text) {
+  size_t end = 0;
+  uint64_t count = std::stoull(text, &end);
+  std::string suffix = text.substr(end);
+  if (suffix == "K" || suffix == "k") return count << 10;
+  if (suffix == "M" || suffix == "m") return count << 20;
+  if (suffix == "G" || suffix == "g") return count << 30;
+  if (!suffix.empty()) {
+    throw std::invalid_argument("Bad count: " + text);
+  }
+  return count;
+}
+
+class Generator {
+ public:
+  Generator(const Options &options, std::FILE *out)
+      : _options(options), _out(out), _random(options.seed) {
+    for (uint64_t weight : options.weights) _total_weight += weight;
+    if (_total_weight == 0) {
+      throw std::invalid_argument("At least one weight must be positive");
+    }
+  }
+
+  void Run() {
+    while (_written + _buffer.size() < _options.size) {
+      Statement();
+      if (_buffer.size() >= FLUSH_SIZE) Flush();
+    }
+    Flush();
+  }
+
+ private:
+  static constexpr size_t FLUSH_SIZE = 1 << 20;
+
+  // Uniform in [0, n); the slight modulo bias does not matter here
+  [[gnu::always_inline]] uint64_t Below(uint64_t n) { return _random() % n; }
+
+  void Statement() {
+    uint64_t pick = Below(_total_weight);
+    size_t kind = 0;
+    while (pick >= _options.weights[kind]) pick -= _options.weights[kind++];
+
+    switch (kind) {
+      case 0:
+        Identifiers();
+        break;
+      case 1:
+        Nesting();
+        break;
+      case 2:
+        String();
+        break;
+      case 3:
+        Comment();
+        break;
+      default:
+        Numbers();
+        break;
+    }
+  }
+
+  // A name of 1 to 16 letters, digits and underscores that is not a
+  // keyword
+  void Identifier() {
+    static const char *keywords[] = {
+        "and", "class", "else", "false", "for",  "fun",   "if",   "nil",
+        "or",  "print", "return", "super", "this", "true", "var", "while"};
+    static const char letters[] =
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_";
+    static const char rest[] =
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+
+    size_t start = _buffer.size();
+    _buffer += letters[Below(sizeof(letters) - 1)];
+    for (uint64_t i = Below(16); i > 0; i--) {
+      _buffer += rest[Below(sizeof(rest) - 1)];
+    }
+    std::string_view name(_buffer.data() + start, _buffer.size() - start);
+    for (const char *keyword : keywords) {
+      if (name == keyword) {
+        _buffer += '_';
+        break;
+      }
+    }
+  }
+
+  void Number() {
+    _buffer += std::to_string(Below(1000000));
+    if (Below(2)) {
+      _buffer += '.';
+      _buffer += std::to_string(Below(1000));
+    }
+  }
+
+  void Identifiers() {
+    _buffer += "var ";
+    Identifier();
+    _buffer += " = ";
+    Identifier();
+    _buffer += '.';
+    Identifier();
+    _buffer += '(';
+    Identifier();
+    _buffer += ", ";
+    Identifier();
+    _buffer += ") + ";
+    Identifier();
+    _buffer += ";\n";
+  }
+
+  // ((((a + 1) * b) - 2) ...): each level adds a pair of parentheses and
+  // one binary operator around the levels inside it
+  void Nesting() {
+    static const char *ops[] = {" + ", " - ", " * ", " / ", " < ", " == ",
+                                " and ", " or "};
+    uint64_t depth = 1 + Below(_options.depth);
+    _buffer += "var ";
+    Identifier();
+    _buffer += " = ";
+    _buffer.append(depth, '(');
+    Identifier();
+    for (uint64_t i = 0; i < depth; i++) {
+      _buffer += ops[Below(sizeof(ops) / sizeof(ops[0]))];
+      if (Below(2)) {
+        Identifier();
+      } else {
+        Number();
+      }
+      _buffer += ')';
+    }
+    _buffer += ";\n";
+  }
+
+  void String() {
+    static const char characters[] =
+        "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ 0123456789"
+        " .,;:!?-+*/()[]{}<>=_#@$%^&'\\\t";
+    uint64_t length = _options.string_length / 2 +
+                      Below(_options.string_length + 1);
+    _buffer += "print \"";
+    for (uint64_t i = 0; i < length; i++) {
+      // Strings may span lines
+      _buffer += Below(128) == 0 ? '\n'
+                                 : characters[Below(sizeof(characters) - 1)];
+    }
+    _buffer += "\";\n";
+  }
+
+  void Comment() {
+    _buffer += "//";
+    for (uint64_t words = 1 + Below(12); words > 0; words--) {
+      _buffer += ' ';
+      Identifier();
+    }
+    _buffer += '\n';
+  }
+
+  void Numbers() {
+    _buffer += "var ";
+    Identifier();
+    _buffer += " = ";
+    Number();
+    for (uint64_t terms = Below(6); terms > 0; terms--) {
+      _buffer += Below(2) ? " + " : " * ";
+      Number();
+    }
+    _buffer += ";\n";
+  }
+
+  void Flush() {
+    if (std::fwrite(_buffer.data(), 1, _buffer.size(), _out) !=
+        _buffer.size()) {
+      throw std::runtime_error("Error writing output");
+    }
+    _written += _buffer.size();
+    _buffer.clear();
+  }
+
+  const Options &_options;
+  std::FILE *_out;
+  std::mt19937_64 _random;
+  uint64_t _total_weight = 0;
+  uint64_t _written = 0;
+  std::string _buffer;
+};
+
+}  // namespace
+
+int main(int argc, const char *argv[]) {
+  try {
+    static const char *kinds[] = {"--identifiers=", "--nesting=",
+                                  "--strings=", "--comments=", "--numbers="};
+    Options options;
+    std::vector<std::string> args(argv + 1, argv + argc);
+    for (const std::string &arg : args) {
+      bool weight = false;
+      for (size_t i = 0; i < 5; i++) {
+        if (arg.starts_with(kinds[i])) {
+          options.weights[i] = ParseCount(arg.substr(arg.find('=') + 1));
+          weight = true;
+        }
+      }
+      if (weight) continue;
+
+      if (arg.starts_with("--size=")) {
+        options.size = ParseCount(arg.substr(sizeof("--size=") - 1));
+      } else if (arg.starts_with("--seed=")) {
+        options.seed = ParseCount(arg.substr(sizeof("--seed=") - 1));
+      } else if (arg.starts_with("--depth=")) {
+        options.depth = ParseCount(arg.substr(sizeof("--depth=") - 1));
+      } else if (arg.starts_with("--string-length=")) {
+        options.string_length =
+            ParseCount(arg.substr(sizeof("--string-length=") - 1));
+      } else if (!arg.starts_with("--")) {
+        options.output = arg;
+      } else {
+        throw std::invalid_argument(
+            "Usage: cpplox_corpus [--size=N[K|M|G]] [--seed=N] [--depth=N]\n"
+            "                     [--string-length=N] [--identifiers=W]\n"
+            "                     [--nesting=W] [--strings=W]\n"
+            "                     [--comments=W] [--numbers=W] [output]\n"
+            "--depth is capped at " +
+            std::to_string(Parser::MAX_NESTING - 1) +
+            ", the deepest nesting the parser accepts");
+      }
+    }
+    // The declaration's initializer is a level of its own
+    options.depth = std::clamp<uint64_t>(options.depth, 1,
+                                         Parser::MAX_NESTING - 1);
+
+    std::FILE *out = options.output == "-"
+                         ? stdout
+                         : std::fopen(options.output.c_str(), "wb");
+    if (out == nullptr) {
+      throw std::runtime_error("Could not open " + options.output);
+    }
+    Generator(options, out).Run();
+    if (out != stdout && std::fclose(out) != 0) {
+      throw std::runtime_error("Error writing " + options.output);
+    }
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
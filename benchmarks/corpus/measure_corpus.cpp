@@ -0,0 +1,88 @@
+// Scans and parses one Lox file and prints a CSV row of how long each
+// phase took and how much memory the process needed, for plotting
+// against input size. Peak RSS covers the whole process, so measure one
+// file per run; `--header` prints the column names instead.
+//
+// Usage: cpplox_measure --header
+//        cpplox_measure file
+
+// std
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// User defined
+#include "Arena.hpp"
+#include "Error.hpp"
+#include "Parser.hpp"
+#include "Scanner.hpp"
+#include "Source.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double Seconds(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration<double>(end - start).count();
+}
+
+// In KiB; Linux reports ru_maxrss in kilobytes
+long PeakRss() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+}  // namespace
+
+int main(int argc, const char *argv[]) {
+  try {
+    std::string arg = argc == 2 ? argv[1] : "";
+    if (arg == "--header") {
+      std::cout << "bytes,tokens,scan_seconds,parse_seconds,scan_mb_s,"
+                   "parse_mb_s,tree_bytes,peak_rss_kb"
+                << std::endl;
+      return EXIT_SUCCESS;
+    }
+    if (arg.empty() || arg.starts_with("--")) {
+      throw std::invalid_argument(
+          "Usage: cpplox_measure --header\n"
+          "       cpplox_measure file");
+    }
+
+    Source source(arg);
+    std::ostringstream errors;
+    Error error(errors);
+
+    Clock::time_point start = Clock::now();
+    Scanner scanner(source.View(), &error);
+    const TokenBuffer &tokens = scanner.ScanTokens();
+    Clock::time_point scanned = Clock::now();
+    Arena arena;
+    Parser parser(tokens, arena, error);
+    StmtList statements = parser.Parse();
+    Clock::time_point parsed = Clock::now();
+    if (error.had_error) {
+      throw std::runtime_error("Error while parsing " + arg + "\n" +
+                               errors.str());
+    }
+
+    auto megabytes = static_cast<double>(source.View().size()) / (1 << 20);
+    double scan_seconds = Seconds(start, scanned);
+    double parse_seconds = Seconds(scanned, parsed);
+    std::cout << source.View().size() << ',' << tokens.Size() << ','
+              << scan_seconds << ',' << parse_seconds << ','
+              << megabytes / scan_seconds << ','
+              << megabytes / parse_seconds << ',' << arena.BytesUsed()
+              << ',' << PeakRss() << std::endl;
+    // Keep the tree alive until after the peak was read
+    static_cast<void>(statements);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,61 @@
+#!/usr/bin/env bash
+# Generates corpora of growing size, scans and parses each in its own
+# process and writes scaling.csv: throughput that falls as inputs grow
+# points at superlinear work, and peak RSS shows what each byte of source
+# costs. With gnuplot installed it also draws scaling.png.
+#
+# Usage: benchmarks/corpus/scaling.sh [build dir] [sizes...]
+# Generator options (weights, --depth, ...) can be passed through
+# CORPUS_FLAGS, and SEED picks the seed.
+set -eu
+
+BUILD="${1:-build}"
+shift || true
+SIZES="${*:-64K 256K 1M 4M 16M 64M 256M}"
+SEED="${SEED:-1}"
+CORPUS_FLAGS="${CORPUS_FLAGS:-}"
+
+GENERATE="$BUILD/cpplox_corpus"
+MEASURE="$BUILD/cpplox_measure"
+for tool in "$GENERATE" "$MEASURE"; do
+    if ! [ -x "$tool" ]; then
+        echo "Missing $tool: configure with --enable-benchmarks and build"
+        exit 1
+    fi
+done
+
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+
+OUT="scaling.csv"
+echo "size,$("$MEASURE" --header)" > "$OUT"
+for size in $SIZES; do
+    # shellcheck disable=SC2086
+    "$GENERATE" --size="$size" --seed="$SEED" $CORPUS_FLAGS "$WORK/corpus.lox"
+    echo "$size,$("$MEASURE" "$WORK/corpus.lox")" | tee -a "$OUT"
+    rm -f "$WORK/corpus.lox"
+done
+echo "Wrote $OUT"
+
+if which gnuplot >/dev/null 2>&1; then
+    gnuplot <<EOF
+set datafile separator ","
+set terminal pngcairo size 1200,500
+set output "scaling.png"
+set multiplot layout 1,2
+set logscale x 2
+set xlabel "source bytes"
+set key top left
+set title "Throughput"
+set ylabel "MiB/s"
+plot "$OUT" using 2:6 skip 1 with linespoints title "scan", \
+     "" using 2:7 skip 1 with linespoints title "parse"
+set title "Peak RSS"
+set ylabel "MiB"
+set logscale y 2
+plot "$OUT" using 2:(\$9 / 1024) skip 1 with linespoints title "peak RSS", \
+     "" using 2:(\$2 / 1048576) skip 1 with lines title "source size"
+unset multiplot
+EOF
+    echo "Wrote scaling.png"
+fi
@@ -0,0 +1,334 @@
+#include <benchmark/benchmark.h>
+#include <malloc.h>
+
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "Heap.hpp"
+#include "Interpreter.hpp"
+#include "Optimizer.hpp"
+#include "Parser.hpp"
+#include "Scanner.hpp"
+#include "VM.hpp"
+
+namespace {
+
+// The straightforward alternative to NaN-boxing: a 16-byte tagged union
+using VariantValue = std::variant<std::nullptr_t, bool, double, Obj *>;
+
+// Mostly numbers with a sprinkling of other values, as a dynamically typed
+// loop sees them
+template <typename V, typename MakeNumber, typename MakeOther>
+std::vector<V> MakeValues(MakeNumber number, MakeOther other) {
+  std::vector<V> values;
+  for (int i = 0; i < 4096; i++) {
+    values.push_back(i % 16 == 0 ? other(i) : number(i * 0.5));
+  }
+  return values;
+}
+
+void BM_ValueArithmeticNanBox(benchmark::State &state) {
+  auto values = MakeValues<Value>(
+      [](double d) { return Value::Number(d); },
+      [](int i) { return i % 32 == 0 ? Value::Nil() : Value::Bool(true); });
+
+  for (auto _ : state) {
+    Value sum = Value::Number(0);
+    for (Value value : values) {
+      if (value.IsNumber()) {
+        sum = Value::Number(sum.AsNumber() + value.AsNumber() * 2);
+      } else if (!value.IsFalsey()) {
+        sum = Value::Number(sum.AsNumber() + 1);
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                               values.size()));
+  state.counters["value_bytes"] = sizeof(Value);
+}
+BENCHMARK(BM_ValueArithmeticNanBox);
+
+void BM_ValueArithmeticVariant(benchmark::State &state) {
+  auto values = MakeValues<VariantValue>(
+      [](double d) { return VariantValue(d); },
+      [](int i) {
+        return i % 32 == 0 ? VariantValue(nullptr) : VariantValue(true);
+      });
+
+  for (auto _ : state) {
+    VariantValue sum = 0.0;
+    for (const VariantValue &value : values) {
+      if (auto *number = std::get_if<double>(&value)) {
+        sum = std::get<double>(sum) + *number * 2;
+      } else if (!std::holds_alternative<std::nullptr_t>(value) &&
+                 !(std::holds_alternative<bool>(value) &&
+                   !std::get<bool>(value))) {
+        sum = std::get<double>(sum) + 1;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                               values.size()));
+  state.counters["value_bytes"] = sizeof(VariantValue);
+}
+BENCHMARK(BM_ValueArithmeticVariant);
+
+// End to end: the tree-walker running a numeric loop and recursive calls
+// Same script on both engines; the VM run includes compiling it each time
+template <typename E>
+void BM_Fib(benchmark::State &state) {
+  const std::string source =
+      "fun fib(n) { if (n < 2) return n; return fib(n - 2) + fib(n - 1); }\n"
+      "var sum = 0;\n"
+      "for (var i = 0; i < 1000; i = i + 1) sum = sum + i * 2;\n"
+      "print fib(20) + sum;\n";
+  std::ostringstream out;
+  Error error(out);
+  Scanner scanner(source, &error);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+  StmtList statements = parser.Parse();
+
+  for (auto _ : state) {
+    E engine(error, out);
+    engine.Interpret(statements);
+    out.str("");
+  }
+}
+BENCHMARK(BM_Fib<Interpreter>)
+    ->Name("BM_TreeWalkFib")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Fib<VM>)->Name("BM_VMFib")->Unit(benchmark::kMillisecond);
+
+// A loop over constant subexpressions, as generated configuration scripts
+// write them; the argument turns constant folding on
+void BM_ConstantLoop(benchmark::State &state) {
+  const std::string source =
+      "var sum = 0;\n"
+      "for (var i = 0; i < 100 * 100; i = i + 1) {\n"
+      "  sum = sum + (60 * 60 * 24) / (2 + 2) - -1;\n"
+      "  if (!(\"debug\" == \"de\" + \"bug\") or sum < 0) print sum;\n"
+      "}\n";
+  std::ostringstream out;
+  Error error(out);
+  Scanner scanner(source, &error);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+  StmtList statements = parser.Parse();
+  if (state.range(0)) {
+    statements = Optimizer(arena).Optimize(statements);
+  }
+
+  for (auto _ : state) {
+    Interpreter interpreter(error, out);
+    interpreter.Interpret(statements);
+  }
+  state.counters["nodes"] = static_cast<double>(
+      Optimizer::CountNodes(statements));
+}
+BENCHMARK(BM_ConstantLoop)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// Field and method lookups by name plus string equality, which interning
+// turns into pointer hashing and comparison
+template <typename E>
+void BM_Properties(benchmark::State &state) {
+  const std::string source =
+      "class Point {\n"
+      "  init(x, y) { this.x = x; this.y = y; this.tag = \"point\"; }\n"
+      "  sum() { return this.x + this.y; }\n"
+      "}\n"
+      "var p = Point(1, 2);\n"
+      "var total = 0;\n"
+      "for (var i = 0; i < 5000; i = i + 1) {\n"
+      "  p.x = p.x + 1;\n"
+      "  if (p.tag == \"point\") total = total + p.sum();\n"
+      "}\n"
+      "print total;\n";
+  std::ostringstream out;
+  Error error(out);
+  Scanner scanner(source, &error);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+  StmtList statements = parser.Parse();
+
+  for (auto _ : state) {
+    E engine(error, out);
+    engine.Interpret(statements);
+    out.str("");
+  }
+}
+BENCHMARK(BM_Properties<Interpreter>)
+    ->Name("BM_TreeWalkProperties")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Properties<VM>)
+    ->Name("BM_VMProperties")
+    ->Unit(benchmark::kMillisecond);
+
+// After the classic method_call benchmark: two classes, one overriding
+// the other's method and calling it through `super`, toggled in a loop.
+// Every call goes through a monomorphic inline cache and is invoked
+// without making a bound method.
+template <typename E>
+void BM_MethodCall(benchmark::State &state) {
+  const std::string source =
+      "class Toggle {\n"
+      "  init(startState) { this.state = startState; }\n"
+      "  value() { return this.state; }\n"
+      "  activate() { this.state = !this.state; return this; }\n"
+      "}\n"
+      "class NthToggle < Toggle {\n"
+      "  init(startState, maxCounter) {\n"
+      "    super.init(startState);\n"
+      "    this.countMax = maxCounter;\n"
+      "    this.count = 0;\n"
+      "  }\n"
+      "  activate() {\n"
+      "    this.count = this.count + 1;\n"
+      "    if (this.count >= this.countMax) {\n"
+      "      super.activate();\n"
+      "      this.count = 0;\n"
+      "    }\n"
+      "    return this;\n"
+      "  }\n"
+      "}\n"
+      "var val = true;\n"
+      "var toggle = Toggle(val);\n"
+      "for (var i = 0; i < 2000; i = i + 1) {\n"
+      "  val = toggle.activate().value();\n"
+      "  val = toggle.activate().value();\n"
+      "  val = toggle.activate().value();\n"
+      "}\n"
+      "print toggle.value();\n"
+      "val = true;\n"
+      "var ntoggle = NthToggle(val, 3);\n"
+      "for (var i = 0; i < 2000; i = i + 1) {\n"
+      "  val = ntoggle.activate().value();\n"
+      "  val = ntoggle.activate().value();\n"
+      "  val = ntoggle.activate().value();\n"
+      "}\n"
+      "print ntoggle.value();\n";
+  std::ostringstream out;
+  Error error(out);
+  Scanner scanner(source, &error);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+  StmtList statements = parser.Parse();
+
+  double hit_rate = 0;
+  size_t elided = 0;
+  for (auto _ : state) {
+    E engine(error, out);
+    engine.Interpret(statements);
+    out.str("");
+    const InlineCache::Stats &stats = engine.GetCacheStats();
+    hit_rate = static_cast<double>(stats.hits) /
+               static_cast<double>(stats.hits + stats.misses);
+    elided = engine.GetHeap().GetStats().allocations_elided;
+  }
+  state.counters["ic_hit_rate"] = hit_rate;
+  state.counters["allocations_elided"] = static_cast<double>(elided);
+}
+BENCHMARK(BM_MethodCall<Interpreter>)
+    ->Name("BM_TreeWalkMethodCall")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MethodCall<VM>)
+    ->Name("BM_VMMethodCall")
+    ->Unit(benchmark::kMillisecond);
+
+// After the classic instantiation benchmark: each call site makes an
+// instance and looks up its initializer through the site's cache
+template <typename E>
+void BM_Instantiation(benchmark::State &state) {
+  const std::string source =
+      "class Foo { init() {} }\n"
+      "for (var i = 0; i < 2000; i = i + 1) {\n"
+      "  Foo(); Foo(); Foo(); Foo(); Foo();\n"
+      "  Foo(); Foo(); Foo(); Foo(); Foo();\n"
+      "}\n";
+  std::ostringstream out;
+  Error error(out);
+  Scanner scanner(source, &error);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+  StmtList statements = parser.Parse();
+
+  for (auto _ : state) {
+    E engine(error, out);
+    engine.Interpret(statements);
+  }
+}
+BENCHMARK(BM_Instantiation<Interpreter>)
+    ->Name("BM_TreeWalkInstantiation")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Instantiation<VM>)
+    ->Name("BM_VMInstantiation")
+    ->Unit(benchmark::kMillisecond);
+
+// Bytes malloc hands out for each instance with three fields, the object
+// itself included. Nothing is rooted, and nothing collected: the heap
+// never gets its roots.
+void BM_InstanceMemory(benchmark::State &state) {
+  constexpr size_t INSTANCES = 10000;
+  const Symbol *names[] = {Interner::Global().Intern("x"),
+                           Interner::Global().Intern("y"),
+                           Interner::Global().Intern("z")};
+  double bytes_per_instance = 0;
+  for (auto _ : state) {
+    Heap heap;
+    auto *klass = heap.Make<ObjClass>("Vec", nullptr);
+    size_t before = mallinfo2().uordblks;
+    for (size_t i = 0; i < INSTANCES; i++) {
+      auto *instance = heap.Make<ObjInstance>(klass);
+      for (const Symbol *name : names) {
+        instance->SetField(name, Value::Number(static_cast<double>(i)));
+      }
+    }
+    bytes_per_instance =
+        static_cast<double>(mallinfo2().uordblks - before) / INSTANCES;
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                               INSTANCES));
+  state.counters["bytes_per_instance"] = bytes_per_instance;
+}
+BENCHMARK(BM_InstanceMemory)->Unit(benchmark::kMillisecond);
+
+// Field reads and writes on instances that all share one layout; the
+// items are field accesses
+template <typename E>
+void BM_FieldAccess(benchmark::State &state) {
+  constexpr int64_t ACCESSES = 10000 * 8;
+  const std::string source =
+      "class Vec { init(x, y, z) { this.x = x; this.y = y; this.z = z; } }\n"
+      "var a = Vec(1, 2, 3);\n"
+      "var b = Vec(4, 5, 6);\n"
+      "for (var i = 0; i < 10000; i = i + 1) {\n"
+      "  a.x = a.y + b.z;\n"
+      "  b.y = b.x + a.z + a.x;\n"
+      "}\n"
+      "print a.x + b.y;\n";
+  std::ostringstream out;
+  Error error(out);
+  Scanner scanner(source, &error);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+  StmtList statements = parser.Parse();
+
+  for (auto _ : state) {
+    E engine(error, out);
+    engine.Interpret(statements);
+    out.str("");
+  }
+  state.SetItemsProcessed(state.iterations() * ACCESSES);
+}
+BENCHMARK(BM_FieldAccess<Interpreter>)
+    ->Name("BM_TreeWalkFieldAccess")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FieldAccess<VM>)
+    ->Name("BM_VMFieldAccess")
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+#include <robin_hood.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Keywords.hpp"
+#include "Scanner.hpp"
+
+namespace {
+
+// Identifier-heavy corpus: one keyword for every three plain names, with
+// plenty of near misses ("whale", "classy", "fn") that share a prefix.
+std::vector<std::string_view> MakeWords() {
+  static const char *words[] = {
+      "var",    "count",   "index",  "this",   "while",   "whale",
+      "i",      "total",   "fun",    "fn",     "classy",  "class",
+      "return", "result",  "or",     "order",  "printer", "print",
+      "nil",    "nothing", "x",      "super",  "superb",  "accumulator",
+      "if",     "iffy",    "and",    "android", "false",   "falsehood"};
+  std::vector<std::string_view> corpus;
+  for (int repeat = 0; repeat < 64; repeat++) {
+    for (const char *word : words) {
+      corpus.emplace_back(word);
+    }
+  }
+  return corpus;
+}
+
+void BM_ClassifyKeyword(benchmark::State &state) {
+  const auto corpus = MakeWords();
+  for (auto _ : state) {
+    for (auto word : corpus) {
+      benchmark::DoNotOptimize(ClassifyKeyword(word));
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                               corpus.size()));
+}
+BENCHMARK(BM_ClassifyKeyword);
+
+// What Scanner::Identifier used to do: allocate the text, then walk the
+// keyword map linearly with std::find_if
+void BM_ClassifyKeywordLinearMap(benchmark::State &state) {
+  const auto corpus = MakeWords();
+  robin_hood::unordered_flat_map<std::string, TokenType> keywords;
+  for (const auto &keyword : keyword_list) {
+    keywords.emplace(std::string(keyword.text), keyword.type);
+  }
+
+  for (auto _ : state) {
+    for (auto word : corpus) {
+      std::string text(word);
+      auto it = std::find_if(
+          keywords.begin(), keywords.end(),
+          [&](const auto &entry) { return entry.first == text; });
+      benchmark::DoNotOptimize(it == keywords.end() ? TokenType::IDENTIFIER
+                                                    : it->second);
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                               corpus.size()));
+}
+BENCHMARK(BM_ClassifyKeywordLinearMap);
+
+void BM_ScanIdentifiers(benchmark::State &state) {
+  std::string source;
+  for (auto word : MakeWords()) {
+    source += word;
+    source += ' ';
+  }
+
+  for (auto _ : state) {
+    Scanner scanner(source);
+    benchmark::DoNotOptimize(scanner.ScanTokens().Size());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(source.size()));
+}
+BENCHMARK(BM_ScanIdentifiers);
+
+}  // namespace
@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Scanner.hpp"
+
+namespace {
+
+// Numeric data tables: mostly fractional values with a few integers
+std::vector<std::string> MakeLiterals() {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> value(0.0, 100000.0);
+  std::vector<std::string> literals;
+  for (int i = 0; i < 4096; i++) {
+    double number = value(rng);
+    literals.push_back(i % 4 == 0 ? std::to_string(static_cast<int>(number))
+                                  : fmt::format("{:.6f}", number));
+  }
+  return literals;
+}
+
+void BM_ParseNumber(benchmark::State &state) {
+  const auto literals = MakeLiterals();
+  for (auto _ : state) {
+    for (const auto &literal : literals) {
+      benchmark::DoNotOptimize(Scanner::ParseNumber(literal));
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                               literals.size()));
+}
+BENCHMARK(BM_ParseNumber);
+
+// What Scanner::Number used to do
+void BM_ParseNumberStod(benchmark::State &state) {
+  const auto literals = MakeLiterals();
+  for (auto _ : state) {
+    for (const auto &literal : literals) {
+      std::string_view lexeme = literal;
+      benchmark::DoNotOptimize(std::stod(std::string(lexeme)));
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                               literals.size()));
+}
+BENCHMARK(BM_ParseNumberStod);
+
+void BM_ScanNumericTable(benchmark::State &state) {
+  std::string source = "var table = 0;\n";
+  for (const auto &literal : MakeLiterals()) {
+    source += "table = table + " + literal + " * " + literal + ";\n";
+  }
+
+  for (auto _ : state) {
+    Scanner scanner(source);
+    benchmark::DoNotOptimize(scanner.ScanTokens().Size());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(source.size()));
+}
+BENCHMARK(BM_ScanNumericTable);
+
+}  // namespace
@@ -0,0 +1,145 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include "Parser.hpp"
+#include "Scanner.hpp"
+
+namespace {
+
+// One flat expression of `terms` operands mixing every binary precedence
+// level, so the tree is a long left-deep chain.
+std::string MakeExpression(size_t terms) {
+  static const char *ops[] = {" + ", " * ", " - ", " / ", " < ", " == "};
+  constexpr size_t op_count = sizeof(ops) / sizeof(ops[0]);
+
+  std::string source = "1";
+  for (size_t i = 1; i < terms; i++) {
+    source += ops[i % op_count];
+    source += (i % 3 == 0) ? "-x" : std::to_string(i);
+  }
+  return source;
+}
+
+void BM_ParseExpression(benchmark::State &state) {
+  const size_t terms = static_cast<size_t>(state.range(0));
+  const std::string source = MakeExpression(terms);
+  Scanner scanner(source);
+  const TokenBuffer &tokens = scanner.ScanTokens();
+
+  std::ostringstream out;
+  Error error(out);
+  Arena arena;
+  size_t tree_bytes = 0;
+
+  for (auto _ : state) {
+    Parser parser(tokens, arena, error);
+    benchmark::DoNotOptimize(parser.ParseExpression());
+    tree_bytes = arena.BytesUsed();
+    arena.Reset();
+  }
+
+  state.counters["terms/s"] = benchmark::Counter(
+      static_cast<double>(terms * state.iterations()),
+      benchmark::Counter::kIsRate);
+  state.counters["tree_bytes"] = static_cast<double>(tree_bytes);
+}
+BENCHMARK(BM_ParseExpression)->Arg(1000)->Arg(100000);
+
+// A program of roughly `lines` lines in the shape of ordinary Lox code:
+// classes with methods, functions, loops, calls and property access
+std::string MakeProgram(size_t lines) {
+  static const char *unit =
+      "class Point%u < Base {\n"
+      "  init(x, y) {\n"
+      "    this.x = x;\n"
+      "    this.y = y;\n"
+      "  }\n"
+      "  add(other) {\n"
+      "    return Point%u(this.x + other.x, this.y + other.y);\n"
+      "  }\n"
+      "}\n"
+      "fun fib%u(n) {\n"
+      "  if (n < 2) return n;\n"
+      "  return fib%u(n - 2) + fib%u(n - 1);\n"
+      "}\n"
+      "var total%u = 0;\n"
+      "for (var i = 0; i < 100; i = i + 1) {\n"
+      "  // accumulate\n"
+      "  total%u = total%u + fib%u(i) * 2;\n"
+      "}\n"
+      "while (total%u > 10 and !done or false) total%u = total%u / 2;\n"
+      "print \"total: \" + total%u;\n";
+  constexpr size_t unit_lines = 19;
+
+  std::string source;
+  for (size_t i = 0; i * unit_lines < lines; i++) {
+    std::string id = std::to_string(i);
+    for (const char *c = unit; *c != '\0'; c++) {
+      if (c[0] == '%' && c[1] == 'u') {
+        source += id;
+        c++;
+      } else {
+        source += *c;
+      }
+    }
+  }
+  return source;
+}
+
+size_t CountLines(const std::string &source) {
+  return static_cast<size_t>(
+      std::count(source.begin(), source.end(), '\n'));
+}
+
+void BM_ParseProgram(benchmark::State &state) {
+  const std::string source = MakeProgram(static_cast<size_t>(state.range(0)));
+  const size_t lines = CountLines(source);
+  Scanner scanner(source);
+  const TokenBuffer &tokens = scanner.ScanTokens();
+
+  std::ostringstream out;
+  Error error(out);
+  Arena arena;
+
+  for (auto _ : state) {
+    Parser parser(tokens, arena, error);
+    benchmark::DoNotOptimize(parser.Parse().data());
+    arena.Reset();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(source.size()) *
+                          state.iterations());
+  state.counters["lines/s"] = benchmark::Counter(
+      static_cast<double>(lines * state.iterations()),
+      benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_ParseProgram)->Arg(10000)->Arg(1000000);
+
+// Scanning included, as `cpplox script` does it
+void BM_ScanAndParseProgram(benchmark::State &state) {
+  const std::string source = MakeProgram(static_cast<size_t>(state.range(0)));
+  const size_t lines = CountLines(source);
+
+  std::ostringstream out;
+  Error error(out);
+  Arena arena;
+
+  for (auto _ : state) {
+    Scanner scanner(source, &error);
+    Parser parser(scanner.ScanTokens(), arena, error);
+    benchmark::DoNotOptimize(parser.Parse().data());
+    arena.Reset();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(source.size()) *
+                          state.iterations());
+  state.counters["lines/s"] = benchmark::Counter(
+      static_cast<double>(lines * state.iterations()),
+      benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_ScanAndParseProgram)->Arg(10000)->Arg(1000000);
+
+}  // namespace
@@ -0,0 +1,208 @@
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+#include <string>
+
+#include "BytecodeCache.hpp"
+#include "Interpreter.hpp"
+#include "Parser.hpp"
+#include "Scanner.hpp"
+#include "VM.hpp"
+
+// The rest of the classic Lox benchmark programs, scaled down to run in
+// milliseconds on the tree-walker. fib, method_call and instantiation are
+// in bench_interpreter.cpp. Run with
+//   --benchmark_out=results.json --benchmark_out_format=json
+// (or build the cpplox_bench_json target) to keep results for comparing
+// versions; the bytecode format each run used is recorded in the context.
+
+namespace {
+
+[[maybe_unused]] const bool CONTEXT = [] {
+  benchmark::AddCustomContext(
+      "cpplox_compiler_version",
+      std::to_string(BytecodeCache::CompilerVersion()));
+  return true;
+}();
+
+// Parses `source` once and runs it on a fresh engine each iteration; the
+// VM run includes compiling it. Runs that fail are reported as errors
+// rather than timed.
+template <typename E>
+void RunProgram(benchmark::State &state, const std::string &source) {
+  std::ostringstream out;
+  Error error(out);
+  Scanner scanner(source, &error);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+  StmtList statements = parser.Parse();
+  if (error.had_error) {
+    state.SkipWithError("parse error");
+    return;
+  }
+
+  for (auto _ : state) {
+    E engine(error, out);
+    engine.Interpret(statements);
+    out.str("");
+  }
+  if (error.had_runtime_error) state.SkipWithError("runtime error");
+}
+
+// Builds and walks complete binary trees of instances: allocation and
+// collection heavy, with a long-lived tree kept across the short ones
+template <typename E>
+void BM_BinaryTrees(benchmark::State &state) {
+  RunProgram<E>(
+      state,
+      "class Tree {\n"
+      "  init(item, depth) {\n"
+      "    this.item = item;\n"
+      "    this.depth = depth;\n"
+      "    if (depth > 0) {\n"
+      "      var item2 = item + item;\n"
+      "      depth = depth - 1;\n"
+      "      this.left = Tree(item2 - 1, depth);\n"
+      "      this.right = Tree(item2, depth);\n"
+      "    } else {\n"
+      "      this.left = nil;\n"
+      "      this.right = nil;\n"
+      "    }\n"
+      "  }\n"
+      "  check() {\n"
+      "    if (this.left == nil) return this.item;\n"
+      "    return this.item + this.left.check() - this.right.check();\n"
+      "  }\n"
+      "}\n"
+      "var minDepth = 4;\n"
+      "var maxDepth = 8;\n"
+      "var stretchDepth = maxDepth + 1;\n"
+      "print Tree(0, stretchDepth).check();\n"
+      "var longLivedTree = Tree(0, maxDepth);\n"
+      "var iterations = 1;\n"
+      "var d = 0;\n"
+      "while (d < maxDepth) { iterations = iterations * 2; d = d + 1; }\n"
+      "var depth = minDepth;\n"
+      "while (depth < stretchDepth) {\n"
+      "  var check = 0;\n"
+      "  var i = 1;\n"
+      "  while (i <= iterations) {\n"
+      "    check = check + Tree(i, depth).check() + Tree(-i, depth).check();\n"
+      "    i = i + 1;\n"
+      "  }\n"
+      "  print check;\n"
+      "  iterations = iterations / 4;\n"
+      "  depth = depth + 2;\n"
+      "}\n"
+      "print longLivedTree.check();\n");
+}
+BENCHMARK(BM_BinaryTrees<Interpreter>)
+    ->Name("BM_TreeWalkBinaryTrees")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BinaryTrees<VM>)
+    ->Name("BM_VMBinaryTrees")
+    ->Unit(benchmark::kMillisecond);
+
+// Six methods on one instance called round-robin from one loop
+template <typename E>
+void BM_Zoo(benchmark::State &state) {
+  RunProgram<E>(
+      state,
+      "class Zoo {\n"
+      "  init() {\n"
+      "    this.aardvark = 1;\n"
+      "    this.baboon   = 1;\n"
+      "    this.cat      = 1;\n"
+      "    this.donkey   = 1;\n"
+      "    this.elephant = 1;\n"
+      "    this.fox      = 1;\n"
+      "  }\n"
+      "  ant()    { return this.aardvark; }\n"
+      "  banana() { return this.baboon; }\n"
+      "  tuna()   { return this.cat; }\n"
+      "  hay()    { return this.donkey; }\n"
+      "  grass()  { return this.elephant; }\n"
+      "  mouse()  { return this.fox; }\n"
+      "}\n"
+      "var zoo = Zoo();\n"
+      "var sum = 0;\n"
+      "while (sum < 60000) {\n"
+      "  sum = sum + zoo.ant()\n"
+      "            + zoo.banana()\n"
+      "            + zoo.tuna()\n"
+      "            + zoo.hay()\n"
+      "            + zoo.grass()\n"
+      "            + zoo.mouse();\n"
+      "}\n"
+      "print sum;\n");
+}
+BENCHMARK(BM_Zoo<Interpreter>)
+    ->Name("BM_TreeWalkZoo")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Zoo<VM>)->Name("BM_VMZoo")->Unit(benchmark::kMillisecond);
+
+// Equal and unequal strings of different lengths, and strings against
+// other types; interning makes each comparison a pointer check
+template <typename E>
+void BM_StringEquality(benchmark::State &state) {
+  RunProgram<E>(
+      state,
+      "var a1 = \"abc\";\n"
+      "var a2 = \"abcdefghijklmnopqrstuvwxyz\";\n"
+      "var a3 = \"abc\" + \"def\";\n"
+      "var b1 = \"abc\";\n"
+      "var b2 = \"abcdefghijklmnopqrstuvwxyz\";\n"
+      "var b3 = \"abcdef\";\n"
+      "var count = 0;\n"
+      "for (var i = 0; i < 10000; i = i + 1) {\n"
+      "  if (a1 == a1) count = count + 1;\n"
+      "  if (a1 == b1) count = count + 1;\n"
+      "  if (a2 == b2) count = count + 1;\n"
+      "  if (a3 == b3) count = count + 1;\n"
+      "  if (a1 == a2) count = count + 1;\n"
+      "  if (a2 == a3) count = count + 1;\n"
+      "  if (a1 == \"abc\") count = count + 1;\n"
+      "  if (a1 == nil) count = count + 1;\n"
+      "  if (a1 == 1) count = count + 1;\n"
+      "}\n"
+      "print count;\n");
+}
+BENCHMARK(BM_StringEquality<Interpreter>)
+    ->Name("BM_TreeWalkStringEquality")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_StringEquality<VM>)
+    ->Name("BM_VMStringEquality")
+    ->Unit(benchmark::kMillisecond);
+
+// `==` across every pairing of value types
+template <typename E>
+void BM_Equality(benchmark::State &state) {
+  RunProgram<E>(
+      state,
+      "var i = 0;\n"
+      "while (i < 10000) {\n"
+      "  i = i + 1;\n"
+      "  1; 1; 1; 2; 1; nil; 1; \"str\"; 1; true;\n"
+      "  nil; nil; nil; 1; nil; \"str\"; nil; true;\n"
+      "  true; true; true; 1; true; false; true; \"str\"; true; nil;\n"
+      "  \"str\"; \"str\"; \"str\"; \"stru\"; \"str\"; 1; \"str\"; nil;\n"
+      "}\n"
+      "i = 0;\n"
+      "while (i < 10000) {\n"
+      "  i = i + 1;\n"
+      "  1 == 1; 1 == 2; 1 == nil; 1 == \"str\"; 1 == true;\n"
+      "  nil == nil; nil == 1; nil == \"str\"; nil == true;\n"
+      "  true == true; true == 1; true == false; true == \"str\";\n"
+      "  true == nil;\n"
+      "  \"str\" == \"str\"; \"str\" == \"stru\"; \"str\" == 1;\n"
+      "  \"str\" == nil;\n"
+      "}\n");
+}
+BENCHMARK(BM_Equality<Interpreter>)
+    ->Name("BM_TreeWalkEquality")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Equality<VM>)
+    ->Name("BM_VMEquality")
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
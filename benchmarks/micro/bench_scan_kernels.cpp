@@ -0,0 +1,114 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "ScanKernels.hpp"
+#include "Scanner.hpp"
+
+namespace {
+
+// Heavily commented, data-heavy script: long comment lines, wide
+// indentation and long string literals
+std::string MakeCommentedSource(size_t lines) {
+  std::string source;
+  for (size_t i = 0; i < lines; i++) {
+    source +=
+        "        // configuration record, regenerated nightly; do not edit "
+        "by hand or the importer will overwrite it\n"
+        "        var name = \"lorem ipsum dolor sit amet, consectetur "
+        "adipiscing elit, sed do eiusmod tempor\";\n"
+        "\n";
+  }
+  return source;
+}
+
+const ScanKernels *Select(int64_t index) {
+  switch (index) {
+    case 0:
+      return &ScanKernels::Scalar();
+    case 1:
+      return ScanKernels::Sse2();
+    default:
+      return ScanKernels::Avx2();
+  }
+}
+
+void BM_FindNewline(benchmark::State &state) {
+  const ScanKernels *kernels = Select(state.range(0));
+  if (kernels == nullptr) {
+    state.SkipWithError("instruction set not available");
+    return;
+  }
+  std::string text(4096, 'x');
+  text.back() = '\n';
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        kernels->find_newline(text.data(), text.data() + text.size()));
+  }
+  state.SetLabel(kernels->name);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(text.size()));
+}
+BENCHMARK(BM_FindNewline)->DenseRange(0, 2);
+
+void BM_SkipWhitespace(benchmark::State &state) {
+  const ScanKernels *kernels = Select(state.range(0));
+  if (kernels == nullptr) {
+    state.SkipWithError("instruction set not available");
+    return;
+  }
+  std::string text;
+  for (int i = 0; i < 256; i++) {
+    text += "                \n\t\t\r\n";
+  }
+  text += 'x';
+
+  for (auto _ : state) {
+    uint32_t lines = 0;
+    benchmark::DoNotOptimize(kernels->skip_whitespace(
+        text.data(), text.data() + text.size(), lines));
+  }
+  state.SetLabel(kernels->name);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(text.size()));
+}
+BENCHMARK(BM_SkipWhitespace)->DenseRange(0, 2);
+
+void BM_FindQuote(benchmark::State &state) {
+  const ScanKernels *kernels = Select(state.range(0));
+  if (kernels == nullptr) {
+    state.SkipWithError("instruction set not available");
+    return;
+  }
+  std::string text;
+  for (int i = 0; i < 64; i++) {
+    text += "a long string literal body spanning lines\n";
+  }
+  text += '"';
+
+  for (auto _ : state) {
+    uint32_t lines = 0;
+    benchmark::DoNotOptimize(
+        kernels->find_quote(text.data(), text.data() + text.size(), lines));
+  }
+  state.SetLabel(kernels->name);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(text.size()));
+}
+BENCHMARK(BM_FindQuote)->DenseRange(0, 2);
+
+void BM_ScanCommentedSource(benchmark::State &state) {
+  const std::string source = MakeCommentedSource(1 << 14);
+
+  for (auto _ : state) {
+    Scanner scanner(source);
+    benchmark::DoNotOptimize(scanner.ScanTokens().Size());
+  }
+  state.SetLabel(ScanKernels::Get().name);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(source.size()));
+}
+BENCHMARK(BM_ScanCommentedSource);
+
+}  // namespace
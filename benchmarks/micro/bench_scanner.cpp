@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "Scanner.hpp"
+
+namespace {
+
+// Roughly the token mix of our generated scripts: lots of identifiers,
+// numbers and short strings, with the odd comment.
+std::string MakeSource(size_t lines) {
+  static const char *snippet[] = {
+      "var total = 0;\n",
+      "for (var i = 0; i < 100; i = i + 1) {\n",
+      "  total = total + i * 3.25; // accumulate\n",
+      "  print \"value of total is\" + total;\n",
+      "}\n",
+      "fun area(width, height) { return width * height; }\n",
+      "if (total >= 1000 and !(total == 42)) print area(total, 2);\n",
+  };
+  constexpr size_t snippet_count = sizeof(snippet) / sizeof(snippet[0]);
+
+  std::string source;
+  for (size_t i = 0; i < lines; i++) {
+    source += snippet[i % snippet_count];
+  }
+  return source;
+}
+
+void BM_ScanTokens(benchmark::State &state) {
+  const std::string source = MakeSource(static_cast<size_t>(state.range(0)));
+  size_t tokens = 0;
+
+  for (auto _ : state) {
+    Scanner scanner(source);
+    tokens += scanner.ScanTokens().Size();
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(source.size()));
+  state.counters["tokens/s"] = benchmark::Counter(
+      static_cast<double>(tokens), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_ScanTokens)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 17);
+
+}  // namespace
@@ -0,0 +1,109 @@
+#include <benchmark/benchmark.h>
+#include <stdlib.h>
+
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+#include "BytecodeCache.hpp"
+#include "Optimizer.hpp"
+#include "Parser.hpp"
+#include "Scanner.hpp"
+#include "VM.hpp"
+
+namespace {
+
+// A script of `units` classes and functions that does little at the top
+// level, like a cron job whose time goes into getting ready to run
+std::string MakeScript(size_t units) {
+  std::string source;
+  for (size_t i = 0; i < units; i++) {
+    std::string n = std::to_string(i);
+    source += "class Job" + n + " {\n"
+              "  init(name) { this.name = name; this.runs = 0; }\n"
+              "  run(x) {\n"
+              "    this.runs = this.runs + 1;\n"
+              "    if (x > " + n + ") return \"late \" + this.name;\n"
+              "    return \"on time \" + this.name;\n"
+              "  }\n"
+              "}\n"
+              "fun step" + n + "(a, b) {\n"
+              "  var total = 0;\n"
+              "  for (var i = 0; i < a; i = i + 1) total = total + b * 2;\n"
+              "  return total;\n"
+              "}\n";
+  }
+  source += "print Job0(\"first\").run(step0(1, 2));\n";
+  return source;
+}
+
+class CacheDirectory {
+ public:
+  CacheDirectory() {
+    char path[] = "/tmp/cpplox_bench_cache_XXXXXX";
+    _path = mkdtemp(path);
+  }
+  ~CacheDirectory() { std::filesystem::remove_all(_path); }
+
+  const std::string &Path() const { return _path; }
+
+ private:
+  std::string _path;
+};
+
+// Everything before the first instruction when the cache has no copy:
+// scanning, parsing, folding, compiling and writing the cache file
+void BM_StartupCold(benchmark::State &state) {
+  const std::string source = MakeScript(static_cast<size_t>(state.range(0)));
+  CacheDirectory directory;
+  std::ostringstream out;
+  Error error(out);
+
+  for (auto _ : state) {
+    Scanner scanner(source, &error);
+    Arena arena;
+    Parser parser(scanner.ScanTokens(), arena, error);
+    Optimizer optimizer(arena);
+    StmtList statements = optimizer.Optimize(parser.Parse());
+    VM vm(error, out);
+    ObjProto *script = vm.Compile(statements);
+    BytecodeCache cache(directory.Path());
+    benchmark::DoNotOptimize(cache.Store(source, *script));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(source.size()));
+}
+BENCHMARK(BM_StartupCold)->Arg(10)->Arg(100)->Unit(benchmark::kMicrosecond);
+
+// The same with a current cache file: mapping, validating and loading it
+void BM_StartupWarm(benchmark::State &state) {
+  const std::string source = MakeScript(static_cast<size_t>(state.range(0)));
+  CacheDirectory directory;
+  std::ostringstream out;
+  Error error(out);
+  {
+    Scanner scanner(source, &error);
+    Arena arena;
+    Parser parser(scanner.ScanTokens(), arena, error);
+    Optimizer optimizer(arena);
+    VM vm(error, out);
+    BytecodeCache(directory.Path())
+        .Store(source, *vm.Compile(optimizer.Optimize(parser.Parse())));
+  }
+
+  for (auto _ : state) {
+    VM vm(error, out);
+    BytecodeCache cache(directory.Path());
+    ObjProto *script = vm.Load(cache, source);
+    if (script == nullptr) {
+      state.SkipWithError("cache miss");
+      break;
+    }
+    benchmark::DoNotOptimize(script);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(source.size()));
+}
+BENCHMARK(BM_StartupWarm)->Arg(10)->Arg(100)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
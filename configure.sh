@@ -21,6 +21,7 @@ function help_message() {
     echo "Usage ./configure --build=<mode>: Build either in 'Debug' or 'Release' mode"
     echo "                  --clean: Remove the build directory"
     echo "                  --enable-tests, -t: Builds tests"
+    echo "                  --enable-benchmarks, -b: Builds benchmarks"
 }
 
 if [[ $# -eq 0 ]] ; then
@@ -45,6 +46,9 @@ while [ $# -ne 0 ]; do
         --enable-tests|-t)
             append_cmake_flags ENABLE_TESTING BOOL true
             ;;
+        --enable-benchmarks|-b)
+            append_cmake_flags ENABLE_BENCHMARKS BOOL true
+            ;;
         --help|-h)
             help_message
             exit 0
@@ -2,6 +2,8 @@
 #include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
 
 // User defined
 #include "src/includes/Run.hpp"
@@ -9,14 +11,62 @@
 int main(int argc, const char *argv[]) {
   try {
     auto runner = std::make_unique<Run>();
-    if (argc > 2) {
-      throw std::invalid_argument("Usage: cpplox [script]");
-    } else if (argc == 2) {
-      runner->ExecuteFile(argv[0]);
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    Run::Options options;
+    while (!args.empty()) {
+      if (args[0].starts_with("--engine=")) {
+        options.engine =
+            Run::ParseEngine(args[0].substr(sizeof("--engine=") - 1));
+      } else if (args[0] == "--fold-stats") {
+        options.fold_stats = true;
+      } else if (args[0] == "--gc-stats") {
+        options.gc_stats = true;
+      } else if (args[0] == "--gc-stress") {
+        options.gc_stress = true;
+      } else if (args[0] == "--ic-stats") {
+        options.ic_stats = true;
+      } else if (args[0].starts_with("--gc-max-pause=")) {
+        options.gc_max_pause =
+            Run::ParsePause(args[0].substr(sizeof("--gc-max-pause=") - 1));
+      } else if (args[0].starts_with("--bytecode-cache=")) {
+        options.bytecode_cache =
+            args[0].substr(sizeof("--bytecode-cache=") - 1);
+      } else if (args[0].starts_with("--trace=")) {
+        options.trace = args[0].substr(sizeof("--trace=") - 1);
+      } else {
+        break;
+      }
+      args.erase(args.begin());
+    }
+    // Only the VM runs compiled code, so the tree-walker has no use for it
+    if (!options.bytecode_cache.empty() &&
+        options.engine != Run::Engine::VM) {
+      throw std::invalid_argument("--bytecode-cache requires --engine=vm");
+    }
+
+    if (!args.empty() && args[0] == "--tokens") {
+      runner->DumpTokens(args.size() > 1 ? args[1] : "-");
+    } else if (args.size() == 3 && args[0] == "--emit-ast") {
+      runner->EmitAst(args[1], args[2]);
+    } else if (!args.empty() && args[0] == "--batch") {
+      runner->ExecuteBatch(
+          std::vector<std::string>(args.begin() + 1, args.end()));
+    } else if (args.size() > 1) {
+      throw std::invalid_argument(
+          "Usage: cpplox [--engine=tree|vm] [--fold-stats] [--gc-stats]\n"
+          "              [--gc-stress] [--gc-max-pause=MS] [--ic-stats]\n"
+          "              [--bytecode-cache=DIR] [--trace=FILE] [script | -]\n"
+          "       cpplox --tokens [script | -]\n"
+          "       cpplox --emit-ast script output\n"
+          "       cpplox --batch script...");
+    } else if (args.size() == 1) {
+      runner->ExecuteFile(args[0], options);
     } else {
-      runner->ExecutePrompt();
+      runner->ExecutePrompt(options);
     }
   } catch (const std::exception &e) {
     std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
   }
-}
\ No newline at end of file
+}
@@ -0,0 +1,58 @@
+#include "includes/Arena.hpp"
+
+#include <algorithm>
+
+Arena::Arena(Arena &&other) noexcept
+    : _block_size(other._block_size),
+      _blocks(std::move(other._blocks)),
+      _current(std::exchange(other._current, nullptr)),
+      _capacity(std::exchange(other._capacity, 0)),
+      _used(std::exchange(other._used, 0)),
+      _retired(std::exchange(other._retired, 0)) {
+  other._blocks.clear();
+}
+
+Arena &Arena::operator=(Arena &&other) noexcept {
+  if (this != &other) {
+    _block_size = other._block_size;
+    _blocks = std::move(other._blocks);
+    other._blocks.clear();
+    _current = std::exchange(other._current, nullptr);
+    _capacity = std::exchange(other._capacity, 0);
+    _used = std::exchange(other._used, 0);
+    _retired = std::exchange(other._retired, 0);
+  }
+  return *this;
+}
+
+void *Arena::AllocateSlow(size_t size, size_t align) {
+  _retired += _used;
+
+  // Oversized requests get a block of their own
+  size_t block_size = std::max(_block_size, size + align);
+  _blocks.push_back({std::make_unique<std::byte[]>(block_size), block_size});
+  _current = _blocks.back().memory.get();
+  _capacity = block_size;
+  _used = 0;
+
+  return Allocate(size, align);
+}
+
+void Arena::Reset() {
+  if (_blocks.size() > 1) {
+    // Keep the first block so the next unit starts without a malloc
+    _blocks.erase(_blocks.begin() + 1, _blocks.end());
+  }
+  _current = _blocks.empty() ? nullptr : _blocks.front().memory.get();
+  _capacity = _blocks.empty() ? 0 : _blocks.front().size;
+  _used = 0;
+  _retired = 0;
+}
+
+size_t Arena::BytesReserved() const {
+  size_t total = 0;
+  for (const auto &block : _blocks) {
+    total += block.size;
+  }
+  return total;
+}
@@ -0,0 +1,580 @@
+#include "includes/AstFile.hpp"
+
+#include <robin_hood.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "includes/Interner.hpp"
+
+namespace {
+
+using Node = AstFile::Node;
+using LiteralTag = AstFile::LiteralTag;
+
+// Appends each node after its children and returns its index
+class Writer : public Expr::Visitor<uint32_t>,
+               public Stmt::Visitor<uint32_t> {
+ public:
+  std::string Write(StmtList program) {
+    uint32_t list = Statements(program);
+    AstFile::Header header{AstFile::MAGIC,
+                           AstFile::VERSION,
+                           static_cast<uint32_t>(_nodes.size()),
+                           static_cast<uint32_t>(_lists.size()),
+                           static_cast<uint32_t>(_offsets.size()),
+                           static_cast<uint32_t>(_text.size()),
+                           list,
+                           0};
+    _offsets.push_back(static_cast<uint32_t>(_text.size()));
+
+    std::string bytes;
+    Append(bytes, &header, sizeof(header));
+    Append(bytes, _nodes.data(), _nodes.size() * sizeof(Node));
+    Append(bytes, _lists.data(), _lists.size() * sizeof(uint32_t));
+    Append(bytes, _offsets.data(), _offsets.size() * sizeof(uint32_t));
+    bytes += _text;
+    return bytes;
+  }
+
+ private:
+  static void Append(std::string& bytes, const void* data, size_t size) {
+    bytes.append(static_cast<const char*>(data), size);
+  }
+
+  [[gnu::always_inline]] uint32_t Child(const Expr* expr) {
+    return expr == nullptr ? AstFile::NONE : expr->Accept(*this);
+  }
+
+  [[gnu::always_inline]] uint32_t Child(const Stmt* stmt) {
+    return stmt == nullptr ? AstFile::NONE : stmt->Accept(*this);
+  }
+
+  uint32_t String(std::string_view text) {
+    auto [entry, inserted] =
+        _strings.try_emplace(text, static_cast<uint32_t>(_offsets.size()));
+    if (inserted) {
+      _offsets.push_back(static_cast<uint32_t>(_text.size()));
+      _text += text;
+    }
+    return entry->second;
+  }
+
+  // Lists are written once their items are, which keeps items before the
+  // nodes that hold them
+  uint32_t List(const std::vector<uint32_t>& items) {
+    auto list = static_cast<uint32_t>(_lists.size());
+    _lists.push_back(static_cast<uint32_t>(items.size()));
+    _lists.insert(_lists.end(), items.begin(), items.end());
+    return list;
+  }
+
+  uint32_t Statements(StmtList statements) {
+    std::vector<uint32_t> items;
+    items.reserve(statements.size());
+    for (const Stmt* stmt : statements) {
+      items.push_back(stmt->Accept(*this));
+    }
+    return List(items);
+  }
+
+  uint32_t Add(Expr::Kind kind, unsigned int line, uint32_t a,
+               uint32_t b = AstFile::NONE, uint32_t c = AstFile::NONE,
+               uint8_t type = 0) {
+    _nodes.push_back(
+        {static_cast<uint8_t>(kind), 0, type, 0, line, a, b, c});
+    return static_cast<uint32_t>(_nodes.size() - 1);
+  }
+
+  uint32_t Add(Stmt::Kind kind, unsigned int line, uint32_t a,
+               uint32_t b = AstFile::NONE, uint32_t c = AstFile::NONE) {
+    _nodes.push_back({static_cast<uint8_t>(kind), 1, 0, 0, line, a, b, c});
+    return static_cast<uint32_t>(_nodes.size() - 1);
+  }
+
+  uint32_t Operator(Expr::Kind kind, const Token<>& oper, uint32_t left,
+                    uint32_t right) {
+    return Add(kind, oper.line, left, String(oper.lexeme), right,
+               static_cast<uint8_t>(oper.type));
+  }
+
+  uint32_t VisitAssignExpr(const Assign& expr) override {
+    uint32_t value = Child(expr.GetValue());
+    return Add(Expr::Kind::ASSIGN, expr.GetName()->line,
+               String(expr.GetName()->lexeme), value);
+  }
+
+  uint32_t VisitBinaryExpr(const Binary& expr) override {
+    uint32_t left = Child(expr.GetLeft());
+    uint32_t right = Child(expr.GetRight());
+    return Operator(Expr::Kind::BINARY, *expr.GetOperator(), left, right);
+  }
+
+  uint32_t VisitCallExpr(const Call& expr) override {
+    uint32_t callee = Child(expr.GetCallee());
+    std::vector<uint32_t> args;
+    args.reserve(expr.GetArgs().size());
+    for (const Expr* arg : expr.GetArgs()) {
+      args.push_back(Child(arg));
+    }
+    return Add(Expr::Kind::CALL, expr.GetParen()->line, callee, List(args));
+  }
+
+  uint32_t VisitGetExpr(const Get& expr) override {
+    uint32_t object = Child(expr.GetObject());
+    return Add(Expr::Kind::GET, expr.GetName()->line, object,
+               String(expr.GetName()->lexeme));
+  }
+
+  uint32_t VisitGroupingExpr(const Grouping& expr) override {
+    uint32_t inner = Child(expr.GetExpr());
+    return Add(Expr::Kind::GROUPING, 0, inner);
+  }
+
+  uint32_t VisitLiteralExpr(const Literal& expr) override {
+    const LiteralValue& value = expr.GetValue();
+    uint32_t a = 0;
+    uint32_t b = 0;
+    auto tag = LiteralTag::NIL;
+    if (auto* number = std::get_if<double>(&value)) {
+      uint64_t bits;
+      std::memcpy(&bits, number, sizeof(bits));
+      a = static_cast<uint32_t>(bits);
+      b = static_cast<uint32_t>(bits >> 32);
+      tag = LiteralTag::NUMBER;
+    } else if (auto* boolean = std::get_if<bool>(&value)) {
+      a = *boolean;
+      tag = LiteralTag::BOOL;
+    } else if (auto* string = std::get_if<const Symbol*>(&value)) {
+      a = String((*string)->text);
+      tag = LiteralTag::STRING;
+    }
+    return Add(Expr::Kind::LITERAL, 0, a, b, AstFile::NONE,
+               static_cast<uint8_t>(tag));
+  }
+
+  uint32_t VisitLogicalExpr(const Logical& expr) override {
+    uint32_t left = Child(expr.GetLeft());
+    uint32_t right = Child(expr.GetRight());
+    return Operator(Expr::Kind::LOGICAL, *expr.GetOperator(), left, right);
+  }
+
+  uint32_t VisitSetExpr(const Set& expr) override {
+    uint32_t object = Child(expr.GetObject());
+    uint32_t value = Child(expr.GetValue());
+    return Add(Expr::Kind::SET, expr.GetName()->line, object,
+               String(expr.GetName()->lexeme), value);
+  }
+
+  uint32_t VisitSuperExpr(const Super& expr) override {
+    return Add(Expr::Kind::SUPER, expr.GetKeyword()->line,
+               String(expr.GetMethod()->lexeme));
+  }
+
+  uint32_t VisitThisExpr(const This& expr) override {
+    return Add(Expr::Kind::THIS, expr.GetKeyword()->line, AstFile::NONE);
+  }
+
+  uint32_t VisitUnaryExpr(const Unary& expr) override {
+    uint32_t right = Child(expr.GetRight());
+    const Token<>* oper = expr.GetOperator();
+    return Add(Expr::Kind::UNARY, oper->line, String(oper->lexeme), right,
+               AstFile::NONE, static_cast<uint8_t>(oper->type));
+  }
+
+  uint32_t VisitVariableExpr(const Variable& expr) override {
+    return Add(Expr::Kind::VARIABLE, expr.GetName()->line,
+               String(expr.GetName()->lexeme));
+  }
+
+  uint32_t VisitBlockStmt(const Block& stmt) override {
+    return Add(Stmt::Kind::BLOCK, 0, Statements(stmt.GetStatements()));
+  }
+
+  uint32_t VisitClassStmt(const Class& stmt) override {
+    uint32_t superclass = Child(stmt.GetSuperclass());
+    std::vector<uint32_t> methods;
+    methods.reserve(stmt.GetMethods().size());
+    for (const Function* method : stmt.GetMethods()) {
+      methods.push_back(Child(method));
+    }
+    return Add(Stmt::Kind::CLASS, stmt.GetName()->line,
+               String(stmt.GetName()->lexeme), superclass, List(methods));
+  }
+
+  uint32_t VisitExpressionStmt(const Expression& stmt) override {
+    return Add(Stmt::Kind::EXPRESSION, 0, Child(stmt.GetExpr()));
+  }
+
+  uint32_t VisitFunctionStmt(const Function& stmt) override {
+    std::vector<uint32_t> params;
+    params.reserve(stmt.GetParams().size());
+    for (const Token<>& param : stmt.GetParams()) {
+      params.push_back(String(param.lexeme));
+    }
+    uint32_t param_list = List(params);
+    uint32_t body = Statements(stmt.GetBody());
+    return Add(Stmt::Kind::FUNCTION, stmt.GetName()->line,
+               String(stmt.GetName()->lexeme), param_list, body);
+  }
+
+  uint32_t VisitIfStmt(const If& stmt) override {
+    uint32_t condition = Child(stmt.GetCondition());
+    uint32_t then_branch = Child(stmt.GetThen());
+    uint32_t else_branch = Child(stmt.GetElse());
+    return Add(Stmt::Kind::IF, 0, condition, then_branch, else_branch);
+  }
+
+  uint32_t VisitPrintStmt(const Print& stmt) override {
+    return Add(Stmt::Kind::PRINT, 0, Child(stmt.GetExpr()));
+  }
+
+  uint32_t VisitReturnStmt(const Return& stmt) override {
+    return Add(Stmt::Kind::RETURN, stmt.GetKeyword()->line,
+               Child(stmt.GetValue()));
+  }
+
+  uint32_t VisitVarStmt(const Var& stmt) override {
+    uint32_t initializer = Child(stmt.GetInitializer());
+    return Add(Stmt::Kind::VAR, stmt.GetName()->line,
+               String(stmt.GetName()->lexeme), initializer);
+  }
+
+  uint32_t VisitWhileStmt(const While& stmt) override {
+    uint32_t condition = Child(stmt.GetCondition());
+    uint32_t body = Child(stmt.GetBody());
+    return Add(Stmt::Kind::WHILE, 0, condition, body);
+  }
+
+  std::vector<Node> _nodes;
+  std::vector<uint32_t> _lists;
+  std::vector<uint32_t> _offsets;
+  std::string _text;
+  robin_hood::unordered_flat_map<std::string_view, uint32_t> _strings;
+};
+
+[[noreturn]] void Malformed() {
+  throw std::runtime_error("Malformed AST file");
+}
+
+// Rebuilds nodes front to back: every child is already built by the time
+// its parent is
+class Builder {
+ public:
+  Builder(const AstFile& file, Arena& arena)
+      : _file(file), _arena(arena), _built(file.Nodes().size()) {}
+
+  StmtList Build() {
+    for (uint32_t i = 0; i < _built.size(); i++) {
+      const Node& node = _file.At(i);
+      _built[i] = node.is_stmt ? static_cast<const void*>(BuildStmt(node))
+                               : static_cast<const void*>(BuildExpr(node));
+    }
+    return Statements(_file.Program());
+  }
+
+ private:
+  const Expr* ExprAt(uint32_t index) const {
+    return index == AstFile::NONE ? nullptr
+                                  : static_cast<const Expr*>(_built[index]);
+  }
+
+  const Stmt* StmtAt(uint32_t index) const {
+    return index == AstFile::NONE ? nullptr
+                                  : static_cast<const Stmt*>(_built[index]);
+  }
+
+  Token<> Name(uint32_t string, unsigned int line,
+               TokenType type = TokenType::IDENTIFIER) const {
+    return Token<>(type, _file.String(string), nullptr, line);
+  }
+
+  const Symbol* SymbolOf(uint32_t string) const {
+    return Interner::Global().Intern(_file.String(string));
+  }
+
+  StmtList Statements(std::span<const uint32_t> items) {
+    std::vector<const Stmt*> statements;
+    statements.reserve(items.size());
+    for (uint32_t item : items) {
+      statements.push_back(StmtAt(item));
+    }
+    return _arena.CopyArray(statements);
+  }
+
+  const Expr* BuildExpr(const Node& node);
+  const Stmt* BuildStmt(const Node& node);
+
+  const AstFile& _file;
+  Arena& _arena;
+  std::vector<const void*> _built;
+};
+
+const Expr* Builder::BuildExpr(const Node& node) {
+  auto oper = static_cast<TokenType>(node.type);
+  switch (static_cast<Expr::Kind>(node.kind)) {
+    case Expr::Kind::ASSIGN:
+      return _arena.Make<Assign>(Name(node.a, node.line), ExprAt(node.b));
+    case Expr::Kind::BINARY:
+      return _arena.Make<Binary>(ExprAt(node.a),
+                                 Name(node.b, node.line, oper),
+                                 ExprAt(node.c));
+    case Expr::Kind::CALL: {
+      std::vector<const Expr*> args;
+      for (uint32_t arg : _file.List(node.b)) {
+        args.push_back(ExprAt(arg));
+      }
+      return _arena.Make<Call>(
+          ExprAt(node.a),
+          Token<>(TokenType::RIGHT_PAREN, ")", nullptr, node.line),
+          _arena.CopyArray(args));
+    }
+    case Expr::Kind::GET:
+      return _arena.Make<Get>(ExprAt(node.a), Name(node.b, node.line),
+                              SymbolOf(node.b));
+    case Expr::Kind::GROUPING:
+      return _arena.Make<Grouping>(ExprAt(node.a));
+    case Expr::Kind::LITERAL:
+      switch (static_cast<LiteralTag>(node.type)) {
+        case LiteralTag::BOOL:
+          return _arena.Make<Literal>(node.a != 0);
+        case LiteralTag::NUMBER: {
+          uint64_t bits = (static_cast<uint64_t>(node.b) << 32) | node.a;
+          double number;
+          std::memcpy(&number, &bits, sizeof(number));
+          return _arena.Make<Literal>(number);
+        }
+        case LiteralTag::STRING:
+          return _arena.Make<Literal>(SymbolOf(node.a));
+        default:
+          return _arena.Make<Literal>(nullptr);
+      }
+    case Expr::Kind::LOGICAL:
+      return _arena.Make<Logical>(ExprAt(node.a),
+                                  Name(node.b, node.line, oper),
+                                  ExprAt(node.c));
+    case Expr::Kind::SET:
+      return _arena.Make<Set>(ExprAt(node.a), Name(node.b, node.line),
+                              SymbolOf(node.b), ExprAt(node.c));
+    case Expr::Kind::SUPER:
+      return _arena.Make<Super>(
+          Token<>(TokenType::SUPER, "super", nullptr, node.line),
+          Name(node.a, node.line), SymbolOf(node.a));
+    case Expr::Kind::THIS:
+      return _arena.Make<This>(
+          Token<>(TokenType::THIS, "this", nullptr, node.line));
+    case Expr::Kind::UNARY:
+      return _arena.Make<Unary>(Name(node.a, node.line, oper),
+                                ExprAt(node.b));
+    case Expr::Kind::VARIABLE:
+      return _arena.Make<Variable>(Name(node.a, node.line));
+  }
+  Malformed();
+}
+
+const Stmt* Builder::BuildStmt(const Node& node) {
+  switch (static_cast<Stmt::Kind>(node.kind)) {
+    case Stmt::Kind::BLOCK:
+      return _arena.Make<Block>(Statements(_file.List(node.a)));
+    case Stmt::Kind::CLASS: {
+      std::vector<const Function*> methods;
+      for (uint32_t method : _file.List(node.c)) {
+        methods.push_back(static_cast<const Function*>(StmtAt(method)));
+      }
+      return _arena.Make<Class>(
+          Name(node.a, node.line),
+          static_cast<const Variable*>(ExprAt(node.b)),
+          _arena.CopyArray(methods));
+    }
+    case Stmt::Kind::EXPRESSION:
+      return _arena.Make<Expression>(ExprAt(node.a));
+    case Stmt::Kind::FUNCTION: {
+      std::vector<Token<>> params;
+      for (uint32_t param : _file.List(node.b)) {
+        params.push_back(Name(param, node.line));
+      }
+      return _arena.Make<Function>(Name(node.a, node.line), SymbolOf(node.a),
+                                   _arena.MoveArray(params),
+                                   Statements(_file.List(node.c)));
+    }
+    case Stmt::Kind::IF:
+      return _arena.Make<If>(ExprAt(node.a), StmtAt(node.b), StmtAt(node.c));
+    case Stmt::Kind::PRINT:
+      return _arena.Make<Print>(ExprAt(node.a));
+    case Stmt::Kind::RETURN:
+      return _arena.Make<Return>(
+          Token<>(TokenType::RETURN, "return", nullptr, node.line),
+          ExprAt(node.a));
+    case Stmt::Kind::VAR:
+      return _arena.Make<Var>(Name(node.a, node.line), ExprAt(node.b));
+    case Stmt::Kind::WHILE:
+      return _arena.Make<While>(ExprAt(node.a), StmtAt(node.b));
+  }
+  Malformed();
+}
+
+}  // namespace
+
+std::string AstFile::Write(StmtList program) {
+  return Writer().Write(program);
+}
+
+AstFile::AstFile(const std::string& path) : _source(path) {
+  std::string_view bytes = _source.View();
+  Header header{};
+  if (bytes.size() < sizeof(header)) Malformed();
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  if (header.magic != MAGIC || header.version != VERSION) Malformed();
+
+  // Sizes are checked in 64 bits, so huge counts cannot wrap around
+  uint64_t nodes_at = sizeof(Header);
+  uint64_t lists_at = nodes_at + uint64_t{header.node_count} * sizeof(Node);
+  uint64_t offsets_at =
+      lists_at + uint64_t{header.list_size} * sizeof(uint32_t);
+  uint64_t text_at =
+      offsets_at + (uint64_t{header.string_count} + 1) * sizeof(uint32_t);
+  if (text_at + header.text_size != bytes.size()) Malformed();
+
+  // The mapping is page aligned and every section a multiple of 4 bytes
+  const char* data = bytes.data();
+  _nodes = {reinterpret_cast<const Node*>(data + nodes_at),
+            header.node_count};
+  _lists = {reinterpret_cast<const uint32_t*>(data + lists_at),
+            header.list_size};
+  _offsets = {reinterpret_cast<const uint32_t*>(data + offsets_at),
+              header.string_count + size_t{1}};
+  _text = bytes.substr(text_at, header.text_size);
+  _program = header.program;
+  Validate();
+}
+
+void AstFile::Validate() const {
+  for (size_t i = 1; i < _offsets.size(); i++) {
+    if (_offsets[i] < _offsets[i - 1]) Malformed();
+  }
+  if (_offsets.front() != 0 || _offsets.back() != _text.size()) Malformed();
+  const size_t strings = _offsets.size() - 1;
+
+  // Node `child` must come before node `before` and be a statement or an
+  // expression, as `stmt` says
+  auto need = [&](uint32_t child, size_t before, bool stmt) {
+    if (child >= before || _nodes[child].is_stmt != stmt) Malformed();
+  };
+  auto maybe = [&](uint32_t child, size_t before, bool stmt) {
+    if (child != NONE) need(child, before, stmt);
+  };
+  auto string = [&](uint32_t string) {
+    if (string >= strings) Malformed();
+  };
+  auto list = [&](uint32_t list) {
+    if (list >= _lists.size() || _lists[list] > _lists.size() - list - 1) {
+      Malformed();
+    }
+    return List(list);
+  };
+  auto nodes = [&](uint32_t of, size_t before, bool stmt) {
+    for (uint32_t item : list(of)) need(item, before, stmt);
+  };
+
+  for (size_t i = 0; i < _nodes.size(); i++) {
+    const Node& node = _nodes[i];
+    if (node.type > static_cast<uint8_t>(TokenType::TEOF)) Malformed();
+    if (node.is_stmt) {
+      switch (static_cast<Stmt::Kind>(node.kind)) {
+        case Stmt::Kind::BLOCK:
+          nodes(node.a, i, true);
+          break;
+        case Stmt::Kind::CLASS:
+          string(node.a);
+          maybe(node.b, i, false);
+          if (node.b != NONE &&
+              _nodes[node.b].kind !=
+                  static_cast<uint8_t>(Expr::Kind::VARIABLE)) {
+            Malformed();
+          }
+          nodes(node.c, i, true);
+          for (uint32_t method : List(node.c)) {
+            if (_nodes[method].kind !=
+                static_cast<uint8_t>(Stmt::Kind::FUNCTION)) {
+              Malformed();
+            }
+          }
+          break;
+        case Stmt::Kind::EXPRESSION:
+        case Stmt::Kind::PRINT:
+          need(node.a, i, false);
+          break;
+        case Stmt::Kind::FUNCTION:
+          string(node.a);
+          for (uint32_t param : list(node.b)) string(param);
+          nodes(node.c, i, true);
+          break;
+        case Stmt::Kind::IF:
+          need(node.a, i, false);
+          need(node.b, i, true);
+          maybe(node.c, i, true);
+          break;
+        case Stmt::Kind::RETURN:
+          maybe(node.a, i, false);
+          break;
+        case Stmt::Kind::VAR:
+          string(node.a);
+          maybe(node.b, i, false);
+          break;
+        case Stmt::Kind::WHILE:
+          need(node.a, i, false);
+          need(node.b, i, true);
+          break;
+        default:
+          Malformed();
+      }
+      continue;
+    }
+
+    switch (static_cast<Expr::Kind>(node.kind)) {
+      case Expr::Kind::ASSIGN:
+      case Expr::Kind::UNARY:
+        string(node.a);
+        need(node.b, i, false);
+        break;
+      case Expr::Kind::BINARY:
+      case Expr::Kind::LOGICAL:
+      case Expr::Kind::SET:
+        need(node.a, i, false);
+        string(node.b);
+        need(node.c, i, false);
+        break;
+      case Expr::Kind::CALL:
+        need(node.a, i, false);
+        nodes(node.b, i, false);
+        break;
+      case Expr::Kind::GET:
+        need(node.a, i, false);
+        string(node.b);
+        break;
+      case Expr::Kind::GROUPING:
+        need(node.a, i, false);
+        break;
+      case Expr::Kind::LITERAL:
+        if (node.type > static_cast<uint8_t>(LiteralTag::STRING)) Malformed();
+        if (node.type == static_cast<uint8_t>(LiteralTag::STRING)) {
+          string(node.a);
+        }
+        break;
+      case Expr::Kind::SUPER:
+      case Expr::Kind::VARIABLE:
+        string(node.a);
+        break;
+      case Expr::Kind::THIS:
+        break;
+      default:
+        Malformed();
+    }
+  }
+  nodes(_program, _nodes.size(), true);
+}
+
+StmtList AstFile::Materialize(Arena& arena) const {
+  return Builder(*this, arena).Build();
+}
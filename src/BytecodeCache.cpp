@@ -0,0 +1,272 @@
+#include "includes/BytecodeCache.hpp"
+
+#include <fcntl.h>
+#include <fmt/core.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "includes/Chunk.hpp"
+#include "includes/Interner.hpp"
+#include "includes/Source.hpp"
+
+namespace {
+
+// "LOXC" read as a little-endian word; a machine of the other byte order
+// reads something else and ignores the file
+constexpr uint32_t MAGIC = 0x43584f4c;
+
+struct Header {
+  uint32_t magic;
+  uint32_t format;
+  uint64_t compiler;
+  uint64_t source_hash;
+  uint64_t source_size;
+  uint64_t payload_size;
+  uint64_t payload_hash;
+};
+
+enum class Tag : uint8_t { NUMBER, STRING, PROTO };
+
+uint64_t Hash(std::string_view bytes) {
+  return robin_hood::hash_bytes(bytes.data(), bytes.size());
+}
+
+std::string_view CodeOf(const Chunk &chunk) {
+  return {reinterpret_cast<const char *>(chunk.Code()), chunk.Size()};
+}
+
+class Writer {
+ public:
+  template <typename T>
+  void Put(T value) {
+    _bytes.append(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+
+  void PutText(std::string_view text) {
+    Put(static_cast<uint32_t>(text.size()));
+    _bytes.append(text);
+  }
+
+  // False if `proto` holds a constant the format has no room for
+  bool PutProto(const ObjProto &proto);
+
+  [[gnu::always_inline]] const std::string &Bytes() const { return _bytes; }
+
+ private:
+  std::string _bytes;
+};
+
+bool Writer::PutProto(const ObjProto &proto) {
+  const Chunk &chunk = proto.GetChunk();
+  PutText(proto.Name());
+  Put(static_cast<uint32_t>(proto.arity));
+  Put(static_cast<uint32_t>(proto.upvalue_count));
+  Put(static_cast<uint32_t>(proto.caches.size()));
+  PutText(CodeOf(chunk));
+  Put(static_cast<uint32_t>(chunk.Lines().size()));
+  for (const Chunk::LineRun &run : chunk.Lines()) {
+    Put(run.offset);
+    Put(run.line);
+  }
+
+  Put(static_cast<uint32_t>(chunk.Constants().size()));
+  for (Value constant : chunk.Constants()) {
+    if (constant.IsNumber()) {
+      Put(Tag::NUMBER);
+      Put(constant.AsNumber());
+    } else if (IsObjType(constant, ObjType::STRING) &&
+               AsObj<ObjString>(constant)->GetSymbol() != nullptr) {
+      Put(Tag::STRING);
+      PutText(AsObj<ObjString>(constant)->GetSymbol()->text);
+    } else if (IsObjType(constant, ObjType::PROTO)) {
+      Put(Tag::PROTO);
+      if (!PutProto(*AsObj<ObjProto>(constant))) return false;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Reading past the end of the payload, or finding anything Writer would
+// not have written, throws: the file is not one this version made
+class Reader {
+ public:
+  Reader(std::string_view bytes, Heap &heap) : _bytes(bytes), _heap(heap) {}
+
+  template <typename T>
+  T Get() {
+    if (_bytes.size() < sizeof(T)) Stale();
+    T value;
+    std::memcpy(&value, _bytes.data(), sizeof(T));
+    _bytes.remove_prefix(sizeof(T));
+    return value;
+  }
+
+  std::string_view GetText() {
+    auto size = Get<uint32_t>();
+    if (_bytes.size() < size) Stale();
+    std::string_view text = _bytes.substr(0, size);
+    _bytes.remove_prefix(size);
+    return text;
+  }
+
+  // A function's name, interned so it outlives the mapping
+  std::string_view GetName() {
+    return Interner::Global().Intern(GetText())->text;
+  }
+
+  // Everything after the name. `proto` has to be reachable already: what
+  // it references is then kept alive by it.
+  void GetProto(ObjProto &proto);
+
+  [[gnu::always_inline]] bool AtEnd() const { return _bytes.empty(); }
+
+ private:
+  [[noreturn]] static void Stale() {
+    throw std::runtime_error("Malformed bytecode cache");
+  }
+
+  std::string_view _bytes;
+  Heap &_heap;
+};
+
+void Reader::GetProto(ObjProto &proto) {
+  proto.arity = Get<uint32_t>();
+  proto.upvalue_count = Get<uint32_t>();
+  proto.caches.resize(Get<uint32_t>());
+  std::string_view code = GetText();
+
+  // Replayed through Write(), which rebuilds the same runs
+  std::vector<Chunk::LineRun> runs(Get<uint32_t>());
+  for (Chunk::LineRun &run : runs) {
+    run.offset = Get<uint32_t>();
+    run.line = Get<uint32_t>();
+  }
+  Chunk &chunk = proto.GetChunk();
+  for (size_t i = 0; i < runs.size(); i++) {
+    size_t end = i + 1 < runs.size() ? runs[i + 1].offset : code.size();
+    if (runs[i].offset != chunk.Size() || end > code.size()) Stale();
+    for (size_t offset = runs[i].offset; offset < end; offset++) {
+      chunk.Write(static_cast<uint8_t>(code[offset]), runs[i].line);
+    }
+  }
+  if (chunk.Size() != code.size()) Stale();
+
+  auto count = Get<uint32_t>();
+  for (uint32_t i = 0; i < count; i++) {
+    Value constant;
+    switch (Get<Tag>()) {
+      case Tag::NUMBER:
+        constant = Value::Number(Get<double>());
+        break;
+      case Tag::STRING:
+        constant = Value::Object(
+            _heap.Intern(Interner::Global().Intern(GetText())));
+        break;
+      case Tag::PROTO:
+        constant = Value::Object(_heap.Make<ObjProto>(GetName()));
+        break;
+      default:
+        Stale();
+    }
+    // Pool indices are baked into the code, so each constant has to land
+    // where it was
+    if (chunk.AddConstant(constant) != i) Stale();
+    _heap.WriteBarrier(&proto, constant);
+    if (IsObjType(constant, ObjType::PROTO)) {
+      GetProto(*AsObj<ObjProto>(constant));
+    }
+  }
+}
+
+bool WriteAll(int fd, const void *data, size_t size) {
+  const auto *bytes = static_cast<const char *>(data);
+  while (size > 0) {
+    ssize_t count = write(fd, bytes, size);
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    bytes += count;
+    size -= static_cast<size_t>(count);
+  }
+  return true;
+}
+
+}  // namespace
+
+uint64_t BytecodeCache::CompilerVersion() {
+  // Adding, removing or reordering an opcode changes the names in order
+  static constexpr std::string_view opcodes =
+#define CPPLOX_OPCODE_NAME(name) #name " "
+      CPPLOX_OPCODES(CPPLOX_OPCODE_NAME);
+#undef CPPLOX_OPCODE_NAME
+  return Hash(opcodes) ^ FORMAT_VERSION;
+}
+
+std::string BytecodeCache::PathFor(std::string_view source) const {
+  return fmt::format("{}/{:016x}.loxc", _directory, Hash(source));
+}
+
+ObjProto *BytecodeCache::Load(std::string_view source, Heap &heap) {
+  try {
+    // Missing, the usual miss, throws too
+    Source file(PathFor(source));
+    std::string_view bytes = file.View();
+    Header header{};
+    if (bytes.size() < sizeof(header)) return nullptr;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    std::string_view payload = bytes.substr(sizeof(header));
+    if (header.magic != MAGIC || header.format != FORMAT_VERSION ||
+        header.compiler != CompilerVersion() ||
+        header.source_size != source.size() ||
+        header.source_hash != Hash(source) ||
+        header.payload_size != payload.size() ||
+        header.payload_hash != Hash(payload)) {
+      return nullptr;
+    }
+
+    Reader reader(payload, heap);
+    _loading = heap.Make<ObjProto>(reader.GetName());
+    reader.GetProto(*_loading);
+    ObjProto *script = reader.AtEnd() ? _loading : nullptr;
+    _loading = nullptr;
+    return script;
+  } catch (const std::runtime_error &) {
+    _loading = nullptr;
+    return nullptr;
+  }
+}
+
+bool BytecodeCache::Store(std::string_view source,
+                          const ObjProto &script) const {
+  Writer writer;
+  if (!writer.PutProto(script)) return false;
+  const std::string &payload = writer.Bytes();
+  Header header{MAGIC,         FORMAT_VERSION, CompilerVersion(),
+                Hash(source),  source.size(),  payload.size(),
+                Hash(payload)};
+
+  // Usually there already
+  mkdir(_directory.c_str(), 0755);
+  std::string path = PathFor(source);
+  std::string temporary = fmt::format("{}.{}.tmp", path, getpid());
+  int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                0644);
+  if (fd < 0) return false;
+  bool written = WriteAll(fd, &header, sizeof(header)) &&
+                 WriteAll(fd, payload.data(), payload.size());
+  written = close(fd) == 0 && written;
+  if (!written || std::rename(temporary.c_str(), path.c_str()) != 0) {
+    unlink(temporary.c_str());
+    return false;
+  }
+  return true;
+}
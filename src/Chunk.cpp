@@ -0,0 +1,25 @@
+#include "includes/Chunk.hpp"
+
+#include <algorithm>
+
+size_t Chunk::AddConstant(Value value) {
+  auto [index, inserted] =
+      _constant_index.try_emplace(value.Bits(), _constants.size());
+  if (inserted) {
+    _constants.push_back(value);
+  }
+  return index->second;
+}
+
+uint32_t Chunk::GetLine(size_t offset) const {
+  auto run = std::upper_bound(
+      _lines.begin(), _lines.end(), offset,
+      [](size_t off, const LineRun &entry) { return off < entry.offset; });
+  return run == _lines.begin() ? 0 : std::prev(run)->line;
+}
+
+size_t Chunk::MemoryUsage() const {
+  return _code.capacity() * sizeof(uint8_t) +
+         _constants.capacity() * sizeof(Value) +
+         _lines.capacity() * sizeof(LineRun);
+}
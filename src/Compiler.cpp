@@ -0,0 +1,632 @@
+#include "includes/Compiler.hpp"
+
+#include <limits>
+
+namespace {
+
+// For the implicit `this` and `super` slots
+Token<> SyntheticToken(TokenType type, std::string_view text,
+                       unsigned int line) {
+  return Token<>(type, text, nullptr, line);
+}
+
+}  // namespace
+
+ObjProto* Compiler::Compile(StmtList statements) {
+  _functions.clear();
+  _classes.clear();
+  _had_error = false;
+  _declared_globals.clear();
+  _global_uses.clear();
+
+  auto* script = _heap.Make<ObjProto>("script");
+  _functions.emplace_back(script, FunctionKind::SCRIPT);
+  // Slot 0 holds the function being called
+  Current().locals.push_back({"", 0, false});
+
+  for (const Stmt* stmt : statements) {
+    Compile(stmt);
+  }
+  EmitReturn();
+  _functions.pop_back();
+
+  for (const Token<>* use : _global_uses) {
+    std::string_view name = use->lexeme;
+    if (_declared_globals.contains(name) ||
+        _globals.contains(Interner::Global().Intern(name))) {
+      continue;
+    }
+    ErrorAt(*use, "Undefined variable '" + std::string(name) + "'.");
+    // Once per name
+    _declared_globals.insert(name);
+  }
+
+  return _had_error ? nullptr : script;
+}
+
+void Compiler::MarkRoots(Heap& heap) const {
+  for (const FunctionState& function : _functions) {
+    heap.Mark(function.proto);
+  }
+}
+
+// ------------- EMISSION -------------
+void Compiler::EmitShort(uint16_t value) {
+  EmitByte(static_cast<uint8_t>(value >> 8));
+  EmitByte(static_cast<uint8_t>(value & 0xff));
+}
+
+void Compiler::EmitConstant(Value value) {
+  Emit(OpCode::CONSTANT);
+  EmitShort(MakeConstant(value));
+}
+
+void Compiler::EmitReturn() {
+  if (Current().kind == FunctionKind::INITIALIZER) {
+    Emit(OpCode::GET_LOCAL);
+    EmitByte(0);
+  } else {
+    Emit(OpCode::NIL);
+  }
+  Emit(OpCode::RETURN);
+}
+
+size_t Compiler::EmitJump(OpCode op) {
+  Emit(op);
+  EmitShort(0xffff);
+  return CurrentChunk().Size() - 2;
+}
+
+void Compiler::PatchJump(size_t offset) {
+  // -2 for the operand itself
+  size_t jump = CurrentChunk().Size() - offset - 2;
+  if (jump > std::numeric_limits<uint16_t>::max()) {
+    ErrorAtLine("Too much code to jump over.");
+  }
+  CurrentChunk().At(offset) = static_cast<uint8_t>((jump >> 8) & 0xff);
+  CurrentChunk().At(offset + 1) = static_cast<uint8_t>(jump & 0xff);
+}
+
+void Compiler::EmitLoop(size_t loop_start) {
+  Emit(OpCode::LOOP);
+  // +2 for the operand about to be written
+  size_t offset = CurrentChunk().Size() - loop_start + 2;
+  if (offset > std::numeric_limits<uint16_t>::max()) {
+    ErrorAtLine("Loop body too large.");
+  }
+  EmitShort(static_cast<uint16_t>(offset));
+}
+
+uint16_t Compiler::MakeConstant(Value value) {
+  size_t index = CurrentChunk().AddConstant(value);
+  _heap.WriteBarrier(Current().proto, value);
+  if (index > std::numeric_limits<uint16_t>::max()) {
+    ErrorAtLine("Too many constants in one chunk.");
+    return 0;
+  }
+  return static_cast<uint16_t>(index);
+}
+
+uint16_t Compiler::NameConstant(const Token<>& name) {
+  auto [constant, inserted] = Current().names.try_emplace(name.lexeme, 0);
+  if (inserted) {
+    constant->second = MakeConstant(Value::Object(
+        _heap.Intern(Interner::Global().Intern(name.lexeme))));
+  }
+  return constant->second;
+}
+
+uint16_t Compiler::MakeCache() {
+  std::vector<InlineCache>& caches = Current().proto->caches;
+  if (caches.size() > std::numeric_limits<uint16_t>::max()) {
+    ErrorAtLine("Too many property accesses and calls in one function.");
+    return 0;
+  }
+  caches.emplace_back();
+  return static_cast<uint16_t>(caches.size() - 1);
+}
+
+void Compiler::CompileFunction(const Function& function, FunctionKind kind) {
+  auto* proto = _heap.Make<ObjProto>(function.GetName()->lexeme);
+  proto->arity = function.GetParams().size();
+
+  _functions.emplace_back(proto, kind);
+  BeginScope();
+  Current().locals.push_back(
+      {kind == FunctionKind::FUNCTION ? "" : "this", 0, false});
+
+  for (const Token<>& param : function.GetParams()) {
+    DeclareVariable(param);
+    MarkInitialized();
+  }
+  for (const Stmt* stmt : function.GetBody()) {
+    Compile(stmt);
+  }
+  EmitReturn();
+
+  // No EndScope(): the frame's slots all go away with the return
+  std::vector<UpvalueRef> upvalues = std::move(Current().upvalues);
+  _functions.pop_back();
+  proto->upvalue_count = upvalues.size();
+
+  _line = function.GetName()->line;
+  Emit(OpCode::CLOSURE);
+  EmitShort(MakeConstant(Value::Object(proto)));
+  for (const UpvalueRef& upvalue : upvalues) {
+    EmitByte(upvalue.is_local ? 1 : 0);
+    EmitByte(upvalue.index);
+  }
+}
+
+// ------------- VARIABLES -------------
+void Compiler::EndScope() {
+  FunctionState& function = Current();
+  function.scope_depth--;
+
+  while (!function.locals.empty() &&
+         function.locals.back().depth > function.scope_depth) {
+    Emit(function.locals.back().captured ? OpCode::CLOSE_UPVALUE
+                                         : OpCode::POP);
+    function.locals.pop_back();
+  }
+}
+
+void Compiler::DeclareVariable(const Token<>& name) {
+  FunctionState& function = Current();
+  if (function.scope_depth == 0) return;
+
+  for (auto local = function.locals.rbegin(); local != function.locals.rend();
+       ++local) {
+    if (local->depth != -1 && local->depth < function.scope_depth) break;
+    if (local->name == name.lexeme) {
+      ErrorAt(name, "Already a variable with this name in this scope.");
+    }
+  }
+
+  _line = name.line;
+  AddLocal(name.lexeme);
+}
+
+void Compiler::AddLocal(std::string_view name) {
+  // Slots are addressed with one byte
+  if (Current().locals.size() > std::numeric_limits<uint8_t>::max()) {
+    ErrorAtLine("Too many local variables in function.");
+    return;
+  }
+  Current().locals.push_back({name, -1, false});
+}
+
+void Compiler::MarkInitialized() {
+  FunctionState& function = Current();
+  if (function.scope_depth == 0) return;
+  function.locals.back().depth = function.scope_depth;
+}
+
+void Compiler::DefineVariable(const Token<>& name) {
+  if (Current().scope_depth > 0) {
+    MarkInitialized();
+    return;
+  }
+
+  _declared_globals.insert(name.lexeme);
+  uint16_t constant = NameConstant(name);
+  _line = name.line;
+  Emit(OpCode::DEFINE_GLOBAL);
+  EmitShort(constant);
+}
+
+void Compiler::NamedVariable(const Token<>& name, bool assign) {
+  if (int slot = ResolveLocal(Current(), name); slot != -1) {
+    _line = name.line;
+    Emit(assign ? OpCode::SET_LOCAL : OpCode::GET_LOCAL);
+    EmitByte(static_cast<uint8_t>(slot));
+  } else if (int upvalue = ResolveUpvalue(_functions.size() - 1, name);
+             upvalue != -1) {
+    _line = name.line;
+    Emit(assign ? OpCode::SET_UPVALUE : OpCode::GET_UPVALUE);
+    EmitByte(static_cast<uint8_t>(upvalue));
+  } else {
+    _global_uses.push_back(&name);
+    uint16_t constant = NameConstant(name);
+    _line = name.line;
+    Emit(assign ? OpCode::SET_GLOBAL : OpCode::GET_GLOBAL);
+    EmitShort(constant);
+  }
+}
+
+int Compiler::ResolveLocal(FunctionState& function, const Token<>& name) {
+  for (int i = static_cast<int>(function.locals.size()) - 1; i >= 0; i--) {
+    const Local& local = function.locals[i];
+    if (local.name == name.lexeme) {
+      if (local.depth == -1) {
+        ErrorAt(name, "Can't read local variable in its own initializer.");
+      }
+      return i;
+    }
+  }
+  return -1;
+}
+
+int Compiler::ResolveUpvalue(size_t function, const Token<>& name) {
+  if (function == 0) return -1;
+
+  FunctionState& enclosing = _functions[function - 1];
+  if (int local = ResolveLocal(enclosing, name); local != -1) {
+    enclosing.locals[local].captured = true;
+    return AddUpvalue(function, static_cast<uint8_t>(local), true);
+  }
+  if (int upvalue = ResolveUpvalue(function - 1, name); upvalue != -1) {
+    return AddUpvalue(function, static_cast<uint8_t>(upvalue), false);
+  }
+  return -1;
+}
+
+int Compiler::AddUpvalue(size_t function, uint8_t index, bool is_local) {
+  std::vector<UpvalueRef>& upvalues = _functions[function].upvalues;
+  for (size_t i = 0; i < upvalues.size(); i++) {
+    if (upvalues[i].index == index && upvalues[i].is_local == is_local) {
+      return static_cast<int>(i);
+    }
+  }
+
+  if (upvalues.size() > std::numeric_limits<uint8_t>::max()) {
+    ErrorAtLine("Too many closure variables in function.");
+    return 0;
+  }
+  upvalues.push_back({index, is_local});
+  return static_cast<int>(upvalues.size() - 1);
+}
+
+void Compiler::ErrorAt(const Token<>& token, const std::string& message) {
+  _error.Report(token.line, " at '" + std::string(token.lexeme) + "'",
+                message);
+  _had_error = true;
+}
+
+void Compiler::ErrorAtLine(const std::string& message) {
+  _error.Report(_line, "", message);
+  _had_error = true;
+}
+
+// ------------- EXPRESSIONS -------------
+void Compiler::VisitAssignExpr(const Assign& expr) {
+  Compile(expr.GetValue());
+  NamedVariable(*expr.GetName(), true);
+}
+
+void Compiler::VisitBinaryExpr(const Binary& expr) {
+  Compile(expr.GetLeft());
+  Compile(expr.GetRight());
+
+  const Token<>* oper = expr.GetOperator();
+  _line = oper->line;
+  switch (oper->type) {
+    case TokenType::BANG_EQUAL:
+      Emit(OpCode::NOT_EQUAL);
+      break;
+    case TokenType::EQUAL_EQUAL:
+      Emit(OpCode::EQUAL);
+      break;
+    case TokenType::GREATER:
+      Emit(OpCode::GREATER);
+      break;
+    case TokenType::GREATER_EQUAL:
+      Emit(OpCode::GREATER_EQUAL);
+      break;
+    case TokenType::LESS:
+      Emit(OpCode::LESS);
+      break;
+    case TokenType::LESS_EQUAL:
+      Emit(OpCode::LESS_EQUAL);
+      break;
+    case TokenType::PLUS:
+      Emit(OpCode::ADD);
+      break;
+    case TokenType::MINUS:
+      Emit(OpCode::SUBTRACT);
+      break;
+    case TokenType::STAR:
+      Emit(OpCode::MULTIPLY);
+      break;
+    case TokenType::SLASH:
+      Emit(OpCode::DIVIDE);
+      break;
+    default:
+      break;
+  }
+}
+
+void Compiler::VisitCallExpr(const Call& expr) {
+  // A method called where it is looked up never needs its bound method
+  const Expr* callee = expr.GetCallee();
+  if (callee->GetKind() == Expr::Kind::GET) {
+    Invoke(static_cast<const Get&>(*callee), expr);
+    return;
+  }
+  if (callee->GetKind() == Expr::Kind::SUPER) {
+    SuperInvoke(static_cast<const Super&>(*callee), expr);
+    return;
+  }
+
+  Compile(callee);
+  for (const Expr* arg : expr.GetArgs()) {
+    Compile(arg);
+  }
+
+  _line = expr.GetParen()->line;
+  Emit(OpCode::CALL);
+  EmitByte(static_cast<uint8_t>(expr.GetArgs().size()));
+  EmitShort(MakeCache());
+}
+
+// The method is looked up before the arguments are evaluated, as the
+// tree-walker does and as a Get callee would be
+void Compiler::Invoke(const Get& get, const Call& call) {
+  Compile(get.GetObject());
+  uint16_t name = NameConstant(*get.GetName());
+  _line = get.GetName()->line;
+  Emit(OpCode::GET_METHOD);
+  EmitShort(name);
+  EmitShort(MakeCache());
+  InvokeWith(call);
+}
+
+void Compiler::SuperInvoke(const Super& super, const Call& call) {
+  const Token<>* keyword = super.GetKeyword();
+  if (!CheckSuper(*keyword)) return;
+
+  uint16_t name = NameConstant(*super.GetMethod());
+  NamedVariable(SyntheticToken(TokenType::THIS, "this", keyword->line),
+                false);
+  NamedVariable(SyntheticToken(TokenType::SUPER, "super", keyword->line),
+                false);
+  _line = super.GetMethod()->line;
+  Emit(OpCode::SUPER_METHOD);
+  EmitShort(name);
+  EmitShort(MakeCache());
+  InvokeWith(call);
+}
+
+void Compiler::InvokeWith(const Call& call) {
+  for (const Expr* arg : call.GetArgs()) {
+    Compile(arg);
+  }
+
+  _line = call.GetParen()->line;
+  Emit(OpCode::INVOKE);
+  EmitByte(static_cast<uint8_t>(call.GetArgs().size()));
+}
+
+void Compiler::VisitGetExpr(const Get& expr) {
+  Compile(expr.GetObject());
+  uint16_t name = NameConstant(*expr.GetName());
+  _line = expr.GetName()->line;
+  Emit(OpCode::GET_PROPERTY);
+  EmitShort(name);
+  EmitShort(MakeCache());
+}
+
+void Compiler::VisitGroupingExpr(const Grouping& expr) {
+  Compile(expr.GetExpr());
+}
+
+void Compiler::VisitLiteralExpr(const Literal& expr) {
+  const LiteralValue& value = expr.GetValue();
+  if (auto* number = std::get_if<double>(&value)) {
+    EmitConstant(Value::Number(*number));
+  } else if (auto* boolean = std::get_if<bool>(&value)) {
+    Emit(*boolean ? OpCode::TRUE : OpCode::FALSE);
+  } else if (auto* string = std::get_if<const Symbol*>(&value)) {
+    EmitConstant(Value::Object(_heap.Intern(*string)));
+  } else {
+    Emit(OpCode::NIL);
+  }
+}
+
+void Compiler::VisitLogicalExpr(const Logical& expr) {
+  Compile(expr.GetLeft());
+  _line = expr.GetOperator()->line;
+
+  if (expr.GetOperator()->type == TokenType::AND) {
+    size_t end_jump = EmitJump(OpCode::JUMP_IF_FALSE);
+    Emit(OpCode::POP);
+    Compile(expr.GetRight());
+    PatchJump(end_jump);
+  } else {
+    size_t else_jump = EmitJump(OpCode::JUMP_IF_FALSE);
+    size_t end_jump = EmitJump(OpCode::JUMP);
+    PatchJump(else_jump);
+    Emit(OpCode::POP);
+    Compile(expr.GetRight());
+    PatchJump(end_jump);
+  }
+}
+
+void Compiler::VisitSetExpr(const Set& expr) {
+  Compile(expr.GetObject());
+  Compile(expr.GetValue());
+  uint16_t name = NameConstant(*expr.GetName());
+  _line = expr.GetName()->line;
+  Emit(OpCode::SET_PROPERTY);
+  EmitShort(name);
+  EmitShort(MakeCache());
+}
+
+bool Compiler::CheckSuper(const Token<>& keyword) {
+  if (_classes.empty()) {
+    ErrorAt(keyword, "Can't use 'super' outside of a class.");
+    return false;
+  }
+  if (!_classes.back().has_superclass) {
+    ErrorAt(keyword, "Can't use 'super' in a class with no superclass.");
+    return false;
+  }
+  return true;
+}
+
+void Compiler::VisitSuperExpr(const Super& expr) {
+  const Token<>* keyword = expr.GetKeyword();
+  if (!CheckSuper(*keyword)) return;
+
+  uint16_t name = NameConstant(*expr.GetMethod());
+  NamedVariable(SyntheticToken(TokenType::THIS, "this", keyword->line),
+                false);
+  NamedVariable(SyntheticToken(TokenType::SUPER, "super", keyword->line),
+                false);
+  Emit(OpCode::GET_SUPER);
+  EmitShort(name);
+}
+
+void Compiler::VisitThisExpr(const This& expr) {
+  if (_classes.empty()) {
+    ErrorAt(*expr.GetKeyword(), "Can't use 'this' outside of a class.");
+    return;
+  }
+  NamedVariable(*expr.GetKeyword(), false);
+}
+
+void Compiler::VisitUnaryExpr(const Unary& expr) {
+  Compile(expr.GetRight());
+  _line = expr.GetOperator()->line;
+  Emit(expr.GetOperator()->type == TokenType::MINUS ? OpCode::NEGATE
+                                                    : OpCode::NOT);
+}
+
+void Compiler::VisitVariableExpr(const Variable& expr) {
+  NamedVariable(*expr.GetName(), false);
+}
+
+// ------------- STATEMENTS -------------
+void Compiler::VisitBlockStmt(const Block& stmt) {
+  BeginScope();
+  for (const Stmt* inner : stmt.GetStatements()) {
+    Compile(inner);
+  }
+  EndScope();
+}
+
+void Compiler::VisitClassStmt(const Class& stmt) {
+  const Token<>& name = *stmt.GetName();
+  uint16_t name_constant = NameConstant(name);
+  DeclareVariable(name);
+
+  _line = name.line;
+  Emit(OpCode::CLASS);
+  EmitShort(name_constant);
+  DefineVariable(name);
+
+  _classes.push_back({});
+
+  // The superclass lives in a local named `super` that methods capture
+  if (const Variable* superclass = stmt.GetSuperclass()) {
+    if (superclass->GetName()->lexeme == name.lexeme) {
+      ErrorAt(*superclass->GetName(), "A class can't inherit from itself.");
+    }
+
+    NamedVariable(*superclass->GetName(), false);
+    BeginScope();
+    AddLocal("super");
+    MarkInitialized();
+
+    NamedVariable(name, false);
+    Emit(OpCode::INHERIT);
+    _classes.back().has_superclass = true;
+  }
+
+  // The class stays on the stack while its methods are attached
+  NamedVariable(name, false);
+  for (const Function* method : stmt.GetMethods()) {
+    uint16_t method_name = NameConstant(*method->GetName());
+    bool is_init = method->GetName()->lexeme == "init";
+    CompileFunction(*method, is_init ? FunctionKind::INITIALIZER
+                                     : FunctionKind::METHOD);
+    Emit(OpCode::METHOD);
+    EmitShort(method_name);
+  }
+  Emit(OpCode::POP);
+
+  if (_classes.back().has_superclass) {
+    EndScope();
+  }
+  _classes.pop_back();
+}
+
+void Compiler::VisitExpressionStmt(const Expression& stmt) {
+  Compile(stmt.GetExpr());
+  Emit(OpCode::POP);
+}
+
+void Compiler::VisitFunctionStmt(const Function& stmt) {
+  // Initialised before the body is compiled, so it can call itself
+  DeclareVariable(*stmt.GetName());
+  MarkInitialized();
+  CompileFunction(stmt, FunctionKind::FUNCTION);
+  DefineVariable(*stmt.GetName());
+}
+
+void Compiler::VisitIfStmt(const If& stmt) {
+  Compile(stmt.GetCondition());
+
+  size_t then_jump = EmitJump(OpCode::JUMP_IF_FALSE);
+  Emit(OpCode::POP);
+  Compile(stmt.GetThen());
+
+  size_t else_jump = EmitJump(OpCode::JUMP);
+  PatchJump(then_jump);
+  Emit(OpCode::POP);
+  if (stmt.GetElse() != nullptr) {
+    Compile(stmt.GetElse());
+  }
+  PatchJump(else_jump);
+}
+
+void Compiler::VisitPrintStmt(const Print& stmt) {
+  Compile(stmt.GetExpr());
+  Emit(OpCode::PRINT);
+}
+
+void Compiler::VisitReturnStmt(const Return& stmt) {
+  const Token<>& keyword = *stmt.GetKeyword();
+  if (Current().kind == FunctionKind::SCRIPT) {
+    ErrorAt(keyword, "Can't return from top-level code.");
+  }
+
+  _line = keyword.line;
+  if (stmt.GetValue() == nullptr) {
+    EmitReturn();
+    return;
+  }
+
+  if (Current().kind == FunctionKind::INITIALIZER) {
+    ErrorAt(keyword, "Can't return a value from an initializer.");
+  }
+  Compile(stmt.GetValue());
+  Emit(OpCode::RETURN);
+}
+
+void Compiler::VisitVarStmt(const Var& stmt) {
+  const Token<>& name = *stmt.GetName();
+  DeclareVariable(name);
+
+  if (stmt.GetInitializer() != nullptr) {
+    Compile(stmt.GetInitializer());
+  } else {
+    _line = name.line;
+    Emit(OpCode::NIL);
+  }
+
+  DefineVariable(name);
+}
+
+void Compiler::VisitWhileStmt(const While& stmt) {
+  size_t loop_start = CurrentChunk().Size();
+  Compile(stmt.GetCondition());
+
+  size_t exit_jump = EmitJump(OpCode::JUMP_IF_FALSE);
+  Emit(OpCode::POP);
+  Compile(stmt.GetBody());
+  EmitLoop(loop_start);
+
+  PatchJump(exit_jump);
+  Emit(OpCode::POP);
+}
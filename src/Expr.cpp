@@ -1,128 +1,145 @@
 #include "Expr.hpp"
 
+#include <type_traits>
+
 // ------------- ASSIGN CLASS -------------
-template <typename T, typename U>
-Assign<T, U>::Assign(Token<U>& name, Expr<T, U>& value) noexcept
-    : _value(value.Clone()), _name(std::make_unique<Token<U>>(name)) {}
+Assign::Assign(Token<>&& name, const Expr* value) noexcept
+    : Expr(Kind::ASSIGN), _value(value), _name(std::move(name)) {}
 
-template <typename T, typename U>
-Assign<T, U>::Assign(Assign&& other) noexcept
-    : _value(std::move(other._value)), _name(std::move(other._name)) {}
+Assign::Assign(Assign&& other) noexcept
+    : Expr(std::move(other)),
+      _value(other._value),
+      _name(std::move(other._name)),
+      _slot(other._slot) {}
 
 // ------------- BINARY CLASS -------------
-template <typename T, typename U>
-Binary<T, U>::Binary(Expr<T, U>& left, Token<U>& oper,
-                     Expr<T, U>& right) noexcept
-    : _left(left.Clone()),
-      _operator(std::make_unique<Token<U>>(oper)),
-      _right(right.Clone()) {}
-
-template <typename T, typename U>
-Binary<T, U>::Binary(Binary&& other) noexcept
-    : _left(std::move(other._left)),
+Binary::Binary(const Expr* left, Token<>&& oper, const Expr* right) noexcept
+    : Expr(Kind::BINARY),
+      _left(left),
+      _operator(std::move(oper)),
+      _right(right) {}
+
+Binary::Binary(Binary&& other) noexcept
+    : Expr(std::move(other)),
+      _left(other._left),
       _operator(std::move(other._operator)),
-      _right(std::move(other._right)) {}
+      _right(other._right) {}
 
 // ------------- CALL CLASS -------------
-template <typename T, typename U>
-Call<T, U>::Call(Expr<T, U>& callee, Token<U>& paren,
-                 PtrVecExpr<T, U>& arguments) noexcept
-    : _callee(callee.Clone()), _paren(std::make_unique<Token<U>>(paren)) {
-  _arguments = std::make_unique<PtrVecExpr<T, U>>();
-  for (auto&& arg : arguments) {
-    _arguments->push_back(arg->Clone());
-  }
-}
-
-template <typename T, typename U>
-Call<T, U>::Call(Call&& other) noexcept
-    : _callee(std::move(other._callee)),
+Call::Call(const Expr* callee, Token<>&& paren, ExprList arguments) noexcept
+    : Expr(Kind::CALL),
+      _callee(callee),
+      _paren(std::move(paren)),
+      _arguments(arguments) {}
+
+Call::Call(Call&& other) noexcept
+    : Expr(std::move(other)),
+      _callee(other._callee),
       _paren(std::move(other._paren)),
-      _arguments(std::move(other._arguments)) {}
+      _arguments(other._arguments),
+      _cache(other._cache) {}
 
 // ------------- GET CLASS -------------
-template <typename T, typename U>
-Get<T, U>::Get(Expr<T, U>& object, Token<U>& name) noexcept
-    : _object(object.Clone()), _name(std::make_unique<Token<U>>(name)) {}
+Get::Get(const Expr* object, Token<>&& name, const Symbol* symbol) noexcept
+    : Expr(Kind::GET),
+      _object(object),
+      _name(std::move(name)),
+      _symbol(symbol) {}
 
-template <typename T, typename U>
-Get<T, U>::Get(Get&& other) noexcept
-    : _object(std::move(other._object)), _name(std::move(other._name)) {}
+Get::Get(Get&& other) noexcept
+    : Expr(std::move(other)),
+      _object(other._object),
+      _name(std::move(other._name)),
+      _symbol(other._symbol),
+      _cache(other._cache) {}
 
 // ------------- GROUPING CLASS -------------
-template <typename T, typename U>
-Grouping<T, U>::Grouping(Expr<T, U>& expression) noexcept
-    : _expression(expression.Clone()) {}
+Grouping::Grouping(const Expr* expression) noexcept
+    : Expr(Kind::GROUPING), _expression(expression) {}
 
-template <typename T, typename U>
-Grouping<T, U>::Grouping(Grouping&& other) noexcept
-    : _expression(std::move(other._expression)) {}
+Grouping::Grouping(Grouping&& other) noexcept
+    : Expr(std::move(other)), _expression(other._expression) {}
 
 // ------------- LITERAL CLASS -------------
-template <typename T, typename U>
-Literal<T, U>::Literal(T& value, size_t size) noexcept
-    : _value(std::make_unique<T>(value)), _size(size) {}
+Literal::Literal(LiteralValue value) noexcept
+    : Expr(Kind::LITERAL), _value(value) {}
 
-template <typename T, typename U>
-Literal<T, U>::Literal(Literal&& other) noexcept
-    : _value(std::move(other._value)), _size(std::move(other._size)) {}
+Literal::Literal(Literal&& other) noexcept
+    : Expr(std::move(other)), _value(other._value) {}
 
 // ------------- LOGICAL CLASS -------------
-template <typename T, typename U>
-Logical<T, U>::Logical(Expr<T, U>& left, Token<U>& oper,
-                       Expr<T, U>& right) noexcept
-    : _left(std::move(left)),
+Logical::Logical(const Expr* left, Token<>&& oper, const Expr* right) noexcept
+    : Expr(Kind::LOGICAL),
+      _left(left),
       _operator(std::move(oper)),
-      _right(std::move(right)) {}
+      _right(right) {}
 
-template <typename T, typename U>
-Logical<T, U>::Logical(Logical&& other) noexcept
-    : _left(other._left),
+Logical::Logical(Logical&& other) noexcept
+    : Expr(std::move(other)),
+      _left(other._left),
       _operator(std::move(other._operator)),
-      _right(std::move(other._right)) {}
+      _right(other._right) {}
 
 // ------------- SET CLASS -------------
-template <typename T, typename U>
-Set<T, U>::Set(Expr<T, U>& object, Token<U>& name, Expr<T, U>& value) noexcept
-    : _object(std::move(object)),
+Set::Set(const Expr* object, Token<>&& name, const Symbol* symbol,
+         const Expr* value) noexcept
+    : Expr(Kind::SET),
+      _object(object),
       _name(std::move(name)),
-      _value(std::move(value)) {}
+      _symbol(symbol),
+      _value(value) {}
 
-template <typename T, typename U>
-Set<T, U>::Set(Set&& other) noexcept
-    : _object(std::move(other._object)),
+Set::Set(Set&& other) noexcept
+    : Expr(std::move(other)),
+      _object(other._object),
       _name(std::move(other._name)),
-      _value(std::move(other._value)) {}
+      _symbol(other._symbol),
+      _value(other._value),
+      _cache(other._cache) {}
 
 // ------------- SUPER CLASS -------------
-template <typename T, typename U>
-Super<T, U>::Super(Token<U>& keyword, Token<U>& method) noexcept
-    : _keyword(std::move(keyword)), _method(std::move(method)) {}
-
-template <typename T, typename U>
-Super<T, U>::Super(Super&& other) noexcept
-    : _keyword(std::move(other._keyword)), _method(std::move(other._method)) {}
+Super::Super(Token<>&& keyword, Token<>&& method,
+             const Symbol* symbol) noexcept
+    : Expr(Kind::SUPER),
+      _keyword(std::move(keyword)),
+      _method(std::move(method)),
+      _symbol(symbol) {}
+
+Super::Super(Super&& other) noexcept
+    : Expr(std::move(other)),
+      _keyword(std::move(other._keyword)),
+      _method(std::move(other._method)),
+      _symbol(other._symbol),
+      _slot(other._slot) {}
 
 // ------------- THIS CLASS -------------
-template <typename T, typename U>
-This<T, U>::This(Token<U>& keyword) noexcept : _keyword(std::move(keyword)) {}
+This::This(Token<>&& keyword) noexcept
+    : Expr(Kind::THIS), _keyword(std::move(keyword)) {}
 
-template <typename T, typename U>
-This<T, U>::This(This&& other) noexcept : _keyword(std::move(other._keyword)) {}
+This::This(This&& other) noexcept
+    : Expr(std::move(other)),
+      _keyword(std::move(other._keyword)),
+      _slot(other._slot) {}
 
 // ------------- UNARY CLASS -------------
-template <typename T, typename U>
-Unary<T, U>::Unary(Token<U>& oper, Expr<T, U>& right) noexcept
-    : _operator(std::make_unique<Token<U>>(oper)), _right(right.Clone()) {}
+Unary::Unary(Token<>&& oper, const Expr* right) noexcept
+    : Expr(Kind::UNARY), _operator(std::move(oper)), _right(right) {}
 
-template <typename T, typename U>
-Unary<T, U>::Unary(Unary&& other) noexcept
-    : _operator(std::move(other._operator)), _right(std::move(other._right)) {}
+Unary::Unary(Unary&& other) noexcept
+    : Expr(std::move(other)),
+      _operator(std::move(other._operator)),
+      _right(other._right) {}
 
 // ------------- VARIABLE CLASS -------------
-template <typename T, typename U>
-Variable<T, U>::Variable(Token<U>& name) noexcept : _name(std::move(name)) {}
+Variable::Variable(Token<>&& name) noexcept
+    : Expr(Kind::VARIABLE), _name(std::move(name)) {}
+
+Variable::Variable(Variable&& other) noexcept
+    : Expr(std::move(other)),
+      _name(std::move(other._name)),
+      _slot(other._slot) {}
 
-template <typename T, typename U>
-Variable<T, U>::Variable(Variable&& other) noexcept
-    : _name(std::move(other._name)) {}
\ No newline at end of file
+static_assert(std::is_trivially_destructible_v<Binary> &&
+                  std::is_trivially_destructible_v<Call> &&
+                  std::is_trivially_destructible_v<Literal>,
+              "AST nodes are released by resetting their arena");
@@ -0,0 +1,258 @@
+#include "includes/Heap.hpp"
+
+#include <algorithm>
+
+#include "includes/Trace.hpp"
+
+Heap::~Heap() {
+  while (_objects != nullptr) {
+    Obj* next = _objects->_next;
+    delete _objects;
+    _objects = next;
+  }
+}
+
+std::chrono::nanoseconds Heap::Stats::Percentile(double fraction) const {
+  if (pauses.empty()) return std::chrono::nanoseconds(0);
+  std::vector<std::chrono::nanoseconds> sorted = pauses;
+  auto rank = static_cast<size_t>(fraction *
+                                  static_cast<double>(sorted.size() - 1));
+  std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+  return sorted[rank];
+}
+
+void Heap::Collect(Obj* keep) {
+  // Without roots everything would look unreachable
+  if (_roots == nullptr) return;
+
+  TraceSpan span("collect", "gc");
+  auto started = Clock::now();
+
+  // Whatever an unfinished cycle marked is still reachable, but it may
+  // have become garbage since, so a fresh cycle follows
+  if (_phase == Phase::MARKING) {
+    FinishMarking(keep);
+  }
+  if (_phase == Phase::SWEEPING) {
+    SweepUntil(Clock::time_point::max());
+    FinishCycle();
+  }
+
+  StartMarking();
+  FinishMarking(keep);
+  SweepUntil(Clock::time_point::max());
+  FinishCycle();
+
+  RecordPause(Clock::now() - started);
+}
+
+void Heap::Advance(Obj* newest) {
+  if (_max_pause == std::chrono::nanoseconds(0)) {
+    Collect(newest);
+    return;
+  }
+
+  // In stress mode the deadline has always passed, so each slice does a
+  // single round of work
+  TraceSpan span("collect slice", "gc");
+  auto started = Clock::now();
+  auto deadline = _stress ? started : started + _max_pause;
+
+  if (_phase == Phase::IDLE) {
+    StartMarking();
+  }
+  if (_phase == Phase::MARKING && MarkUntil(deadline)) {
+    FinishMarking(newest);
+  }
+  if (_phase == Phase::SWEEPING && SweepUntil(deadline)) {
+    FinishCycle();
+  }
+  RecordPause(Clock::now() - started);
+
+  if (_phase != Phase::IDLE) {
+    _next_gc = _bytes_allocated + STEP_BYTES;
+  }
+}
+
+void Heap::RecordPause(Clock::duration pause) {
+  auto nanoseconds =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(pause);
+  _stats.pause_count++;
+  _stats.total_pause += nanoseconds;
+  _stats.max_pause = std::max(_stats.max_pause, nanoseconds);
+  if (_record_pauses) {
+    _stats.pauses.push_back(nanoseconds);
+  }
+  if (Tracer* tracer = Tracer::Active()) {
+    tracer->Count("heap bytes", static_cast<double>(_bytes_allocated));
+  }
+}
+
+void Heap::StartMarking() {
+  _phase = Phase::MARKING;
+  _roots->MarkRoots(*this);
+}
+
+bool Heap::MarkUntil(Clock::time_point deadline) {
+  do {
+    for (size_t work = 0; work < SLICE_WORK && !_gray.empty(); work++) {
+      Obj* object = _gray.back();
+      _gray.pop_back();
+      Blacken(object);
+    }
+  } while (!_gray.empty() && Clock::now() < deadline);
+  return _gray.empty();
+}
+
+void Heap::FinishMarking(Obj* keep) {
+  Mark(keep);
+  _roots->MarkRoots(*this);
+  MarkUntil(Clock::time_point::max());
+
+  // Interned strings nothing else references go; the next use of the
+  // symbol makes a new one
+  for (auto string = _strings.begin(); string != _strings.end();) {
+    if (string->second->_marked) {
+      ++string;
+    } else {
+      string = _strings.erase(string);
+    }
+  }
+
+  // Live bytes are counted again as the sweep finds them
+  _phase = Phase::SWEEPING;
+  _sweep = &_objects;
+  _bytes_allocated = 0;
+}
+
+bool Heap::SweepUntil(Clock::time_point deadline) {
+  // Objects made from now on are linked in ahead of the cursor, so it has
+  // to move off the list head before the mutator runs again
+  bool first = true;
+  do {
+    for (size_t work = 0; (work < SLICE_WORK || first) && *_sweep != nullptr;
+         work++) {
+      Obj* object = *_sweep;
+      if (object->_marked) {
+        object->_marked = false;
+        _bytes_allocated += SizeOf(object);
+        _sweep = &object->_next;
+        first = false;
+        continue;
+      }
+
+      *_sweep = object->_next;
+      _stats.objects_freed++;
+      _stats.bytes_freed += SizeOf(object);
+      _count--;
+      delete object;
+    }
+  } while (*_sweep != nullptr && Clock::now() < deadline);
+  return *_sweep == nullptr;
+}
+
+void Heap::FinishCycle() {
+  _phase = Phase::IDLE;
+  _sweep = nullptr;
+  _stats.collections++;
+  _next_gc = std::max(_bytes_allocated * GROWTH_FACTOR, MIN_HEAP);
+}
+
+size_t Heap::SizeOf(const Obj* object) {
+  switch (object->GetType()) {
+    case ObjType::STRING: {
+      const auto* string = static_cast<const ObjString*>(object);
+      // Interned strings share the interner's copy of their text
+      return sizeof(ObjString) +
+             (string->GetSymbol() == nullptr ? string->View().size() : 0);
+    }
+    case ObjType::FUNCTION:
+      return sizeof(ObjFunction);
+    case ObjType::NATIVE:
+      return sizeof(ObjNative);
+    case ObjType::CLASS: {
+      const auto* klass = static_cast<const ObjClass*>(object);
+      return sizeof(ObjClass) +
+             klass->GetMethods().size() *
+                 sizeof(ObjClass::Methods::value_type) +
+             klass->GetShape()->TreeBytes();
+    }
+    case ObjType::INSTANCE:
+      return sizeof(ObjInstance) +
+             static_cast<const ObjInstance*>(object)->FieldBytes();
+    case ObjType::BOUND_METHOD:
+      return sizeof(ObjBoundMethod);
+    case ObjType::ENVIRONMENT:
+      return sizeof(Environment) +
+             static_cast<const Environment*>(object)->Values().size_bytes();
+    case ObjType::PROTO: {
+      const auto* proto = static_cast<const ObjProto*>(object);
+      return sizeof(ObjProto) + proto->GetChunk().MemoryUsage() +
+             proto->caches.size() * sizeof(InlineCache);
+    }
+    case ObjType::CLOSURE:
+      return sizeof(ObjClosure) +
+             static_cast<const ObjClosure*>(object)->Upvalues().size_bytes();
+    case ObjType::UPVALUE:
+      return sizeof(ObjUpvalue);
+  }
+  return 0;
+}
+
+void Heap::Blacken(Obj* object) {
+  switch (object->GetType()) {
+    case ObjType::STRING:
+    case ObjType::NATIVE:
+      break;
+    case ObjType::FUNCTION:
+      Mark(static_cast<ObjFunction*>(object)->GetClosure());
+      break;
+    case ObjType::CLASS: {
+      auto* klass = static_cast<ObjClass*>(object);
+      Mark(klass->GetSuperclass());
+      for (const auto& method : klass->GetMethods()) {
+        Mark(method.second);
+      }
+      break;
+    }
+    case ObjType::INSTANCE: {
+      auto* instance = static_cast<ObjInstance*>(object);
+      Mark(instance->GetClass());
+      instance->ForEachField([this](Value value) { Mark(value); });
+      break;
+    }
+    case ObjType::BOUND_METHOD: {
+      auto* bound = static_cast<ObjBoundMethod*>(object);
+      Mark(bound->GetReceiver());
+      Mark(bound->GetMethod<Obj>());
+      break;
+    }
+    case ObjType::ENVIRONMENT: {
+      auto* environment = static_cast<Environment*>(object);
+      Mark(environment->GetEnclosing());
+      for (Value value : environment->Values()) {
+        Mark(value);
+      }
+      break;
+    }
+    case ObjType::PROTO:
+      for (Value constant :
+           static_cast<ObjProto*>(object)->GetChunk().Constants()) {
+        Mark(constant);
+      }
+      break;
+    case ObjType::CLOSURE: {
+      auto* closure = static_cast<ObjClosure*>(object);
+      Mark(closure->GetProto());
+      // Upvalues are still null while the closure is being filled in
+      for (ObjUpvalue* upvalue : closure->Upvalues()) {
+        Mark(upvalue);
+      }
+      break;
+    }
+    case ObjType::UPVALUE:
+      // An open upvalue's variable is on the VM stack, a root of its own
+      Mark(static_cast<ObjUpvalue*>(object)->closed);
+      break;
+  }
+}
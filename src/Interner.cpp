@@ -0,0 +1,44 @@
+#include "includes/Interner.hpp"
+
+Interner& Interner::Global() {
+  static Interner interner;
+  return interner;
+}
+
+const Symbol* Interner::Intern(std::string_view text) {
+  uint64_t hash = robin_hood::hash_bytes(text.data(), text.size());
+  // The low bits pick the table's bucket, so shard on the high ones
+  Shard& shard = _shards[(hash >> 32) % SHARDS];
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.requests++;
+  shard.requested_bytes += text.size();
+  auto found = shard.table.find(text);
+  if (found != shard.table.end()) {
+    return found->second;
+  }
+
+  std::string_view copy = shard.arena.CopyString(text);
+  const Symbol* symbol = shard.arena.Make<Symbol>(Symbol{copy, hash});
+  shard.table.emplace(copy, symbol);
+  shard.text_bytes += text.size();
+  return symbol;
+}
+
+Interner::Stats Interner::GetStats() const {
+  Stats stats;
+  for (const Shard& shard : _shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    stats.symbols += shard.table.size();
+    stats.text_bytes += shard.text_bytes;
+    stats.requests += shard.requests;
+    stats.requested_bytes += shard.requested_bytes;
+    // A flat table stores its entries inline plus about a byte of
+    // metadata each, at a load factor of at most 80%
+    stats.memory +=
+        shard.arena.BytesReserved() +
+        shard.table.size() *
+            (sizeof(std::string_view) + sizeof(const Symbol*) + 1) * 5 / 4;
+  }
+  return stats;
+}
@@ -0,0 +1,553 @@
+#include "includes/Interpreter.hpp"
+
+#include "includes/Trace.hpp"
+
+Interpreter::Interpreter(Error& error, std::ostream& out)
+    : _error(error), _out(out), _resolver(error) {
+  _heap.SetRoots(this);
+  auto* clock = _heap.Make<ObjNative>("clock", 0, ClockNative);
+  _resolver.DeclareGlobal("clock");
+  _globals.resize(_resolver.GlobalCount());
+  Define("clock", Value::Object(clock));
+}
+
+void Interpreter::Interpret(StmtList statements) {
+  {
+    TraceSpan span("resolve");
+    if (!_resolver.Resolve(statements)) {
+      return;
+    }
+  }
+  _globals.resize(_resolver.GlobalCount());
+
+  TraceSpan span("execute");
+  try {
+    for (const Stmt* stmt : statements) {
+      Execute(stmt);
+      // A stray top-level `return` ends only its own statement
+      _returning = false;
+    }
+  } catch (const RuntimeError& e) {
+    _error.RuntimeError(e.line, e.what());
+    _environment = nullptr;
+    _returning = false;
+    _call_depth = 0;
+    _args.clear();
+    _temporaries.clear();
+  }
+}
+
+void Interpreter::ExecuteBlock(StmtList statements, Environment* environment) {
+  Environment* previous = _environment;
+  _environment = environment;
+  for (const Stmt* stmt : statements) {
+    Execute(stmt);
+    if (_returning) break;
+  }
+  _environment = previous;
+}
+
+Value Interpreter::CallValue(Value callee, std::span<const Value> args,
+                             const Token<>& paren, InlineCache& cache) {
+  if (callee.IsObject()) {
+    switch (callee.AsObject()->GetType()) {
+      case ObjType::FUNCTION: {
+        auto* function = AsObj<ObjFunction>(callee);
+        CheckArity(paren, function->Arity(), args.size());
+        return CallFunction(function, args, nullptr, paren);
+      }
+      case ObjType::NATIVE: {
+        auto* native = AsObj<ObjNative>(callee);
+        CheckArity(paren, native->Arity(), args.size());
+        return native->Call(args);
+      }
+      case ObjType::CLASS: {
+        auto* klass = AsObj<ObjClass>(callee);
+        Value instance = Value::Object(_heap.Make<ObjInstance>(klass));
+        if (auto* init =
+                klass->FindMethod<ObjFunction>(_init, cache, _cache_stats)) {
+          CheckArity(paren, init->Arity(), args.size());
+          // Until the call's environment holds it as `this`
+          Protect(instance);
+          CallFunction(init, args, &instance, paren);
+          Unprotect(instance);
+        } else {
+          CheckArity(paren, 0, args.size());
+        }
+        return instance;
+      }
+      case ObjType::BOUND_METHOD: {
+        auto* bound = AsObj<ObjBoundMethod>(callee);
+        auto* method = bound->GetMethod<ObjFunction>();
+        CheckArity(paren, method->Arity(), args.size());
+        Value receiver = bound->GetReceiver();
+        return CallFunction(method, args, &receiver, paren);
+      }
+      default:
+        break;
+    }
+  }
+
+  throw RuntimeError(paren.line, "Can only call functions and classes.");
+}
+
+void Interpreter::CheckArity(const Token<>& paren, size_t arity,
+                             size_t argc) {
+  if (argc != arity) {
+    throw RuntimeError(paren.line, "Expected " + std::to_string(arity) +
+                                       " arguments but got " +
+                                       std::to_string(argc) + ".");
+  }
+}
+
+Value Interpreter::CallFunction(ObjFunction* function,
+                                std::span<const Value> args,
+                                const Value* receiver,
+                                const Token<>& paren) {
+  if (_call_depth == CALLS_MAX) {
+    throw RuntimeError(paren.line, "Stack overflow.");
+  }
+  TraceSpan span(function->Name(), "function");
+  const Function* declaration = function->GetDeclaration();
+  // The caller's scope is not reachable from the callee's
+  Value caller = Value::Object(_environment);
+  Protect(caller);
+  auto* environment = _heap.Make<Environment>(function->GetClosure());
+  if (receiver != nullptr) {
+    environment->Define(*receiver);
+    _heap.WriteBarrier(environment, *receiver);
+  }
+  for (Value arg : args) {
+    environment->Define(arg);
+    _heap.WriteBarrier(environment, arg);
+  }
+
+  _call_depth++;
+  ExecuteBlock(declaration->GetBody(), environment);
+  _call_depth--;
+
+  Value result = _returning ? _return_value : Value::Nil();
+  _returning = false;
+  _return_value = Value::Nil();
+  Unprotect(caller);
+
+  if (function->IsInitializer() && receiver != nullptr) {
+    return *receiver;
+  }
+  return result;
+}
+
+Value Interpreter::LookUp(const Token<>& name, Slot slot) {
+  if (!slot.IsGlobal()) {
+    return _environment->Ancestor(slot.depth)->At(slot.index);
+  }
+
+  const Global& global = _globals[slot.index];
+  if (!global.defined) {
+    throw RuntimeError(
+        name.line, "Undefined variable '" + std::string(name.lexeme) + "'.");
+  }
+  return global.value;
+}
+
+void Interpreter::Store(const Token<>& name, Slot slot, Value value) {
+  if (!slot.IsGlobal()) {
+    Environment* environment = _environment->Ancestor(slot.depth);
+    environment->At(slot.index) = value;
+    _heap.WriteBarrier(environment, value);
+    return;
+  }
+
+  Global& global = _globals[slot.index];
+  if (!global.defined) {
+    throw RuntimeError(
+        name.line, "Undefined variable '" + std::string(name.lexeme) + "'.");
+  }
+  global.value = value;
+}
+
+void Interpreter::Define(std::string_view name, Value value) {
+  if (_environment != nullptr) {
+    _environment->Define(value);
+    _heap.WriteBarrier(_environment, value);
+    return;
+  }
+
+  // Globals are defined once per declaration, so the lookup by name stays
+  // off the paths that read and write them
+  Global& global = _globals[_resolver.GlobalSlot(name)];
+  global.value = value;
+  global.defined = true;
+}
+
+double Interpreter::NumberOperand(const Token<>& oper, Value operand) {
+  if (!operand.IsNumber()) {
+    throw RuntimeError(oper.line, "Operand must be a number.");
+  }
+  return operand.AsNumber();
+}
+
+void Interpreter::MarkRoots(Heap& heap) {
+  for (const Global& global : _globals) {
+    heap.Mark(global.value);
+  }
+  heap.Mark(_environment);
+  heap.Mark(_return_value);
+  for (Value value : _args) {
+    heap.Mark(value);
+  }
+  for (Value value : _temporaries) {
+    heap.Mark(value);
+  }
+}
+
+// ------------- EXPRESSIONS -------------
+Value Interpreter::VisitAssignExpr(const Assign& expr) {
+  Value value = Evaluate(expr.GetValue());
+  Store(*expr.GetName(), expr.GetSlot(), value);
+  return value;
+}
+
+Value Interpreter::VisitBinaryExpr(const Binary& expr) {
+  Value left = Evaluate(expr.GetLeft());
+  Protect(left);
+  Value right = Evaluate(expr.GetRight());
+  Unprotect(left);
+  const Token<>* oper = expr.GetOperator();
+
+  switch (oper->type) {
+    case TokenType::EQUAL_EQUAL:
+      return Value::Bool(ValuesEqual(left, right));
+    case TokenType::BANG_EQUAL:
+      return Value::Bool(!ValuesEqual(left, right));
+    case TokenType::PLUS:
+      if (left.IsNumber() && right.IsNumber()) {
+        return Value::Number(left.AsNumber() + right.AsNumber());
+      }
+      if (IsObjType(left, ObjType::STRING) &&
+          IsObjType(right, ObjType::STRING)) {
+        std::string_view a = AsObj<ObjString>(left)->View();
+        std::string_view b = AsObj<ObjString>(right)->View();
+        std::string chars;
+        chars.reserve(a.size() + b.size());
+        chars.append(a).append(b);
+        return Value::Object(_heap.Make<ObjString>(std::move(chars)));
+      }
+      throw RuntimeError(oper->line,
+                         "Operands must be two numbers or two strings.");
+    default:
+      break;
+  }
+
+  if (!left.IsNumber() || !right.IsNumber()) {
+    throw RuntimeError(oper->line, "Operands must be numbers.");
+  }
+  double a = left.AsNumber();
+  double b = right.AsNumber();
+
+  switch (oper->type) {
+    case TokenType::MINUS:
+      return Value::Number(a - b);
+    case TokenType::SLASH:
+      return Value::Number(a / b);
+    case TokenType::STAR:
+      return Value::Number(a * b);
+    case TokenType::GREATER:
+      return Value::Bool(a > b);
+    case TokenType::GREATER_EQUAL:
+      return Value::Bool(a >= b);
+    case TokenType::LESS:
+      return Value::Bool(a < b);
+    case TokenType::LESS_EQUAL:
+      return Value::Bool(a <= b);
+    default:
+      break;
+  }
+  __builtin_unreachable();
+}
+
+size_t Interpreter::PushArgs(const Call& call) {
+  size_t start = _args.size();
+  for (const Expr* arg : call.GetArgs()) {
+    Value value = Evaluate(arg);
+    _args.push_back(value);
+  }
+  return start;
+}
+
+Value Interpreter::VisitCallExpr(const Call& expr) {
+  // A method called where it is looked up never needs its bound method
+  const Expr* callee_expr = expr.GetCallee();
+  if (callee_expr->GetKind() == Expr::Kind::GET) {
+    return Invoke(static_cast<const Get&>(*callee_expr), expr);
+  }
+  if (callee_expr->GetKind() == Expr::Kind::SUPER) {
+    return SuperInvoke(static_cast<const Super&>(*callee_expr), expr);
+  }
+
+  Value callee = Evaluate(callee_expr);
+  Protect(callee);
+  size_t start = PushArgs(expr);
+
+  // The span is taken only once every argument is pushed, since nested
+  // calls may have grown the stack
+  Value result =
+      CallValue(callee, std::span<const Value>(_args).subspan(start),
+                *expr.GetParen(), expr.GetCache());
+  _args.resize(start);
+  Unprotect(callee);
+  return result;
+}
+
+Value Interpreter::Invoke(const Get& get, const Call& call) {
+  // Looked up before the arguments are evaluated, as a Get callee would be
+  Value object = Evaluate(get.GetObject());
+  const Token<>* name = get.GetName();
+  if (!IsObjType(object, ObjType::INSTANCE)) {
+    throw RuntimeError(name->line, "Only instances have properties.");
+  }
+
+  Obj* method = nullptr;
+  Value* field = AsObj<ObjInstance>(object)->GetProperty(
+      get.GetSymbol(), get.GetCache(), _cache_stats, method);
+  if (field == nullptr && method == nullptr) {
+    throw RuntimeError(
+        name->line, "Undefined property '" + std::string(name->lexeme) + "'.");
+  }
+  bool is_field = field != nullptr;
+  // A field's value is called like any other; the Get site's cache holds
+  // receiver shapes, so the call's own finds a class's initializer
+  Value callee = is_field ? *field : object;
+  Protect(callee);
+  size_t start = PushArgs(call);
+
+  std::span<const Value> args = std::span<const Value>(_args).subspan(start);
+  Value result;
+  if (is_field) {
+    result = CallValue(callee, args, *call.GetParen(), call.GetCache());
+  } else {
+    auto* function = static_cast<ObjFunction*>(method);
+    CheckArity(*call.GetParen(), function->Arity(), args.size());
+    _heap.CountElided();
+    result = CallFunction(function, args, &object, *call.GetParen());
+  }
+  _args.resize(start);
+  Unprotect(callee);
+  return result;
+}
+
+Value Interpreter::SuperInvoke(const Super& super, const Call& call) {
+  // As in VisitSuperExpr; `this` stays reachable through the scope
+  Slot slot = super.GetSlot();
+  Environment* scope = _environment->Ancestor(slot.depth - 1);
+  auto* superclass = AsObj<ObjClass>(scope->GetEnclosing()->At(slot.index));
+  Value object = scope->At(0);
+  const Token<>* name = super.GetMethod();
+
+  // The call site never calls a class, so its cache is free for the
+  // superclass's method
+  auto* method = superclass->FindMethod<ObjFunction>(
+      super.GetSymbol(), call.GetCache(), _cache_stats);
+  if (method == nullptr) {
+    throw RuntimeError(
+        name->line, "Undefined property '" + std::string(name->lexeme) + "'.");
+  }
+  size_t start = PushArgs(call);
+
+  std::span<const Value> args = std::span<const Value>(_args).subspan(start);
+  CheckArity(*call.GetParen(), method->Arity(), args.size());
+  _heap.CountElided();
+  Value result = CallFunction(method, args, &object, *call.GetParen());
+  _args.resize(start);
+  return result;
+}
+
+Value Interpreter::VisitGetExpr(const Get& expr) {
+  Value object = Evaluate(expr.GetObject());
+  const Token<>* name = expr.GetName();
+  if (!IsObjType(object, ObjType::INSTANCE)) {
+    throw RuntimeError(name->line, "Only instances have properties.");
+  }
+
+  Obj* method = nullptr;
+  if (Value* field = AsObj<ObjInstance>(object)->GetProperty(
+          expr.GetSymbol(), expr.GetCache(), _cache_stats, method)) {
+    return *field;
+  }
+  if (method != nullptr) {
+    return Value::Object(_heap.Make<ObjBoundMethod>(object, method));
+  }
+
+  throw RuntimeError(
+      name->line, "Undefined property '" + std::string(name->lexeme) + "'.");
+}
+
+Value Interpreter::VisitGroupingExpr(const Grouping& expr) {
+  return Evaluate(expr.GetExpr());
+}
+
+Value Interpreter::VisitLiteralExpr(const Literal& expr) {
+  const LiteralValue& value = expr.GetValue();
+  if (auto* number = std::get_if<double>(&value)) {
+    return Value::Number(*number);
+  }
+  if (auto* boolean = std::get_if<bool>(&value)) {
+    return Value::Bool(*boolean);
+  }
+  if (auto* string = std::get_if<const Symbol*>(&value)) {
+    return Value::Object(_heap.Intern(*string));
+  }
+  return Value::Nil();
+}
+
+Value Interpreter::VisitLogicalExpr(const Logical& expr) {
+  Value left = Evaluate(expr.GetLeft());
+
+  if (expr.GetOperator()->type == TokenType::OR) {
+    if (!left.IsFalsey()) return left;
+  } else {
+    if (left.IsFalsey()) return left;
+  }
+
+  return Evaluate(expr.GetRight());
+}
+
+Value Interpreter::VisitSetExpr(const Set& expr) {
+  Value object = Evaluate(expr.GetObject());
+  if (!IsObjType(object, ObjType::INSTANCE)) {
+    throw RuntimeError(expr.GetName()->line, "Only instances have fields.");
+  }
+
+  Protect(object);
+  Value value = Evaluate(expr.GetValue());
+  Unprotect(object);
+  AsObj<ObjInstance>(object)->SetProperty(expr.GetSymbol(), value,
+                                          expr.GetCache(), _cache_stats);
+  _heap.WriteBarrier(object.AsObject(), value);
+  return value;
+}
+
+Value Interpreter::VisitSuperExpr(const Super& expr) {
+  // `this` sits in the call's scope, just inside the one holding `super`
+  Slot slot = expr.GetSlot();
+  Environment* scope = _environment->Ancestor(slot.depth - 1);
+  auto* superclass = AsObj<ObjClass>(scope->GetEnclosing()->At(slot.index));
+  Value object = scope->At(0);
+  const Token<>* name = expr.GetMethod();
+
+  ObjFunction* method = superclass->FindMethod<ObjFunction>(expr.GetSymbol());
+  if (method == nullptr) {
+    throw RuntimeError(
+        name->line, "Undefined property '" + std::string(name->lexeme) + "'.");
+  }
+  return Value::Object(_heap.Make<ObjBoundMethod>(object, method));
+}
+
+Value Interpreter::VisitThisExpr(const This& expr) {
+  return LookUp(*expr.GetKeyword(), expr.GetSlot());
+}
+
+Value Interpreter::VisitUnaryExpr(const Unary& expr) {
+  Value right = Evaluate(expr.GetRight());
+  const Token<>* oper = expr.GetOperator();
+
+  if (oper->type == TokenType::MINUS) {
+    return Value::Number(-NumberOperand(*oper, right));
+  }
+  return Value::Bool(right.IsFalsey());
+}
+
+Value Interpreter::VisitVariableExpr(const Variable& expr) {
+  return LookUp(*expr.GetName(), expr.GetSlot());
+}
+
+// ------------- STATEMENTS -------------
+void Interpreter::VisitBlockStmt(const Block& stmt) {
+  ExecuteBlock(stmt.GetStatements(), _heap.Make<Environment>(_environment));
+}
+
+void Interpreter::VisitClassStmt(const Class& stmt) {
+  ObjClass* superclass = nullptr;
+  if (const Variable* super_expr = stmt.GetSuperclass()) {
+    Value value = Evaluate(super_expr);
+    if (!IsObjType(value, ObjType::CLASS)) {
+      throw RuntimeError(super_expr->GetName()->line,
+                         "Superclass must be a class.");
+    }
+    superclass = AsObj<ObjClass>(value);
+  }
+
+  std::string_view name = stmt.GetName()->lexeme;
+  Define(name, Value::Nil());
+  Environment* scope = _environment;
+
+  // Methods close over a scope that holds `super`
+  if (superclass != nullptr) {
+    _environment = _heap.Make<Environment>(_environment);
+    _environment->Define(Value::Object(superclass));
+    _heap.WriteBarrier(_environment, superclass);
+  }
+
+  // The class is stored under its name before its methods are made, which
+  // keeps it reachable while they are. The name was the scope's latest
+  // definition.
+  auto* klass = _heap.Make<ObjClass>(name, superclass);
+  if (scope != nullptr) {
+    scope->At(scope->Size() - 1) = Value::Object(klass);
+    _heap.WriteBarrier(scope, klass);
+  } else {
+    _globals[_resolver.GlobalSlot(name)].value = Value::Object(klass);
+  }
+
+  for (const Function* method : stmt.GetMethods()) {
+    auto* function = _heap.Make<ObjFunction>(method, _environment,
+                                             method->GetSymbol() == _init);
+    klass->AddMethod(method->GetSymbol(), function);
+    _heap.WriteBarrier(klass, function);
+  }
+
+  if (superclass != nullptr) {
+    _environment = _environment->GetEnclosing();
+  }
+}
+
+void Interpreter::VisitExpressionStmt(const Expression& stmt) {
+  Evaluate(stmt.GetExpr());
+}
+
+void Interpreter::VisitFunctionStmt(const Function& stmt) {
+  auto* function = _heap.Make<ObjFunction>(&stmt, _environment, false);
+  Define(stmt.GetName()->lexeme, Value::Object(function));
+}
+
+void Interpreter::VisitIfStmt(const If& stmt) {
+  if (!Evaluate(stmt.GetCondition()).IsFalsey()) {
+    Execute(stmt.GetThen());
+  } else if (stmt.GetElse() != nullptr) {
+    Execute(stmt.GetElse());
+  }
+}
+
+void Interpreter::VisitPrintStmt(const Print& stmt) {
+  _out << Stringify(Evaluate(stmt.GetExpr())) << '\n';
+}
+
+void Interpreter::VisitReturnStmt(const Return& stmt) {
+  _return_value =
+      stmt.GetValue() != nullptr ? Evaluate(stmt.GetValue()) : Value::Nil();
+  _returning = true;
+}
+
+void Interpreter::VisitVarStmt(const Var& stmt) {
+  Value value = stmt.GetInitializer() != nullptr
+                    ? Evaluate(stmt.GetInitializer())
+                    : Value::Nil();
+  Define(stmt.GetName()->lexeme, value);
+}
+
+void Interpreter::VisitWhileStmt(const While& stmt) {
+  while (!Evaluate(stmt.GetCondition()).IsFalsey()) {
+    Execute(stmt.GetBody());
+    if (_returning) break;
+  }
+}
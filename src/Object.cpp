@@ -0,0 +1,135 @@
+#include "includes/Object.hpp"
+
+#include <fmt/core.h>
+
+#include <chrono>
+
+Obj* ObjClass::FindMethodObj(const Symbol* name) const {
+  for (const ObjClass* klass = this; klass != nullptr;
+       klass = klass->_superclass) {
+    auto method = klass->_methods.find(name);
+    if (method != klass->_methods.end()) {
+      return method->second;
+    }
+  }
+  return nullptr;
+}
+
+void ObjInstance::SetField(const Symbol* name, Value value) {
+  if (_shape != nullptr) {
+    uint32_t slot = _shape->Find(name);
+    if (slot != Shape::NOT_FOUND) {
+      Slot(slot) = value;
+      return;
+    }
+    if (Shape* next = _shape->Transition(name)) {
+      AddField(next, value);
+      return;
+    }
+
+    // Off the shape tree for good
+    _dictionary = std::make_unique<Dictionary>();
+    std::span<const Symbol* const> names = _shape->Names();
+    for (uint32_t i = 0; i < names.size(); i++) {
+      _dictionary->emplace(names[i], Slot(i));
+    }
+    _shape = nullptr;
+    _overflow = {};
+  }
+  (*_dictionary)[name] = value;
+}
+
+const InlineCache::Target* ObjInstance::ResolveLoad(const Symbol* name,
+                                                    InlineCache& cache) {
+  InlineCache::Target target;
+  uint32_t slot = _shape->Find(name);
+  if (slot != Shape::NOT_FOUND) {
+    target.slot = slot;
+  } else {
+    target.method = _klass->FindMethodObj(name);
+  }
+  return cache.Add(_shape->Id(), target);
+}
+
+const InlineCache::Target* ObjInstance::ResolveStore(const Symbol* name,
+                                                     InlineCache& cache) {
+  if (_shape == nullptr) return nullptr;
+
+  InlineCache::Target target;
+  uint32_t slot = _shape->Find(name);
+  if (slot != Shape::NOT_FOUND) {
+    target.slot = slot;
+  } else {
+    target.transition = _shape->Transition(name);
+    if (target.transition == nullptr) return nullptr;
+  }
+  return cache.Add(_shape->Id(), target);
+}
+
+size_t ObjInstance::FieldBytes() const {
+  if (_shape == nullptr) {
+    return _dictionary->size() * sizeof(Dictionary::value_type);
+  }
+  return _overflow.capacity() * sizeof(Value);
+}
+
+bool ValuesEqual(Value a, Value b) {
+  if (a.IsNumber() && b.IsNumber()) {
+    return a.AsNumber() == b.AsNumber();
+  }
+  if (IsObjType(a, ObjType::STRING) && IsObjType(b, ObjType::STRING)) {
+    const auto* x = AsObj<ObjString>(a);
+    const auto* y = AsObj<ObjString>(b);
+    // A heap has one string per symbol, so two interned strings are only
+    // equal if they are the same object
+    if (x->GetSymbol() != nullptr && y->GetSymbol() != nullptr) {
+      return x == y;
+    }
+    return x->View() == y->View();
+  }
+  return a.Bits() == b.Bits();
+}
+
+std::string Stringify(Value value) {
+  if (value.IsNil()) return "nil";
+  if (value.IsBool()) return value.AsBool() ? "true" : "false";
+  if (value.IsNumber()) return fmt::format("{}", value.AsNumber());
+
+  switch (value.AsObject()->GetType()) {
+    case ObjType::STRING:
+      return std::string(AsObj<ObjString>(value)->View());
+    case ObjType::FUNCTION:
+      return fmt::format("<fn {}>", AsObj<ObjFunction>(value)->Name());
+    case ObjType::NATIVE:
+      return "<native fn>";
+    case ObjType::CLASS:
+      return std::string(AsObj<ObjClass>(value)->Name());
+    case ObjType::INSTANCE:
+      return fmt::format("{} instance",
+                         AsObj<ObjInstance>(value)->GetClass()->Name());
+    case ObjType::BOUND_METHOD: {
+      const auto* bound = AsObj<ObjBoundMethod>(value);
+      Obj* method = bound->GetMethod<Obj>();
+      if (method->GetType() == ObjType::CLOSURE) {
+        return fmt::format(
+            "<fn {}>", static_cast<ObjClosure*>(method)->GetProto()->Name());
+      }
+      return fmt::format("<fn {}>", static_cast<ObjFunction*>(method)->Name());
+    }
+    case ObjType::PROTO:
+      return fmt::format("<fn {}>", AsObj<ObjProto>(value)->Name());
+    case ObjType::CLOSURE:
+      return fmt::format("<fn {}>",
+                         AsObj<ObjClosure>(value)->GetProto()->Name());
+    case ObjType::UPVALUE:
+      return "<upvalue>";
+    case ObjType::ENVIRONMENT:
+      break;
+  }
+  return "<environment>";
+}
+
+Value ClockNative([[maybe_unused]] std::span<const Value> args) {
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return Value::Number(std::chrono::duration<double>(now).count());
+}
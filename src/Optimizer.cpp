@@ -0,0 +1,413 @@
+#include "includes/Optimizer.hpp"
+
+#include <string>
+
+namespace {
+
+// Tokens are move-only, so a rebuilt node gets a fresh one with the same
+// lexeme and line
+Token<> Copy(const Token<>* token) {
+  return Token<>(token->type, token->lexeme, nullptr, token->line);
+}
+
+const Literal* AsLiteral(const Expr* expr) {
+  if (expr->GetKind() != Expr::Kind::LITERAL) return nullptr;
+  return static_cast<const Literal*>(expr);
+}
+
+bool IsTruthy(const LiteralValue& value) {
+  if (std::holds_alternative<std::nullptr_t>(value)) return false;
+  if (const bool* boolean = std::get_if<bool>(&value)) return *boolean;
+  return true;
+}
+
+// ------------- NODE COUNTER -------------
+class NodeCounter : public Expr::Visitor<void>, public Stmt::Visitor<void> {
+ public:
+  size_t count = 0;
+
+  void Count(const Expr* expr) {
+    if (expr) expr->Accept(*this);
+  }
+
+  void Count(const Stmt* stmt) {
+    if (stmt) stmt->Accept(*this);
+  }
+
+  void Count(StmtList statements) {
+    for (const Stmt* stmt : statements) Count(stmt);
+  }
+
+  void VisitAssignExpr(const Assign& expr) override {
+    count++;
+    Count(expr.GetValue());
+  }
+
+  void VisitBinaryExpr(const Binary& expr) override {
+    count++;
+    Count(expr.GetLeft());
+    Count(expr.GetRight());
+  }
+
+  void VisitCallExpr(const Call& expr) override {
+    count++;
+    Count(expr.GetCallee());
+    for (const Expr* arg : expr.GetArgs()) Count(arg);
+  }
+
+  void VisitGetExpr(const Get& expr) override {
+    count++;
+    Count(expr.GetObject());
+  }
+
+  void VisitGroupingExpr(const Grouping& expr) override {
+    count++;
+    Count(expr.GetExpr());
+  }
+
+  void VisitLiteralExpr(const Literal&) override { count++; }
+
+  void VisitLogicalExpr(const Logical& expr) override {
+    count++;
+    Count(expr.GetLeft());
+    Count(expr.GetRight());
+  }
+
+  void VisitSetExpr(const Set& expr) override {
+    count++;
+    Count(expr.GetObject());
+    Count(expr.GetValue());
+  }
+
+  void VisitSuperExpr(const Super&) override { count++; }
+
+  void VisitThisExpr(const This&) override { count++; }
+
+  void VisitUnaryExpr(const Unary& expr) override {
+    count++;
+    Count(expr.GetRight());
+  }
+
+  void VisitVariableExpr(const Variable&) override { count++; }
+
+  void VisitBlockStmt(const Block& stmt) override {
+    count++;
+    Count(stmt.GetStatements());
+  }
+
+  void VisitClassStmt(const Class& stmt) override {
+    count++;
+    Count(stmt.GetSuperclass());
+    for (const Function* method : stmt.GetMethods()) Count(method);
+  }
+
+  void VisitExpressionStmt(const Expression& stmt) override {
+    count++;
+    Count(stmt.GetExpr());
+  }
+
+  void VisitFunctionStmt(const Function& stmt) override {
+    count++;
+    Count(stmt.GetBody());
+  }
+
+  void VisitIfStmt(const If& stmt) override {
+    count++;
+    Count(stmt.GetCondition());
+    Count(stmt.GetThen());
+    Count(stmt.GetElse());
+  }
+
+  void VisitPrintStmt(const Print& stmt) override {
+    count++;
+    Count(stmt.GetExpr());
+  }
+
+  void VisitReturnStmt(const Return& stmt) override {
+    count++;
+    Count(stmt.GetValue());
+  }
+
+  void VisitVarStmt(const Var& stmt) override {
+    count++;
+    Count(stmt.GetInitializer());
+  }
+
+  void VisitWhileStmt(const While& stmt) override {
+    count++;
+    Count(stmt.GetCondition());
+    Count(stmt.GetBody());
+  }
+};
+
+}  // namespace
+
+StmtList Optimizer::Optimize(StmtList statements) {
+  return OptimizeList(statements);
+}
+
+const Expr* Optimizer::Optimize(const Expr* expr) {
+  return expr ? expr->Accept(*this) : nullptr;
+}
+
+const Stmt* Optimizer::Optimize(const Stmt* stmt) {
+  return stmt ? stmt->Accept(*this) : nullptr;
+}
+
+size_t Optimizer::CountNodes(StmtList statements) {
+  NodeCounter counter;
+  counter.Count(statements);
+  return counter.count;
+}
+
+StmtList Optimizer::OptimizeList(StmtList list) {
+  size_t start = _stmts.size();
+  bool changed = false;
+  for (const Stmt* stmt : list) {
+    const Stmt* optimized = Optimize(stmt);
+    changed |= optimized != stmt;
+    _stmts.push_back(optimized);
+  }
+  if (!changed) {
+    _stmts.resize(start);
+    return list;
+  }
+  auto items =
+      _arena.CopyArray(std::span<const Stmt* const>(_stmts).subspan(start));
+  _stmts.resize(start);
+  return items;
+}
+
+const Function* Optimizer::OptimizeFunction(const Function& function) {
+  StmtList body = OptimizeList(function.GetBody());
+  if (body.data() == function.GetBody().data()) return &function;
+  return _arena.Make<Function>(Copy(function.GetName()), function.GetSymbol(),
+                               function.GetParams(), body);
+}
+
+std::optional<LiteralValue> Optimizer::FoldBinary(TokenType op,
+                                                  const LiteralValue& a,
+                                                  const LiteralValue& b) {
+  // Equality is defined between any two values, and variant comparison
+  // matches the runtime's: different types are unequal, NaN != NaN, and
+  // interned strings are equal exactly when their symbols are
+  if (op == TokenType::EQUAL_EQUAL) return LiteralValue(a == b);
+  if (op == TokenType::BANG_EQUAL) return LiteralValue(a != b);
+
+  const double* x = std::get_if<double>(&a);
+  const double* y = std::get_if<double>(&b);
+  if (x && y) {
+    switch (op) {
+      case TokenType::PLUS:
+        return LiteralValue(*x + *y);
+      case TokenType::MINUS:
+        return LiteralValue(*x - *y);
+      case TokenType::STAR:
+        return LiteralValue(*x * *y);
+      case TokenType::SLASH:
+        return LiteralValue(*x / *y);
+      case TokenType::GREATER:
+        return LiteralValue(*x > *y);
+      case TokenType::GREATER_EQUAL:
+        return LiteralValue(*x >= *y);
+      case TokenType::LESS:
+        return LiteralValue(*x < *y);
+      case TokenType::LESS_EQUAL:
+        return LiteralValue(*x <= *y);
+      default:
+        return std::nullopt;
+    }
+  }
+
+  const auto* s = std::get_if<const Symbol*>(&a);
+  const auto* t = std::get_if<const Symbol*>(&b);
+  if (s && t && op == TokenType::PLUS) {
+    std::string joined;
+    joined.reserve((*s)->text.size() + (*t)->text.size());
+    joined.append((*s)->text).append((*t)->text);
+    return LiteralValue(Interner::Global().Intern(joined));
+  }
+
+  return std::nullopt;
+}
+
+// ------------- EXPRESSIONS -------------
+const Expr* Optimizer::VisitAssignExpr(const Assign& expr) {
+  const Expr* value = Optimize(expr.GetValue());
+  if (value == expr.GetValue()) return &expr;
+  return _arena.Make<Assign>(Copy(expr.GetName()), value);
+}
+
+const Expr* Optimizer::VisitBinaryExpr(const Binary& expr) {
+  const Expr* left = Optimize(expr.GetLeft());
+  const Expr* right = Optimize(expr.GetRight());
+
+  const Literal* a = AsLiteral(left);
+  const Literal* b = AsLiteral(right);
+  if (a && b) {
+    if (auto folded = FoldBinary(expr.GetOperator()->type, a->GetValue(),
+                                 b->GetValue())) {
+      return _arena.Make<Literal>(*folded);
+    }
+  }
+
+  if (left == expr.GetLeft() && right == expr.GetRight()) return &expr;
+  return _arena.Make<Binary>(left, Copy(expr.GetOperator()), right);
+}
+
+const Expr* Optimizer::VisitCallExpr(const Call& expr) {
+  const Expr* callee = Optimize(expr.GetCallee());
+  bool changed = callee != expr.GetCallee();
+
+  size_t start = _args.size();
+  for (const Expr* arg : expr.GetArgs()) {
+    const Expr* optimized = Optimize(arg);
+    changed |= optimized != arg;
+    _args.push_back(optimized);
+  }
+  if (!changed) {
+    _args.resize(start);
+    return &expr;
+  }
+
+  auto args =
+      _arena.CopyArray(std::span<const Expr* const>(_args).subspan(start));
+  _args.resize(start);
+  return _arena.Make<Call>(callee, Copy(expr.GetParen()), args);
+}
+
+const Expr* Optimizer::VisitGetExpr(const Get& expr) {
+  const Expr* object = Optimize(expr.GetObject());
+  if (object == expr.GetObject()) return &expr;
+  return _arena.Make<Get>(object, Copy(expr.GetName()), expr.GetSymbol());
+}
+
+const Expr* Optimizer::VisitGroupingExpr(const Grouping& expr) {
+  return Optimize(expr.GetExpr());
+}
+
+const Expr* Optimizer::VisitLiteralExpr(const Literal& expr) { return &expr; }
+
+const Expr* Optimizer::VisitLogicalExpr(const Logical& expr) {
+  const Expr* left = Optimize(expr.GetLeft());
+
+  // A constant left operand decides the short circuit now: either it is
+  // the result, or the right operand is
+  if (const Literal* constant = AsLiteral(left)) {
+    bool truthy = IsTruthy(constant->GetValue());
+    bool is_or = expr.GetOperator()->type == TokenType::OR;
+    return truthy == is_or ? left : Optimize(expr.GetRight());
+  }
+
+  const Expr* right = Optimize(expr.GetRight());
+  if (left == expr.GetLeft() && right == expr.GetRight()) return &expr;
+  return _arena.Make<Logical>(left, Copy(expr.GetOperator()), right);
+}
+
+const Expr* Optimizer::VisitSetExpr(const Set& expr) {
+  const Expr* object = Optimize(expr.GetObject());
+  const Expr* value = Optimize(expr.GetValue());
+  if (object == expr.GetObject() && value == expr.GetValue()) return &expr;
+  return _arena.Make<Set>(object, Copy(expr.GetName()), expr.GetSymbol(),
+                          value);
+}
+
+const Expr* Optimizer::VisitSuperExpr(const Super& expr) { return &expr; }
+
+const Expr* Optimizer::VisitThisExpr(const This& expr) { return &expr; }
+
+const Expr* Optimizer::VisitUnaryExpr(const Unary& expr) {
+  const Expr* right = Optimize(expr.GetRight());
+
+  if (const Literal* constant = AsLiteral(right)) {
+    const LiteralValue& value = constant->GetValue();
+    if (expr.GetOperator()->type == TokenType::BANG) {
+      return _arena.Make<Literal>(!IsTruthy(value));
+    }
+    if (const double* number = std::get_if<double>(&value)) {
+      return _arena.Make<Literal>(-*number);
+    }
+  }
+
+  if (right == expr.GetRight()) return &expr;
+  return _arena.Make<Unary>(Copy(expr.GetOperator()), right);
+}
+
+const Expr* Optimizer::VisitVariableExpr(const Variable& expr) {
+  return &expr;
+}
+
+// ------------- STATEMENTS -------------
+const Stmt* Optimizer::VisitBlockStmt(const Block& stmt) {
+  StmtList statements = OptimizeList(stmt.GetStatements());
+  if (statements.data() == stmt.GetStatements().data()) return &stmt;
+  return _arena.Make<Block>(statements);
+}
+
+const Stmt* Optimizer::VisitClassStmt(const Class& stmt) {
+  size_t start = _methods.size();
+  bool changed = false;
+  for (const Function* method : stmt.GetMethods()) {
+    const Function* optimized = OptimizeFunction(*method);
+    changed |= optimized != method;
+    _methods.push_back(optimized);
+  }
+  if (!changed) {
+    _methods.resize(start);
+    return &stmt;
+  }
+
+  auto methods = _arena.CopyArray(
+      std::span<const Function* const>(_methods).subspan(start));
+  _methods.resize(start);
+  return _arena.Make<Class>(Copy(stmt.GetName()), stmt.GetSuperclass(),
+                            methods);
+}
+
+const Stmt* Optimizer::VisitExpressionStmt(const Expression& stmt) {
+  const Expr* expr = Optimize(stmt.GetExpr());
+  if (expr == stmt.GetExpr()) return &stmt;
+  return _arena.Make<Expression>(expr);
+}
+
+const Stmt* Optimizer::VisitFunctionStmt(const Function& stmt) {
+  return OptimizeFunction(stmt);
+}
+
+const Stmt* Optimizer::VisitIfStmt(const If& stmt) {
+  const Expr* condition = Optimize(stmt.GetCondition());
+  const Stmt* then_branch = Optimize(stmt.GetThen());
+  const Stmt* else_branch = Optimize(stmt.GetElse());
+  if (condition == stmt.GetCondition() && then_branch == stmt.GetThen() &&
+      else_branch == stmt.GetElse()) {
+    return &stmt;
+  }
+  return _arena.Make<If>(condition, then_branch, else_branch);
+}
+
+const Stmt* Optimizer::VisitPrintStmt(const Print& stmt) {
+  const Expr* expr = Optimize(stmt.GetExpr());
+  if (expr == stmt.GetExpr()) return &stmt;
+  return _arena.Make<Print>(expr);
+}
+
+const Stmt* Optimizer::VisitReturnStmt(const Return& stmt) {
+  const Expr* value = Optimize(stmt.GetValue());
+  if (value == stmt.GetValue()) return &stmt;
+  return _arena.Make<Return>(Copy(stmt.GetKeyword()), value);
+}
+
+const Stmt* Optimizer::VisitVarStmt(const Var& stmt) {
+  const Expr* initializer = Optimize(stmt.GetInitializer());
+  if (initializer == stmt.GetInitializer()) return &stmt;
+  return _arena.Make<Var>(Copy(stmt.GetName()), initializer);
+}
+
+const Stmt* Optimizer::VisitWhileStmt(const While& stmt) {
+  const Expr* condition = Optimize(stmt.GetCondition());
+  const Stmt* body = Optimize(stmt.GetBody());
+  if (condition == stmt.GetCondition() && body == stmt.GetBody()) {
+    return &stmt;
+  }
+  return _arena.Make<While>(condition, body);
+}
@@ -1,20 +1,516 @@
 #include "includes/Parser.hpp"
 
-template <typename T, typename U>
-Expr<T, U>* Parser<T, U>::Expression() {
-    return Equality();
+StmtList Parser::Parse() {
+  size_t start = _stmts.size();
+  while (!IsAtEnd()) {
+    if (const Stmt* stmt = Declaration()) {
+      _stmts.push_back(stmt);
+    }
+  }
+  return Commit(_stmts, start);
+}
+
+const Expr* Parser::ParseExpression() {
+  try {
+    return Expression();
+  } catch (const ParseError&) {
+    _nesting = 0;
+    return nullptr;
+  }
+}
+
+// ------------- STATEMENTS -------------
+const Stmt* Parser::Declaration() {
+  // Lists left half-built by the failed statement are dropped with it
+  size_t stmts = _stmts.size();
+  size_t args = _args.size();
+  size_t methods = _methods.size();
+  size_t nesting = _nesting;
+  try {
+    if (Match(TokenType::CLASS)) return ClassDeclaration();
+    if (Match(TokenType::FUN)) return FunctionDeclaration("function");
+    if (Match(TokenType::VAR)) return VarDeclaration();
+
+    return Statement();
+  } catch (const ParseError&) {
+    _stmts.resize(stmts);
+    _args.resize(args);
+    _methods.resize(methods);
+    _nesting = nesting;
+    Synchronize();
+    return nullptr;
+  }
+}
+
+const Stmt* Parser::ClassDeclaration() {
+  auto name = _tokens.Get(Consume(TokenType::IDENTIFIER, "Expect class name."));
+
+  const Variable* superclass = nullptr;
+  if (Match(TokenType::LESS)) {
+    size_t super_name =
+        Consume(TokenType::IDENTIFIER, "Expect superclass name.");
+    superclass = _arena.Make<Variable>(_tokens.Get(super_name));
+  }
+
+  Consume(TokenType::LEFT_BRACE, "Expect '{' before class body.");
+
+  size_t start = _methods.size();
+  while (!Check(TokenType::RIGHT_BRACE) && !IsAtEnd()) {
+    _methods.push_back(FunctionDeclaration("method"));
+  }
+
+  Consume(TokenType::RIGHT_BRACE, "Expect '}' after class body.");
+  return _arena.Make<Class>(std::move(name), superclass,
+                            Commit(_methods, start));
+}
+
+const Function* Parser::FunctionDeclaration(const std::string& kind) {
+  size_t name_index =
+      Consume(TokenType::IDENTIFIER, "Expect " + kind + " name.");
+  auto name = _tokens.Get(name_index);
+  Consume(TokenType::LEFT_PAREN, "Expect '(' after " + kind + " name.");
+
+  _params.clear();
+  if (!Check(TokenType::RIGHT_PAREN)) {
+    do {
+      if (_params.size() >= 255) {
+        ErrorAt(Peek(), "Can't have more than 255 parameters.");
+      }
+      _params.push_back(_tokens.Get(
+          Consume(TokenType::IDENTIFIER, "Expect parameter name.")));
+    } while (Match(TokenType::COMMA));
+  }
+  Consume(TokenType::RIGHT_PAREN, "Expect ')' after parameters.");
+  // The body may declare functions of its own, so the parameters have to
+  // leave the scratch list first
+  ParamList params = _arena.MoveArray(_params);
+
+  Consume(TokenType::LEFT_BRACE, "Expect '{' before " + kind + " body.");
+  StmtList body = BlockStatements();
+  return _arena.Make<Function>(std::move(name), SymbolAt(name_index), params,
+                               body);
+}
+
+const Stmt* Parser::VarDeclaration() {
+  auto name =
+      _tokens.Get(Consume(TokenType::IDENTIFIER, "Expect variable name."));
+
+  const Expr* initializer = nullptr;
+  if (Match(TokenType::EQUAL)) {
+    initializer = Expression();
+  }
+
+  Consume(TokenType::SEMICOLON, "Expect ';' after variable declaration.");
+  return _arena.Make<Var>(std::move(name), initializer);
+}
+
+const Stmt* Parser::Statement() {
+  if (Match(TokenType::FOR)) return ForStatement();
+  if (Match(TokenType::IF)) return IfStatement();
+  if (Match(TokenType::PRINT)) return PrintStatement();
+  if (Match(TokenType::RETURN)) return ReturnStatement();
+  if (Match(TokenType::WHILE)) return WhileStatement();
+  if (Match(TokenType::LEFT_BRACE)) {
+    return _arena.Make<Block>(BlockStatements());
+  }
+
+  return ExpressionStatement();
+}
+
+// `for` has no node of its own: it is desugared into a block holding the
+// initializer and a while loop whose body ends with the increment
+const Stmt* Parser::ForStatement() {
+  Consume(TokenType::LEFT_PAREN, "Expect '(' after 'for'.");
+
+  const Stmt* initializer = nullptr;
+  if (Match(TokenType::SEMICOLON)) {
+    initializer = nullptr;
+  } else if (Match(TokenType::VAR)) {
+    initializer = VarDeclaration();
+  } else {
+    initializer = ExpressionStatement();
+  }
+
+  const Expr* condition = nullptr;
+  if (!Check(TokenType::SEMICOLON)) {
+    condition = Expression();
+  }
+  Consume(TokenType::SEMICOLON, "Expect ';' after loop condition.");
+
+  const Expr* increment = nullptr;
+  if (!Check(TokenType::RIGHT_PAREN)) {
+    increment = Expression();
+  }
+  Consume(TokenType::RIGHT_PAREN, "Expect ')' after for clauses.");
+
+  const Stmt* body = Body();
+
+  if (increment != nullptr) {
+    size_t start = _stmts.size();
+    _stmts.push_back(body);
+    _stmts.push_back(_arena.Make<::Expression>(increment));
+    body = _arena.Make<Block>(Commit(_stmts, start));
+  }
+
+  if (condition == nullptr) {
+    condition = _arena.Make<Literal>(true);
+  }
+  body = _arena.Make<While>(condition, body);
+
+  if (initializer != nullptr) {
+    size_t start = _stmts.size();
+    _stmts.push_back(initializer);
+    _stmts.push_back(body);
+    body = _arena.Make<Block>(Commit(_stmts, start));
+  }
+
+  return body;
+}
+
+const Stmt* Parser::IfStatement() {
+  Consume(TokenType::LEFT_PAREN, "Expect '(' after 'if'.");
+  const Expr* condition = Expression();
+  Consume(TokenType::RIGHT_PAREN, "Expect ')' after if condition.");
+
+  const Stmt* then_branch = Body();
+  const Stmt* else_branch = nullptr;
+  if (Match(TokenType::ELSE)) {
+    else_branch = Body();
+  }
+
+  return _arena.Make<If>(condition, then_branch, else_branch);
+}
+
+const Stmt* Parser::PrintStatement() {
+  const Expr* value = Expression();
+  Consume(TokenType::SEMICOLON, "Expect ';' after value.");
+  return _arena.Make<Print>(value);
+}
+
+const Stmt* Parser::ReturnStatement() {
+  auto keyword = _tokens.Get(Previous());
+  const Expr* value = nullptr;
+  if (!Check(TokenType::SEMICOLON)) {
+    value = Expression();
+  }
+
+  Consume(TokenType::SEMICOLON, "Expect ';' after return value.");
+  return _arena.Make<Return>(std::move(keyword), value);
+}
+
+const Stmt* Parser::WhileStatement() {
+  Consume(TokenType::LEFT_PAREN, "Expect '(' after 'while'.");
+  const Expr* condition = Expression();
+  Consume(TokenType::RIGHT_PAREN, "Expect ')' after condition.");
+  const Stmt* body = Body();
+
+  return _arena.Make<While>(condition, body);
+}
+
+const Stmt* Parser::ExpressionStatement() {
+  const Expr* expr = Expression();
+  Consume(TokenType::SEMICOLON, "Expect ';' after expression.");
+  return _arena.Make<::Expression>(expr);
+}
+
+// The body of a loop or either branch of an `if`
+const Stmt* Parser::Body() {
+  if (_nesting == MAX_STATEMENT_NESTING) {
+    ErrorAt(Peek(), "Statement nesting too deep.");
+    SkipNested(0);
+    return _arena.Make<Block>(StmtList());
+  }
+  _nesting++;
+  const Stmt* body = Statement();
+  _nesting--;
+  return body;
+}
+
+// Expects the opening brace to be consumed already
+StmtList Parser::BlockStatements() {
+  if (_nesting == MAX_STATEMENT_NESTING) {
+    ErrorAt(Previous(), "Statement nesting too deep.");
+    SkipNested(1);
+    return {};
+  }
+  _nesting++;
+  size_t start = _stmts.size();
+  while (!Check(TokenType::RIGHT_BRACE) && !IsAtEnd()) {
+    if (const Stmt* stmt = Declaration()) {
+      _stmts.push_back(stmt);
+    }
+  }
+
+  Consume(TokenType::RIGHT_BRACE, "Expect '}' after block.");
+  _nesting--;
+  return Commit(_stmts, start);
+}
+
+// ------------- EXPRESSIONS -------------
+const Expr* Parser::Expression() {
+  Nest();
+  const Expr* expr = Assignment();
+  _nesting--;
+  return expr;
+}
+
+void Parser::Nest() {
+  if (++_nesting > MAX_NESTING) {
+    throw ErrorAt(Peek(), "Expression nesting too deep.");
+  }
+}
+
+const Expr* Parser::Assignment() {
+  const Expr* expr = Or();
+
+  if (Match(TokenType::EQUAL)) {
+    size_t equals = Previous();
+    const Expr* value = Expression();
+
+    if (expr->GetKind() == Expr::Kind::VARIABLE) {
+      const Token<>* name = static_cast<const Variable*>(expr)->GetName();
+      return _arena.Make<Assign>(
+          Token<>(name->type, name->lexeme, nullptr, name->line), value);
+    }
+    if (expr->GetKind() == Expr::Kind::GET) {
+      const auto* get = static_cast<const Get*>(expr);
+      const Token<>* name = get->GetName();
+      return _arena.Make<Set>(
+          get->GetObject(),
+          Token<>(name->type, name->lexeme, nullptr, name->line),
+          get->GetSymbol(), value);
+    }
+
+    // Reported without unwinding: the parser is not confused, just the
+    // program
+    ErrorAt(equals, "Invalid assignment target.");
+  }
+
+  return expr;
+}
+
+const Expr* Parser::Or() {
+  const Expr* expr = And();
+
+  while (Match(TokenType::OR)) {
+    auto oper = _tokens.Get(Previous());
+    const Expr* right = And();
+    expr = _arena.Make<Logical>(expr, std::move(oper), right);
+  }
+
+  return expr;
+}
+
+const Expr* Parser::And() {
+  const Expr* expr = Equality();
+
+  while (Match(TokenType::AND)) {
+    auto oper = _tokens.Get(Previous());
+    const Expr* right = Equality();
+    expr = _arena.Make<Logical>(expr, std::move(oper), right);
+  }
+
+  return expr;
+}
+
+const Expr* Parser::Equality() {
+  const Expr* expr = Comparison();
+
+  while (Match(TokenType::BANG_EQUAL, TokenType::EQUAL_EQUAL)) {
+    auto oper = _tokens.Get(Previous());
+    const Expr* right = Comparison();
+    expr = _arena.Make<Binary>(expr, std::move(oper), right);
+  }
+
+  return expr;
+}
+
+const Expr* Parser::Comparison() {
+  const Expr* expr = Term();
+
+  while (Match(TokenType::GREATER, TokenType::GREATER_EQUAL, TokenType::LESS,
+               TokenType::LESS_EQUAL)) {
+    auto oper = _tokens.Get(Previous());
+    const Expr* right = Term();
+    expr = _arena.Make<Binary>(expr, std::move(oper), right);
+  }
+
+  return expr;
+}
+
+const Expr* Parser::Term() {
+  const Expr* expr = Factor();
+
+  while (Match(TokenType::MINUS, TokenType::PLUS)) {
+    auto oper = _tokens.Get(Previous());
+    const Expr* right = Factor();
+    expr = _arena.Make<Binary>(expr, std::move(oper), right);
+  }
+
+  return expr;
+}
+
+const Expr* Parser::Factor() {
+  const Expr* expr = Unary();
+
+  while (Match(TokenType::SLASH, TokenType::STAR)) {
+    auto oper = _tokens.Get(Previous());
+    const Expr* right = Unary();
+    expr = _arena.Make<Binary>(expr, std::move(oper), right);
+  }
+
+  return expr;
+}
+
+const Expr* Parser::Unary() {
+  if (Match(TokenType::BANG, TokenType::MINUS)) {
+    auto oper = _tokens.Get(Previous());
+    Nest();
+    const Expr* right = Unary();
+    _nesting--;
+    return _arena.Make<::Unary>(std::move(oper), right);
+  }
+
+  return Call();
 }
 
-template <typename T, typename U>
-Expr<T, U>* Parser<T, U>::Equality()
-{
-    Expr<T, U>* expr = Comparison();
+const Expr* Parser::Call() {
+  const Expr* expr = Primary();
 
-    while (Match(TokenType::BANG_EQUAL, TokenType::EQUAL_EQUAL)) {
-        Token<T>* oper = Previous();
-        Expr<T, U>* right = Comparison();
-        expr = std::make_unique<Binary<T, U>>(expr, oper, right);
+  while (true) {
+    if (Match(TokenType::LEFT_PAREN)) {
+      expr = FinishCall(expr);
+    } else if (Match(TokenType::DOT)) {
+      size_t name =
+          Consume(TokenType::IDENTIFIER, "Expect property name after '.'.");
+      expr = _arena.Make<Get>(expr, _tokens.Get(name), SymbolAt(name));
+    } else {
+      break;
     }
+  }
 
-    return expr;
-}
\ No newline at end of file
+  return expr;
+}
+
+const Expr* Parser::FinishCall(const Expr* callee) {
+  size_t start = _args.size();
+  if (!Check(TokenType::RIGHT_PAREN)) {
+    do {
+      if (_args.size() - start >= 255) {
+        ErrorAt(Peek(), "Can't have more than 255 arguments.");
+      }
+      _args.push_back(Expression());
+    } while (Match(TokenType::COMMA));
+  }
+
+  size_t paren = Consume(TokenType::RIGHT_PAREN, "Expect ')' after arguments.");
+  return _arena.Make<::Call>(callee, _tokens.Get(paren), Commit(_args, start));
+}
+
+const Expr* Parser::Primary() {
+  if (Match(TokenType::FALSE)) return _arena.Make<Literal>(false);
+  if (Match(TokenType::TRUE)) return _arena.Make<Literal>(true);
+  if (Match(TokenType::NIL)) return _arena.Make<Literal>(nullptr);
+
+  if (Match(TokenType::NUMBER)) {
+    return _arena.Make<Literal>(_tokens.Number(Previous()));
+  }
+  if (Match(TokenType::STRING)) {
+    return _arena.Make<Literal>(SymbolAt(Previous()));
+  }
+
+  if (Match(TokenType::SUPER)) {
+    auto keyword = _tokens.Get(Previous());
+    Consume(TokenType::DOT, "Expect '.' after 'super'.");
+    size_t method =
+        Consume(TokenType::IDENTIFIER, "Expect superclass method name.");
+    return _arena.Make<Super>(std::move(keyword), _tokens.Get(method),
+                              SymbolAt(method));
+  }
+
+  if (Match(TokenType::THIS)) return _arena.Make<This>(_tokens.Get(Previous()));
+
+  if (Match(TokenType::IDENTIFIER)) {
+    return _arena.Make<Variable>(_tokens.Get(Previous()));
+  }
+
+  if (Match(TokenType::LEFT_PAREN)) {
+    const Expr* expr = Expression();
+    Consume(TokenType::RIGHT_PAREN, "Expect ')' after expression.");
+    return _arena.Make<Grouping>(expr);
+  }
+
+  throw ErrorAt(Peek(), "Expect expression.");
+}
+
+const Symbol* Parser::SymbolAt(size_t index) const {
+  return Interner::Global().Intern(_tokens.Type(index) == TokenType::STRING
+                                       ? _tokens.String(index)
+                                       : _tokens.Lexeme(index));
+}
+
+size_t Parser::Consume(TokenType type, const std::string& message) {
+  if (Check(type)) return Advance();
+
+  throw ErrorAt(Peek(), message);
+}
+
+Parser::ParseError Parser::ErrorAt(size_t index, const std::string& message) {
+  if (_tokens.Type(index) == TokenType::TEOF) {
+    _error.Report(_tokens.Line(index), " at end", message);
+  } else {
+    _error.Report(_tokens.Line(index),
+                  " at '" + std::string(_tokens.Lexeme(index)) + "'", message);
+  }
+  return ParseError(message);
+}
+
+// Discards the rest of a statement nested too deeply to parse, `depth`
+// brackets in. Rather than unwinding, it stops after the `;` or `}` that
+// closes the statement, so the statements around it still parse and the
+// error is reported once.
+void Parser::SkipNested(size_t depth) {
+  while (!IsAtEnd()) {
+    TokenType type = _tokens.Type(Peek());
+    if (type == TokenType::RIGHT_BRACE || type == TokenType::RIGHT_PAREN) {
+      // Closes a statement around this one
+      if (depth == 0) return;
+      depth--;
+    } else if (type == TokenType::LEFT_BRACE ||
+               type == TokenType::LEFT_PAREN) {
+      depth++;
+    }
+    Advance();
+
+    if (depth == 0 &&
+        (type == TokenType::SEMICOLON || type == TokenType::RIGHT_BRACE) &&
+        !Check(TokenType::ELSE)) {
+      return;
+    }
+  }
+}
+
+// Discards tokens up to the next likely statement boundary
+void Parser::Synchronize() {
+  Advance();
+
+  while (!IsAtEnd()) {
+    if (_tokens.Type(Previous()) == TokenType::SEMICOLON) return;
+
+    switch (_tokens.Type(Peek())) {
+      case TokenType::CLASS:
+      case TokenType::FUN:
+      case TokenType::VAR:
+      case TokenType::FOR:
+      case TokenType::IF:
+      case TokenType::WHILE:
+      case TokenType::PRINT:
+      case TokenType::RETURN:
+        return;
+      default:
+        break;
+    }
+
+    Advance();
+  }
+}
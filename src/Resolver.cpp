@@ -0,0 +1,264 @@
+#include "includes/Resolver.hpp"
+
+bool Resolver::Resolve(StmtList statements) {
+  _had_error = false;
+  _pending.clear();
+
+  ResolveStatements(statements);
+
+  // Declarations later in the program count, so forward references from
+  // function bodies resolve; whatever is still undeclared never will be
+  std::vector<bool> reported(GlobalCount(), false);
+  for (auto [index, name] : _pending) {
+    if (!_global_declared[index] && !reported[index]) {
+      reported[index] = true;
+      ErrorAt(*name,
+              "Undefined variable '" + std::string(name->lexeme) + "'.");
+    }
+  }
+  _pending.clear();
+
+  return !_had_error;
+}
+
+uint32_t Resolver::DeclareGlobal(std::string_view name) {
+  auto [slot, inserted] =
+      _global_slots.try_emplace(name, static_cast<uint32_t>(GlobalCount()));
+  if (inserted) {
+    _global_declared.push_back(true);
+  } else {
+    _global_declared[slot->second] = true;
+  }
+  return slot->second;
+}
+
+void Resolver::ResolveStatements(StmtList statements) {
+  for (const Stmt* stmt : statements) {
+    Resolve(stmt);
+  }
+}
+
+void Resolver::ResolveFunction(const Function& function, FunctionKind kind) {
+  FunctionKind enclosing = _function;
+  _function = kind;
+
+  // The call's environment holds the receiver first, then the parameters,
+  // and the body runs directly in it
+  BeginScope();
+  if (kind == FunctionKind::METHOD || kind == FunctionKind::INITIALIZER) {
+    _locals.push_back({"this", true});
+  }
+  for (const Token<>& param : function.GetParams()) {
+    Declare(param);
+    MarkInitialized();
+  }
+  ResolveStatements(function.GetBody());
+  EndScope();
+
+  _function = enclosing;
+}
+
+Slot Resolver::ResolveName(const Token<>& name) {
+  for (size_t scope = _scopes.size(); scope-- > 0;) {
+    size_t start = _scopes[scope];
+    size_t end = scope + 1 < _scopes.size() ? _scopes[scope + 1]
+                                            : _locals.size();
+    for (size_t i = end; i-- > start;) {
+      if (_locals[i].name != name.lexeme) continue;
+      if (!_locals[i].defined) {
+        ErrorAt(name, "Can't read local variable in its own initializer.");
+      }
+      return {static_cast<uint32_t>(_scopes.size() - 1 - scope),
+              static_cast<uint32_t>(i - start)};
+    }
+  }
+
+  auto [slot, inserted] = _global_slots.try_emplace(
+      name.lexeme, static_cast<uint32_t>(GlobalCount()));
+  if (inserted) {
+    _global_declared.push_back(false);
+  }
+  if (!_global_declared[slot->second]) {
+    _pending.emplace_back(slot->second, &name);
+  }
+  return {Slot::GLOBAL, slot->second};
+}
+
+void Resolver::EndScope() {
+  _locals.resize(_scopes.back());
+  _scopes.pop_back();
+}
+
+void Resolver::Declare(const Token<>& name) {
+  if (_scopes.empty()) {
+    DeclareGlobal(name.lexeme);
+    return;
+  }
+
+  for (size_t i = _scopes.back(); i < _locals.size(); i++) {
+    if (_locals[i].name == name.lexeme) {
+      ErrorAt(name, "Already a variable with this name in this scope.");
+    }
+  }
+  _locals.push_back({name.lexeme, false});
+}
+
+void Resolver::MarkInitialized() {
+  if (_scopes.empty()) return;
+  _locals.back().defined = true;
+}
+
+void Resolver::ErrorAt(const Token<>& token, const std::string& message) {
+  _error.Report(token.line, " at '" + std::string(token.lexeme) + "'",
+                message);
+  _had_error = true;
+}
+
+// ------------- EXPRESSIONS -------------
+void Resolver::VisitAssignExpr(const Assign& expr) {
+  Resolve(expr.GetValue());
+  expr.Resolve(ResolveName(*expr.GetName()));
+}
+
+void Resolver::VisitBinaryExpr(const Binary& expr) {
+  Resolve(expr.GetLeft());
+  Resolve(expr.GetRight());
+}
+
+void Resolver::VisitCallExpr(const Call& expr) {
+  Resolve(expr.GetCallee());
+  for (const Expr* arg : expr.GetArgs()) {
+    Resolve(arg);
+  }
+}
+
+void Resolver::VisitGetExpr(const Get& expr) { Resolve(expr.GetObject()); }
+
+void Resolver::VisitGroupingExpr(const Grouping& expr) {
+  Resolve(expr.GetExpr());
+}
+
+void Resolver::VisitLiteralExpr(const Literal&) {}
+
+void Resolver::VisitLogicalExpr(const Logical& expr) {
+  Resolve(expr.GetLeft());
+  Resolve(expr.GetRight());
+}
+
+void Resolver::VisitSetExpr(const Set& expr) {
+  Resolve(expr.GetValue());
+  Resolve(expr.GetObject());
+}
+
+void Resolver::VisitSuperExpr(const Super& expr) {
+  const Token<>* keyword = expr.GetKeyword();
+  if (_class == ClassKind::NONE) {
+    ErrorAt(*keyword, "Can't use 'super' outside of a class.");
+    return;
+  }
+  if (_class != ClassKind::SUBCLASS) {
+    ErrorAt(*keyword, "Can't use 'super' in a class with no superclass.");
+    return;
+  }
+  expr.Resolve(ResolveName(*keyword));
+}
+
+void Resolver::VisitThisExpr(const This& expr) {
+  if (_class == ClassKind::NONE) {
+    ErrorAt(*expr.GetKeyword(), "Can't use 'this' outside of a class.");
+    return;
+  }
+  expr.Resolve(ResolveName(*expr.GetKeyword()));
+}
+
+void Resolver::VisitUnaryExpr(const Unary& expr) { Resolve(expr.GetRight()); }
+
+void Resolver::VisitVariableExpr(const Variable& expr) {
+  expr.Resolve(ResolveName(*expr.GetName()));
+}
+
+// ------------- STATEMENTS -------------
+void Resolver::VisitBlockStmt(const Block& stmt) {
+  BeginScope();
+  ResolveStatements(stmt.GetStatements());
+  EndScope();
+}
+
+void Resolver::VisitClassStmt(const Class& stmt) {
+  ClassKind enclosing = _class;
+  _class = ClassKind::CLASS;
+
+  const Token<>* name = stmt.GetName();
+  Declare(*name);
+  MarkInitialized();
+
+  const Variable* superclass = stmt.GetSuperclass();
+  if (superclass != nullptr) {
+    if (superclass->GetName()->lexeme == name->lexeme) {
+      ErrorAt(*superclass->GetName(), "A class can't inherit from itself.");
+    }
+    _class = ClassKind::SUBCLASS;
+    Resolve(superclass);
+
+    BeginScope();
+    _locals.push_back({"super", true});
+  }
+
+  for (const Function* method : stmt.GetMethods()) {
+    ResolveFunction(*method, method->GetName()->lexeme == "init"
+                                 ? FunctionKind::INITIALIZER
+                                 : FunctionKind::METHOD);
+  }
+
+  if (superclass != nullptr) {
+    EndScope();
+  }
+  _class = enclosing;
+}
+
+void Resolver::VisitExpressionStmt(const Expression& stmt) {
+  Resolve(stmt.GetExpr());
+}
+
+void Resolver::VisitFunctionStmt(const Function& stmt) {
+  // Defined before the body is resolved, so the function can recurse
+  Declare(*stmt.GetName());
+  MarkInitialized();
+  ResolveFunction(stmt, FunctionKind::FUNCTION);
+}
+
+void Resolver::VisitIfStmt(const If& stmt) {
+  Resolve(stmt.GetCondition());
+  Resolve(stmt.GetThen());
+  if (stmt.GetElse() != nullptr) {
+    Resolve(stmt.GetElse());
+  }
+}
+
+void Resolver::VisitPrintStmt(const Print& stmt) { Resolve(stmt.GetExpr()); }
+
+void Resolver::VisitReturnStmt(const Return& stmt) {
+  const Token<>* keyword = stmt.GetKeyword();
+  if (_function == FunctionKind::NONE) {
+    ErrorAt(*keyword, "Can't return from top-level code.");
+  }
+  if (stmt.GetValue() != nullptr) {
+    if (_function == FunctionKind::INITIALIZER) {
+      ErrorAt(*keyword, "Can't return a value from an initializer.");
+    }
+    Resolve(stmt.GetValue());
+  }
+}
+
+void Resolver::VisitVarStmt(const Var& stmt) {
+  Declare(*stmt.GetName());
+  if (stmt.GetInitializer() != nullptr) {
+    Resolve(stmt.GetInitializer());
+  }
+  MarkInitialized();
+}
+
+void Resolver::VisitWhileStmt(const While& stmt) {
+  Resolve(stmt.GetCondition());
+  Resolve(stmt.GetBody());
+}
@@ -1,40 +1,367 @@
 #include "includes/Run.hpp"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <deque>
 #include <fstream>
+#include <optional>
+#include <sstream>
+#include <type_traits>
 
+#include "includes/Arena.hpp"
+#include "includes/AstFile.hpp"
+#include "includes/BytecodeCache.hpp"
 #include "includes/Error.hpp"
+#include "includes/Heap.hpp"
+#include "includes/Interner.hpp"
+#include "includes/Interpreter.hpp"
+#include "includes/Optimizer.hpp"
+#include "includes/Parser.hpp"
 #include "includes/Scanner.hpp"
+#include "includes/Source.hpp"
+#include "includes/StreamScanner.hpp"
+#include "includes/ThreadPool.hpp"
 #include "includes/Token.hpp"
+#include "includes/Trace.hpp"
+#include "includes/VM.hpp"
+
+namespace {
+
+// The folded statements of `source`, or none after a syntax error
+StmtList Parse(std::string_view source, const Run::Options &options,
+               Error &error, Arena &arena) {
+  auto scanner = std::make_unique<Scanner>(source, &error);
+  const TokenBuffer *tokens;
+  {
+    TraceSpan span("scan");
+    tokens = &scanner->ScanTokens();
+  }
+  if (Tracer *tracer = Tracer::Active()) {
+    tracer->Count("tokens", static_cast<double>(tokens->Size()));
+  }
+
+  StmtList statements;
+  {
+    TraceSpan span("parse");
+    Parser parser(*tokens, arena, error);
+    statements = parser.Parse();
+  }
+  if (error.had_error) {
+    return {};
+  }
+
+  TraceSpan span("fold");
+  Optimizer optimizer(arena);
+  StmtList optimized = optimizer.Optimize(statements);
+  if (options.fold_stats) {
+    fmt::print(stderr, "constant folding: {} -> {} nodes\n",
+               Optimizer::CountNodes(statements),
+               Optimizer::CountNodes(optimized));
+  }
+  return optimized;
+}
+
+}  // namespace
 
-void Run::Execute(const std::string &source) {
-  auto scanner = std::make_unique<Scanner>(source);
-  scanner->ScanTokens();
+template <typename E>
+void Run::Execute(std::string_view source, const Options &options,
+                  Error &error, Arena &arena, E &engine) {
+  StmtList statements = Parse(source, options, error, arena);
+  if (!error.had_error) {
+    engine.Interpret(statements);
+  }
 }
 
-void Run::ExecutePrompt() {
-  std::string line;
+void Run::ExecuteCached(std::string_view source, const Options &options,
+                        Error &error, Arena &arena, VM &vm) {
+  BytecodeCache cache(options.bytecode_cache);
+  if (ObjProto *script = vm.Load(cache, source)) {
+    vm.Interpret(script);
+    return;
+  }
 
-  std::cout << "> ";
-  while (std::getline(std::cin, line)) {
-    if (line == "") {
-      break;
+  StmtList statements = Parse(source, options, error, arena);
+  if (error.had_error) {
+    return;
+  }
+  if (ObjProto *script = vm.Compile(statements)) {
+    // Best effort: a cache that cannot be written only costs a warm start
+    {
+      TraceSpan span("store bytecode");
+      cache.Store(source, *script);
     }
-    Execute(line);
-    Error::had_error = false;
+    vm.Interpret(script);
+  }
+}
+
+void Run::ExecutePrompt(const Options &options) {
+  std::optional<Tracer> tracer;
+  if (!options.trace.empty()) {
+    tracer.emplace(options.trace);
+  }
+  // Earlier lines stay alive: later ones can call functions declared there
+  std::deque<std::string> lines;
+  Error error;
+  Arena arena;
+
+  auto repl = [&](auto &runner) {
+    ConfigureHeap(runner.GetHeap(), options);
     std::cout << "> ";
+    for (std::string line; std::getline(std::cin, line);) {
+      if (line == "") {
+        break;
+      }
+      lines.push_back(std::move(line));
+      error.had_error = false;
+      error.had_runtime_error = false;
+      Execute(lines.back(), options, error, arena, runner);
+      std::cout << std::flush << "> ";
+    }
+    if (options.gc_stats) {
+      PrintGcStats(runner.GetHeap());
+    }
+    if (options.ic_stats) {
+      PrintCacheStats(runner.GetCacheStats());
+    }
+  };
+
+  if (options.engine == Engine::VM) {
+    VM vm(error);
+    repl(vm);
+  } else {
+    Interpreter interpreter(error);
+    repl(interpreter);
+  }
+  if (tracer) {
+    tracer->Write();
   }
 }
 
-void Run::ExecuteFile(const std::string &path) {
-  std::ifstream file(path, std::ios::binary);
-  if (!file) {
-    throw std::runtime_error("Error opening file");
+void Run::ExecuteFile(const std::string &path, const Options &options) {
+  std::optional<Tracer> tracer;
+  if (!options.trace.empty()) {
+    tracer.emplace(options.trace);
+  }
+  // The scanner reads straight out of the mapping, so it has to outlive
+  // everything produced from it
+  Source source = [&] {
+    TraceSpan span("load");
+    return Source(path);
+  }();
+  Error error;
+  Arena arena;
+  auto run = [&](auto &runner) {
+    ConfigureHeap(runner.GetHeap(), options);
+    if constexpr (std::is_same_v<decltype(runner), VM &>) {
+      if (!options.bytecode_cache.empty()) {
+        ExecuteCached(source.View(), options, error, arena, runner);
+      } else {
+        Execute(source.View(), options, error, arena, runner);
+      }
+    } else {
+      Execute(source.View(), options, error, arena, runner);
+    }
+    if (options.gc_stats) {
+      PrintGcStats(runner.GetHeap());
+    }
+    if (options.ic_stats) {
+      PrintCacheStats(runner.GetCacheStats());
+    }
+  };
+
+  if (options.engine == Engine::VM) {
+    VM vm(error);
+    run(vm);
+  } else {
+    Interpreter interpreter(error);
+    run(interpreter);
+  }
+  if (tracer) {
+    tracer->Write();
+  }
+  if (error.had_error) {
+    throw std::runtime_error("Error while parsing file");
+  }
+  if (error.had_runtime_error) {
+    throw std::runtime_error("Error while running file");
   }
+}
+
+Run::Engine Run::ParseEngine(std::string_view name) {
+  if (name == "tree") return Engine::TREE;
+  if (name == "vm") return Engine::VM;
+  throw std::invalid_argument("Unknown engine '" + std::string(name) +
+                              "': expected 'tree' or 'vm'");
+}
+
+std::chrono::nanoseconds Run::ParsePause(std::string_view milliseconds) {
+  double value = 0;
+  auto [end, status] = std::from_chars(
+      milliseconds.data(), milliseconds.data() + milliseconds.size(), value);
+  if (status != std::errc() ||
+      end != milliseconds.data() + milliseconds.size() || value < 0) {
+    throw std::invalid_argument("Invalid pause '" + std::string(milliseconds) +
+                                "': expected milliseconds");
+  }
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double, std::milli>(value));
+}
+
+void Run::ConfigureHeap(Heap &heap, const Options &options) {
+  heap.SetStressMode(options.gc_stress);
+  heap.SetMaxPause(options.gc_max_pause);
+  heap.SetRecordPauses(options.gc_stats);
+}
+
+void Run::PrintGcStats(const Heap &heap) {
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  const Heap::Stats &stats = heap.GetStats();
+  fmt::print(stderr,
+             "gc: {} collections, {} objects ({:.1f} KiB) freed, pauses "
+             "{:.3f} ms total, {:.3f} ms max; {} objects ({:.1f} KiB) live\n",
+             stats.collections, stats.objects_freed,
+             static_cast<double>(stats.bytes_freed) / 1024,
+             Milliseconds(stats.total_pause).count(),
+             Milliseconds(stats.max_pause).count(), heap.ObjectCount(),
+             static_cast<double>(heap.BytesAllocated()) / 1024);
+  fmt::print(stderr, "gc: {} pauses, p50 {:.3f} ms, p99 {:.3f} ms\n",
+             stats.pause_count,
+             Milliseconds(stats.Percentile(0.50)).count(),
+             Milliseconds(stats.Percentile(0.99)).count());
+  fmt::print(stderr, "gc: {} objects allocated, {} allocations elided\n",
+             stats.objects_allocated, stats.allocations_elided);
+}
+
+void Run::PrintCacheStats(const InlineCache::Stats &stats) {
+  uint64_t lookups = stats.hits + stats.misses;
+  fmt::print(stderr, "ic: {} lookups, {} hits, {} misses ({:.1f}% hit)\n",
+             lookups, stats.hits, stats.misses,
+             lookups == 0 ? 0.0
+                          : 100.0 * static_cast<double>(stats.hits) /
+                                static_cast<double>(lookups));
+}
 
-  std::string content((std::istreambuf_iterator<char>(file)),
-                      std::istreambuf_iterator<char>());
-  Execute(content);
-  if (Error::had_error) {
+void Run::EmitAst(const std::string &path, const std::string &output) {
+  Source source(path);
+  Error error;
+  Scanner scanner(source.View(), &error);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+  StmtList statements = parser.Parse();
+  if (error.had_error) {
     throw std::runtime_error("Error while parsing file");
   }
-}
\ No newline at end of file
+
+  std::string bytes = AstFile::Write(statements);
+  std::ofstream file(output, std::ios::binary | std::ios::trunc);
+  if (!file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()))) {
+    throw std::runtime_error("Error writing file");
+  }
+}
+
+void Run::DumpTokens(const std::string &path) {
+  int fd = path == "-" ? STDIN_FILENO : open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Error opening file");
+  }
+  // Closes the file however scanning ends, throwing included
+  struct File {
+    int fd;
+    ~File() {
+      if (fd != STDIN_FILENO) {
+        close(fd);
+      }
+    }
+  } file{fd};
+
+  Error error;
+  StreamScanner scanner(file.fd, 64 * 1024, &error);
+  scanner.ScanTokens([](const TokenBuffer &tokens) {
+    for (size_t i = 0; i < tokens.Size(); i++) {
+      fmt::print("[line {}] {}\n", tokens.Line(i), tokens.Get(i).ToString());
+    }
+  });
+
+  if (error.had_error) {
+    throw std::runtime_error("Error while scanning file");
+  }
+}
+
+void Run::ExecuteBatch(const std::vector<std::string> &paths) {
+  struct Result {
+    std::ostringstream diagnostics;
+    size_t bytes = 0;
+    size_t tokens = 0;
+    bool failed = false;
+  };
+  std::vector<Result> results(paths.size());
+
+  Interner::Stats interned = Interner::Global().GetStats();
+  auto started = std::chrono::steady_clock::now();
+  ThreadPool pool;
+  for (size_t i = 0; i < paths.size(); i++) {
+    pool.Submit([&path = paths[i], &result = results[i]] {
+      Error error(result.diagnostics);
+      try {
+        Source source(path);
+        Scanner scanner(source.View(), &error);
+        const TokenBuffer &tokens = scanner.ScanTokens();
+        result.bytes = source.View().size();
+        result.tokens = tokens.Size();
+
+        Arena arena;
+        Parser parser(tokens, arena, error);
+        parser.Parse();
+      } catch (const std::exception &e) {
+        result.diagnostics << e.what() << std::endl;
+        error.had_error = true;
+      }
+      result.failed = error.had_error;
+    });
+  }
+  pool.Wait();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - started;
+
+  size_t bytes = 0;
+  size_t tokens = 0;
+  size_t failed = 0;
+  for (size_t i = 0; i < paths.size(); i++) {
+    const Result &result = results[i];
+    if (result.failed) {
+      failed++;
+      std::cerr << paths[i] << ":\n" << result.diagnostics.str();
+    }
+    bytes += result.bytes;
+    tokens += result.tokens;
+  }
+
+  double seconds = std::max(elapsed.count(), 1e-9);
+  fmt::print(
+      "{} files, {} failed, {:.1f} MiB, {} tokens in {:.3f} s on {} threads "
+      "({:.1f} MiB/s, {:.2f}M tokens/s)\n",
+      paths.size(), failed, static_cast<double>(bytes) / (1 << 20), tokens,
+      seconds, pool.Size(), static_cast<double>(bytes) / (1 << 20) / seconds,
+      static_cast<double>(tokens) / 1e6 / seconds);
+
+  // Without the interner every property name and string literal in the
+  // trees would have needed its own copy once the source was gone
+  Interner::Stats after = Interner::Global().GetStats();
+  size_t requested = after.requested_bytes - interned.requested_bytes;
+  size_t held = after.text_bytes - interned.text_bytes;
+  fmt::print(
+      "interned {} names and strings as {} symbols: {:.1f} KiB of text "
+      "instead of {:.1f} KiB, {:.1f} KiB saved ({:.1f} KiB with tables)\n",
+      after.requests - interned.requests, after.symbols - interned.symbols,
+      static_cast<double>(held) / 1024, static_cast<double>(requested) / 1024,
+      (static_cast<double>(requested) - static_cast<double>(held)) / 1024,
+      static_cast<double>(after.memory - interned.memory) / 1024);
+  if (failed > 0) {
+    throw std::runtime_error("Errors found in " + std::to_string(failed) +
+                             " files");
+  }
+}
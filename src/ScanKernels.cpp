@@ -0,0 +1,227 @@
+#include "includes/ScanKernels.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+[[gnu::always_inline]] inline bool IsWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// ------------- SCALAR -------------
+const char *SkipWhitespaceScalar(const char *begin, const char *end,
+                                 uint32_t &lines) {
+  while (begin < end && IsWhitespace(*begin)) {
+    lines += *begin == '\n';
+    begin++;
+  }
+  return begin;
+}
+
+const char *FindNewlineScalar(const char *begin, const char *end) {
+  while (begin < end && *begin != '\n') {
+    begin++;
+  }
+  return begin;
+}
+
+const char *FindQuoteScalar(const char *begin, const char *end,
+                            uint32_t &lines) {
+  while (begin < end && *begin != '"') {
+    lines += *begin == '\n';
+    begin++;
+  }
+  return begin;
+}
+
+#if defined(__x86_64__)
+// ------------- SSE2 -------------
+// SSE2 is part of x86-64, so these need no target attribute
+const char *SkipWhitespaceSse2(const char *begin, const char *end,
+                               uint32_t &lines) {
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i carriage = _mm_set1_epi8('\r');
+  const __m128i newline = _mm_set1_epi8('\n');
+
+  while (end - begin >= 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+    __m128i is_newline = _mm_cmpeq_epi8(chunk, newline);
+    __m128i is_space = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, carriage), is_newline));
+    uint32_t space_mask = static_cast<uint32_t>(_mm_movemask_epi8(is_space));
+    uint32_t newline_mask =
+        static_cast<uint32_t>(_mm_movemask_epi8(is_newline));
+
+    if (space_mask != 0xFFFF) {
+      uint32_t stop = static_cast<uint32_t>(__builtin_ctz(~space_mask));
+      lines += static_cast<uint32_t>(
+          __builtin_popcount(newline_mask & ((1u << stop) - 1)));
+      return begin + stop;
+    }
+    lines += static_cast<uint32_t>(__builtin_popcount(newline_mask));
+    begin += 16;
+  }
+  return SkipWhitespaceScalar(begin, end, lines);
+}
+
+const char *FindNewlineSse2(const char *begin, const char *end) {
+  const __m128i newline = _mm_set1_epi8('\n');
+
+  while (end - begin >= 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+    if (mask != 0) {
+      return begin + __builtin_ctz(static_cast<uint32_t>(mask));
+    }
+    begin += 16;
+  }
+  return FindNewlineScalar(begin, end);
+}
+
+const char *FindQuoteSse2(const char *begin, const char *end,
+                          uint32_t &lines) {
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i newline = _mm_set1_epi8('\n');
+
+  while (end - begin >= 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+    uint32_t quote_mask = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)));
+    uint32_t newline_mask = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+
+    if (quote_mask != 0) {
+      uint32_t stop = static_cast<uint32_t>(__builtin_ctz(quote_mask));
+      lines += static_cast<uint32_t>(
+          __builtin_popcount(newline_mask & ((1u << stop) - 1)));
+      return begin + stop;
+    }
+    lines += static_cast<uint32_t>(__builtin_popcount(newline_mask));
+    begin += 16;
+  }
+  return FindQuoteScalar(begin, end, lines);
+}
+
+// ------------- AVX2 -------------
+[[gnu::target("avx2")]] const char *SkipWhitespaceAvx2(const char *begin,
+                                                       const char *end,
+                                                       uint32_t &lines) {
+  const __m256i space = _mm256_set1_epi8(' ');
+  const __m256i tab = _mm256_set1_epi8('\t');
+  const __m256i carriage = _mm256_set1_epi8('\r');
+  const __m256i newline = _mm256_set1_epi8('\n');
+
+  while (end - begin >= 32) {
+    __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+    __m256i is_newline = _mm256_cmpeq_epi8(chunk, newline);
+    __m256i is_space = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space),
+                        _mm256_cmpeq_epi8(chunk, tab)),
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, carriage), is_newline));
+    uint32_t space_mask =
+        static_cast<uint32_t>(_mm256_movemask_epi8(is_space));
+    uint32_t newline_mask =
+        static_cast<uint32_t>(_mm256_movemask_epi8(is_newline));
+
+    if (space_mask != 0xFFFFFFFF) {
+      uint32_t stop = static_cast<uint32_t>(__builtin_ctz(~space_mask));
+      lines += static_cast<uint32_t>(
+          __builtin_popcount(newline_mask & ((1u << stop) - 1)));
+      return begin + stop;
+    }
+    lines += static_cast<uint32_t>(__builtin_popcount(newline_mask));
+    begin += 32;
+  }
+  return SkipWhitespaceSse2(begin, end, lines);
+}
+
+[[gnu::target("avx2")]] const char *FindNewlineAvx2(const char *begin,
+                                                    const char *end) {
+  const __m256i newline = _mm256_set1_epi8('\n');
+
+  while (end - begin >= 32) {
+    __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+    uint32_t mask = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+    if (mask != 0) {
+      return begin + __builtin_ctz(mask);
+    }
+    begin += 32;
+  }
+  return FindNewlineSse2(begin, end);
+}
+
+[[gnu::target("avx2")]] const char *FindQuoteAvx2(const char *begin,
+                                                  const char *end,
+                                                  uint32_t &lines) {
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i newline = _mm256_set1_epi8('\n');
+
+  while (end - begin >= 32) {
+    __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+    uint32_t quote_mask = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote)));
+    uint32_t newline_mask = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+
+    if (quote_mask != 0) {
+      uint32_t stop = static_cast<uint32_t>(__builtin_ctz(quote_mask));
+      lines += static_cast<uint32_t>(
+          __builtin_popcount(newline_mask & ((1u << stop) - 1)));
+      return begin + stop;
+    }
+    lines += static_cast<uint32_t>(__builtin_popcount(newline_mask));
+    begin += 32;
+  }
+  return FindQuoteSse2(begin, end, lines);
+}
+#endif
+
+}  // namespace
+
+const ScanKernels &ScanKernels::Scalar() {
+  static const ScanKernels kernels{SkipWhitespaceScalar, FindNewlineScalar,
+                                   FindQuoteScalar, "scalar"};
+  return kernels;
+}
+
+const ScanKernels *ScanKernels::Sse2() {
+#if defined(__x86_64__)
+  static const ScanKernels kernels{SkipWhitespaceSse2, FindNewlineSse2,
+                                   FindQuoteSse2, "sse2"};
+  return &kernels;
+#else
+  return nullptr;
+#endif
+}
+
+const ScanKernels *ScanKernels::Avx2() {
+#if defined(__x86_64__)
+  static const ScanKernels kernels{SkipWhitespaceAvx2, FindNewlineAvx2,
+                                   FindQuoteAvx2, "avx2"};
+  if (__builtin_cpu_supports("avx2")) {
+    return &kernels;
+  }
+#endif
+  return nullptr;
+}
+
+const ScanKernels &ScanKernels::Get() {
+  static const ScanKernels &best = []() -> const ScanKernels & {
+    if (const ScanKernels *avx2 = Avx2()) {
+      return *avx2;
+    }
+    if (const ScanKernels *sse2 = Sse2()) {
+      return *sse2;
+    }
+    return Scalar();
+  }();
+  return best;
+}
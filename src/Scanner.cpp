@@ -1,57 +1,73 @@
 
 #include "includes/Scanner.hpp"
 
+#include <charconv>
+#include <limits>
+
 #include "includes/Error.hpp"
 
-Scanner::Scanner(const std::string &in_source) : source(in_source) {}
+Scanner::Scanner(std::string_view in_source, Error *in_error)
+    : source(in_source),
+      tokens(in_source),
+      error(in_error != nullptr ? in_error : &own_error) {
+  // Token offsets and lengths are stored as 32 bits
+  if (source.size() > UINT32_MAX) {
+    throw std::length_error("Source larger than 4 GiB");
+  }
+}
 
-void Scanner::AddToken(const TokenType &type, const void *literal) {
-  TokenVoid::GetTokens()->push_back(
-      std::make_unique<TokenVoid>(type, "RESERVED", literal, line));
+void Scanner::AddToken(const TokenType &type) {
+  tokens.Push(type, static_cast<uint32_t>(start),
+              static_cast<uint32_t>(current - start), line);
 }
 
-// Overloading for Strings
-void Scanner::AddToken(const TokenType &type,
-                       std::unique_ptr<const std::string> literal) {
-  std::string text = source.substr(start, current - start);
-  TokenString::GetTokens()->push_back(std::make_unique<TokenString>(
-      type, std::move(text), std::move(literal), line));
+// Overloading for Numbers
+void Scanner::AddToken([[maybe_unused]] const TokenType &type,
+                       double literal) {
+  tokens.PushNumber(static_cast<uint32_t>(start),
+                    static_cast<uint32_t>(current - start), line, literal);
 }
 
-// // Overloading for Numbers
-void Scanner::AddToken(const TokenType &type,
-                       std::unique_ptr<const double> literal) {
-  std::string text = source.substr(start, current - start);
-  TokenDouble::GetTokens()->push_back(std::make_unique<TokenDouble>(
-      type, std::move(text), std::move(literal), line));
+void Scanner::SkipWhitespace() {
+  // The first whitespace byte has already been consumed by ScanToken
+  uint32_t lines = 0;
+  const char *stop = kernels.skip_whitespace(
+      source.data() + current - 1, source.data() + source.size(), lines);
+  current = static_cast<size_t>(stop - source.data());
+  line += lines;
 }
 
-void Scanner::AddToken(const TokenType &type) {
-  AddToken(type, static_cast<void *>(nullptr));
+void Scanner::SkipComment() {
+  // A comment goes until the end of the line
+  const char *stop = kernels.find_newline(source.data() + current,
+                                          source.data() + source.size());
+  current = static_cast<size_t>(stop - source.data());
+  // Nothing in a comment needs to be kept, so rather than carrying it into
+  // the next window just remember to keep skipping there
+  in_comment = Truncated();
 }
 
 void Scanner::String() {
-  while (Peek() != '"' && !IsAtEnd()) {
-    if (Peek() == '\n') {
-      line++;
-    }
-    Advance();
-  }
+  uint32_t lines = 0;
+  const char *stop = kernels.find_quote(
+      source.data() + current, source.data() + source.size(), lines);
+  current = static_cast<size_t>(stop - source.data());
+  line += lines;
 
   if (IsAtEnd()) {
-    Error::SendError(line, "Unterminated string.");
+    if (partial) {
+      Suspend();
+    } else {
+      error->SendError(line, "Unterminated string.");
+    }
     return;
   }
 
   // The closing "
   Advance();
 
-  // Trim the surrounding quotes
-  auto value = std::make_unique<std::string>(source.substr(
-      start + 1,
-      current - start -
-          2));  // TODO: Might need to fix the second parameter here
-  AddToken(TokenType::STRING, std::move(value));
+  // The value is the lexeme without its quotes, see TokenBuffer::String
+  AddToken(TokenType::STRING);
 }
 
 void Scanner::Number() {
@@ -59,6 +75,13 @@ void Scanner::Number() {
     Advance();
   }
 
+  // A trailing '.' can only be told apart from a fraction by the next byte
+  if (Truncated() ||
+      (partial && Peek() == '.' && current + 1 == source.size())) {
+    Suspend();
+    return;
+  }
+
   // Look for the fractional part
   if (Peek() == '.' && IsDigit(PeekNext())) {
     // First consume the .
@@ -67,33 +90,50 @@ void Scanner::Number() {
     while (IsDigit(Peek())) {
       Advance();
     }
+    if (Truncated()) {
+      Suspend();
+      return;
+    }
+  }
+  AddToken(TokenType::NUMBER,
+           ParseNumber(source.substr(start, current - start)));
+}
+
+double Scanner::ParseNumber(std::string_view lexeme) {
+  double number = 0.0;
+  auto result =
+      std::from_chars(lexeme.data(), lexeme.data() + lexeme.size(), number);
+  if (result.ec == std::errc::result_out_of_range) {
+    // Without an exponent only a non-zero integer part can overflow
+    bool overflow =
+        lexeme.find_first_not_of('0') < lexeme.find_first_of('.');
+    return overflow ? std::numeric_limits<double>::infinity() : 0.0;
   }
-  auto number = std::make_unique<double>(
-      std::stod(source.substr(start, current - start)));
-  AddToken(TokenType::NUMBER, std::move(number));
+  return number;
 }
 
 void Scanner::Identifier() {
   while (IsAlphaNumeric(Peek())) {
     Advance();
   }
-
-  std::string text = source.substr(start, current - start);
-  auto it_type =
-      std::find_if(keywords.begin(), keywords.end(),
-                   [&](const auto &entry) { return entry.first == text; });
-  if (it_type == keywords.end()) {
-    TokenType type = TokenType::IDENTIFIER;
-    AddToken(type);
+  if (Truncated()) {
+    Suspend();
     return;
   }
 
-  AddToken((*it_type).second);
+  AddToken(ClassifyKeyword(source.substr(start, current - start)));
 }
 
 void Scanner::ScanToken() {
   char c = Advance();
 
+  // The second half of these may be waiting in the next window
+  if (Truncated() &&
+      (c == '!' || c == '=' || c == '<' || c == '>' || c == '/')) {
+    Suspend();
+    return;
+  }
+
   switch (c) {
     case '(':
       AddToken(TokenType::LEFT_PAREN);
@@ -139,10 +179,7 @@ void Scanner::ScanToken() {
       break;
     case '/':
       if (Match('/')) {
-        // A comment goes untill the end of the line
-        while (Peek() != '\n' && !IsAtEnd()) {
-          Advance();
-        }
+        SkipComment();
       } else {
         AddToken(TokenType::SLASH);
       }
@@ -152,10 +189,10 @@ void Scanner::ScanToken() {
     case '\r':
       [[fallthrough]];
     case '\t':
-      // Ignore whitespace
-      break;
+      [[fallthrough]];
     case '\n':
-      line++;
+      // Ignore whitespace, a whole run at a time
+      SkipWhitespace();
       break;
     case '"':
       String();
@@ -166,24 +203,46 @@ void Scanner::ScanToken() {
       } else if (IsAlpha(c)) {
         Identifier();
       } else {
-        Error::SendError(line, "Unexpected character.");
+        error->SendError(line, "Unexpected character.");
       }
       break;
   }
 }
 
-void Scanner::ScanTokens() {
-  while (!IsAtEnd()) {
+size_t Scanner::ScanWindow(std::string_view window, bool last) {
+  source = window;
+  tokens.Reset(window);
+  // Our scripts average a token every five or six bytes
+  tokens.Reserve(source.size() / 5 + 1);
+  partial = !last;
+  suspended = false;
+  current = 0;
+
+  if (in_comment) {
+    SkipComment();
+  }
+
+  while (!IsAtEnd() && !suspended) {
     start = current;
+    start_line = line;
     ScanToken();
   }
 
-  AddToken(TokenType::TEOF);
-  // Push scanner back at the beginning of line
+  size_t consumed = current;
+  if (last) {
+    start = current;
+    AddToken(TokenType::TEOF);
+  }
+  return consumed;
+}
+
+const TokenBuffer &Scanner::ScanTokens() {
+  ScanWindow(source, true);
+
+  // Push scanner back at the beginning of the source
   current = 0;
   start = 0;
+  line = 1;
 
-  // There's probably a better way to clear it, but we don't
-  // care about the type at the point of clearing.
-  TokenVoid::ClearTokens();
+  return tokens;
 }
@@ -0,0 +1,36 @@
+#include "includes/Shape.hpp"
+
+std::atomic<uint64_t> Shape::_next_id{1};
+
+Shape::Shape(ObjClass* klass)
+    : _klass(klass), _id(_next_id.fetch_add(1, std::memory_order_relaxed)) {}
+
+Shape::Shape(const Shape& parent, const Symbol* name)
+    : _klass(parent._klass),
+      _id(_next_id.fetch_add(1, std::memory_order_relaxed)) {
+  _names.reserve(parent._names.size() + 1);
+  _names.assign(parent._names.begin(), parent._names.end());
+  _names.push_back(name);
+}
+
+Shape* Shape::Transition(const Symbol* name) {
+  for (const auto& transition : _transitions) {
+    if (transition.first == name) return transition.second.get();
+  }
+  if (_names.size() == MAX_FIELDS || _transitions.size() == MAX_TRANSITIONS) {
+    return nullptr;
+  }
+
+  _transitions.emplace_back(name,
+                            std::unique_ptr<Shape>(new Shape(*this, name)));
+  return _transitions.back().second.get();
+}
+
+size_t Shape::TreeBytes() const {
+  size_t bytes = sizeof(Shape) + _names.capacity() * sizeof(const Symbol*) +
+                 _transitions.capacity() * sizeof(_transitions[0]);
+  for (const auto& transition : _transitions) {
+    bytes += transition.second->TreeBytes();
+  }
+  return bytes;
+}
@@ -0,0 +1,97 @@
+#include "includes/Source.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <stdexcept>
+
+Source::Source(const std::string &path) {
+  if (path == "-") {
+    ReadAll(STDIN_FILENO);
+    return;
+  }
+
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::runtime_error("Error opening file");
+  }
+
+  try {
+    struct stat info {};
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+      // An empty file cannot be mapped, but there is nothing to read either
+      if (info.st_size > 0) {
+        Map(fd, static_cast<size_t>(info.st_size));
+      }
+    } else {
+      ReadAll(fd);
+    }
+  } catch (...) {
+    close(fd);
+    throw;
+  }
+  // The mapping stays valid after the descriptor is closed
+  close(fd);
+}
+
+Source::Source(Source &&other) noexcept
+    : _data(other._data),
+      _size(other._size),
+      _mapped(other._mapped),
+      _buffer(std::move(other._buffer)) {
+  if (!_mapped) {
+    _data = _buffer.data();
+  }
+  other._data = nullptr;
+  other._size = 0;
+  other._mapped = false;
+}
+
+Source::~Source() {
+  if (_mapped) {
+    munmap(const_cast<char *>(_data), _size);
+  }
+}
+
+void Source::Map(int fd, size_t size) {
+  void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (addr == MAP_FAILED) {
+    // Some filesystems refuse mmap, so read it the slow way instead
+    ReadAll(fd);
+    return;
+  }
+  // The scanner walks the file front to back exactly once
+  madvise(addr, size, MADV_SEQUENTIAL);
+  madvise(addr, size, MADV_WILLNEED);
+
+  _data = static_cast<const char *>(addr);
+  _size = size;
+  _mapped = true;
+}
+
+void Source::ReadAll(int fd) {
+  constexpr size_t chunk_size = 64 * 1024;
+  size_t used = 0;
+
+  while (true) {
+    _buffer.resize(used + chunk_size);
+    ssize_t count = read(fd, _buffer.data() + used, chunk_size);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::runtime_error("Error reading file");
+    }
+    if (count == 0) {
+      break;
+    }
+    used += static_cast<size_t>(count);
+  }
+
+  _buffer.resize(used);
+  _data = _buffer.data();
+  _size = used;
+}
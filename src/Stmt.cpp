@@ -0,0 +1,100 @@
+#include "Stmt.hpp"
+
+#include <type_traits>
+
+// ------------- BLOCK CLASS -------------
+Block::Block(StmtList statements) noexcept
+    : Stmt(Kind::BLOCK), _statements(statements) {}
+
+Block::Block(Block&& other) noexcept
+    : Stmt(std::move(other)), _statements(other._statements) {}
+
+// ------------- CLASS CLASS -------------
+Class::Class(Token<>&& name, const Variable* superclass,
+             MethodList methods) noexcept
+    : Stmt(Kind::CLASS),
+      _name(std::move(name)),
+      _superclass(superclass),
+      _methods(methods) {}
+
+Class::Class(Class&& other) noexcept
+    : Stmt(std::move(other)),
+      _name(std::move(other._name)),
+      _superclass(other._superclass),
+      _methods(other._methods) {}
+
+// ------------- EXPRESSION CLASS -------------
+Expression::Expression(const Expr* expression) noexcept
+    : Stmt(Kind::EXPRESSION), _expression(expression) {}
+
+Expression::Expression(Expression&& other) noexcept
+    : Stmt(std::move(other)), _expression(other._expression) {}
+
+// ------------- FUNCTION CLASS -------------
+Function::Function(Token<>&& name, const Symbol* symbol, ParamList params,
+                   StmtList body) noexcept
+    : Stmt(Kind::FUNCTION),
+      _name(std::move(name)),
+      _symbol(symbol),
+      _params(params),
+      _body(body) {}
+
+Function::Function(Function&& other) noexcept
+    : Stmt(std::move(other)),
+      _name(std::move(other._name)),
+      _symbol(other._symbol),
+      _params(other._params),
+      _body(other._body) {}
+
+// ------------- IF CLASS -------------
+If::If(const Expr* condition, const Stmt* then_branch,
+       const Stmt* else_branch) noexcept
+    : Stmt(Kind::IF),
+      _condition(condition),
+      _then_branch(then_branch),
+      _else_branch(else_branch) {}
+
+If::If(If&& other) noexcept
+    : Stmt(std::move(other)),
+      _condition(other._condition),
+      _then_branch(other._then_branch),
+      _else_branch(other._else_branch) {}
+
+// ------------- PRINT CLASS -------------
+Print::Print(const Expr* expression) noexcept
+    : Stmt(Kind::PRINT), _expression(expression) {}
+
+Print::Print(Print&& other) noexcept
+    : Stmt(std::move(other)), _expression(other._expression) {}
+
+// ------------- RETURN CLASS -------------
+Return::Return(Token<>&& keyword, const Expr* value) noexcept
+    : Stmt(Kind::RETURN), _keyword(std::move(keyword)), _value(value) {}
+
+Return::Return(Return&& other) noexcept
+    : Stmt(std::move(other)),
+      _keyword(std::move(other._keyword)),
+      _value(other._value) {}
+
+// ------------- VAR CLASS -------------
+Var::Var(Token<>&& name, const Expr* initializer) noexcept
+    : Stmt(Kind::VAR), _name(std::move(name)), _initializer(initializer) {}
+
+Var::Var(Var&& other) noexcept
+    : Stmt(std::move(other)),
+      _name(std::move(other._name)),
+      _initializer(other._initializer) {}
+
+// ------------- WHILE CLASS -------------
+While::While(const Expr* condition, const Stmt* body) noexcept
+    : Stmt(Kind::WHILE), _condition(condition), _body(body) {}
+
+While::While(While&& other) noexcept
+    : Stmt(std::move(other)),
+      _condition(other._condition),
+      _body(other._body) {}
+
+static_assert(std::is_trivially_destructible_v<Class> &&
+                  std::is_trivially_destructible_v<Function> &&
+                  std::is_trivially_destructible_v<Var>,
+              "AST nodes are released by resetting their arena");
@@ -0,0 +1,49 @@
+#include "includes/StreamScanner.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+StreamScanner::StreamScanner(int fd, size_t chunk_size, Error *error)
+    : _fd(fd),
+      _chunk_size(chunk_size == 0 ? 1 : chunk_size),
+      _scanner({}, error) {}
+
+size_t StreamScanner::Read(char *into, size_t size) {
+  while (true) {
+    ssize_t count = read(_fd, into, size);
+    if (count >= 0) {
+      return static_cast<size_t>(count);
+    }
+    if (errno != EINTR) {
+      throw std::runtime_error("Error reading file");
+    }
+  }
+}
+
+void StreamScanner::ScanTokens(const Consumer &consumer) {
+  size_t carried = 0;
+
+  while (true) {
+    _window.resize(carried + _chunk_size);
+    size_t count = Read(_window.data() + carried, _chunk_size);
+    bool last = count == 0;
+    size_t filled = carried + count;
+    _peak_window = std::max(_peak_window, filled);
+
+    size_t consumed = _scanner.ScanWindow({_window.data(), filled}, last);
+    if (_scanner.GetTokens().Size() > 0) {
+      consumer(_scanner.GetTokens());
+    }
+    if (last) {
+      break;
+    }
+
+    // Move the cut-off token to the front; the next chunk goes after it
+    carried = filled - consumed;
+    std::memmove(_window.data(), _window.data() + consumed, carried);
+  }
+}
@@ -0,0 +1,99 @@
+#include "includes/ThreadPool.hpp"
+
+namespace {
+// Index of the worker running on this thread, or none for outside threads
+thread_local const ThreadPool *current_pool = nullptr;
+thread_local size_t current_worker = 0;
+}  // namespace
+
+ThreadPool::ThreadPool(size_t threads) {
+  if (threads == 0) {
+    threads = 1;
+  }
+  for (size_t i = 0; i < threads; i++) {
+    _workers.push_back(std::make_unique<Worker>());
+  }
+  for (size_t i = 0; i < threads; i++) {
+    _threads.emplace_back([this, i] { Loop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _wake.notify_all();
+  for (auto &thread : _threads) {
+    thread.join();
+  }
+}
+
+void ThreadPool::Submit(Task task) {
+  size_t target = current_pool == this
+                      ? current_worker
+                      : _next.fetch_add(1) % _workers.size();
+  _pending++;
+  _queued++;
+  {
+    std::lock_guard<std::mutex> lock(_workers[target]->mutex);
+    _workers[target]->tasks.push_back(std::move(task));
+  }
+
+  // Taking the lock orders this against a worker about to go to sleep
+  { std::lock_guard<std::mutex> lock(_mutex); }
+  _wake.notify_one();
+}
+
+void ThreadPool::Wait() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  _idle.wait(lock, [this] { return _pending == 0; });
+}
+
+bool ThreadPool::Pop(size_t self, Task &task) {
+  Worker &worker = *_workers[self];
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  if (worker.tasks.empty()) {
+    return false;
+  }
+  task = std::move(worker.tasks.back());
+  worker.tasks.pop_back();
+  return true;
+}
+
+bool ThreadPool::Steal(size_t self, Task &task) {
+  for (size_t offset = 1; offset < _workers.size(); offset++) {
+    Worker &victim = *_workers[(self + offset) % _workers.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::Loop(size_t self) {
+  current_pool = this;
+  current_worker = self;
+
+  while (true) {
+    Task task;
+    if (Pop(self, task) || Steal(self, task)) {
+      _queued--;
+      task();
+      if (_pending.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _idle.notify_all();
+      }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _wake.wait(lock, [this] { return _stop || _queued > 0; });
+    if (_stop && _queued == 0) {
+      return;
+    }
+  }
+}
@@ -0,0 +1,43 @@
+#include "includes/TokenBuffer.hpp"
+
+#include <algorithm>
+
+double TokenBuffer::Number(size_t index) const {
+  auto it = std::lower_bound(_number_tokens.begin(), _number_tokens.end(),
+                             static_cast<uint32_t>(index));
+  return _numbers[static_cast<size_t>(it - _number_tokens.begin())];
+}
+
+void TokenBuffer::Reset(std::string_view source) {
+  _source = source;
+  _types.clear();
+  _offsets.clear();
+  _lengths.clear();
+  _lines.clear();
+  _number_tokens.clear();
+  _numbers.clear();
+}
+
+void TokenBuffer::Reserve(size_t count) {
+  _types.reserve(count);
+  _offsets.reserve(count);
+  _lengths.reserve(count);
+  _lines.reserve(count);
+}
+
+void TokenBuffer::ShrinkToFit() {
+  _types.shrink_to_fit();
+  _offsets.shrink_to_fit();
+  _lengths.shrink_to_fit();
+  _lines.shrink_to_fit();
+  _number_tokens.shrink_to_fit();
+  _numbers.shrink_to_fit();
+}
+
+size_t TokenBuffer::MemoryUsage() const {
+  return _types.capacity() * sizeof(TokenType) +
+         (_offsets.capacity() + _lengths.capacity() + _lines.capacity() +
+          _number_tokens.capacity()) *
+             sizeof(uint32_t) +
+         _numbers.capacity() * sizeof(double);
+}
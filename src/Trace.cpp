@@ -0,0 +1,82 @@
+#include "includes/Trace.hpp"
+
+#include <fmt/core.h>
+#include <fmt/os.h>
+
+#include <stdexcept>
+
+namespace {
+
+// Trace names come from identifiers and fixed strings, but a quote or a
+// backslash would still break the file
+std::string Escape(std::string_view text) {
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      escaped += fmt::format("\\u{:04x}", static_cast<int>(c));
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+}  // namespace
+
+Tracer::Tracer(std::string path)
+    : _path(std::move(path)), _start(Clock::now()), _previous(_active) {
+  _active = this;
+}
+
+Tracer::~Tracer() { _active = _previous; }
+
+void Tracer::Begin(std::string_view name, const char* category) {
+  _events.push_back({'B', category, std::string(name), Now(), 0});
+  _depth++;
+}
+
+void Tracer::End() {
+  _events.push_back({'E', "", "", Now(), 0});
+  _depth--;
+}
+
+void Tracer::Unwind(size_t depth) {
+  while (_depth > depth) End();
+}
+
+void Tracer::Count(std::string_view name, double value) {
+  _events.push_back({'C', "counter", std::string(name), Now(), value});
+}
+
+void Tracer::Write() {
+  Unwind(0);
+  try {
+    auto out = fmt::output_file(_path);
+    out.print("{{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    const char* separator = "\n";
+    for (const Event& event : _events) {
+      // Microseconds, as the format has it
+      double time = static_cast<double>(event.time.count()) / 1000;
+      out.print("{}{{\"ph\":\"{}\",\"ts\":{:.3f},\"pid\":1,\"tid\":1",
+                separator, event.phase, time);
+      if (event.phase == 'C') {
+        out.print(",\"name\":\"{}\",\"args\":{{\"value\":{}}}",
+                  Escape(event.name), event.value);
+      } else if (event.phase == 'B') {
+        out.print(",\"name\":\"{}\",\"cat\":\"{}\"", Escape(event.name),
+                  event.category);
+      }
+      out.print("}}");
+      separator = ",\n";
+    }
+    out.print("\n]}}\n");
+    out.close();
+  } catch (const std::exception& e) {
+    throw std::runtime_error("Could not write trace to " + _path + ": " +
+                             e.what());
+  }
+}
@@ -0,0 +1,608 @@
+#include "includes/VM.hpp"
+
+#include "includes/BytecodeCache.hpp"
+#include "includes/Compiler.hpp"
+#include "includes/Trace.hpp"
+
+VM::VM(Error& error, std::ostream& out)
+    : _error(error), _out(out), _stack(std::make_unique<Value[]>(STACK_MAX)) {
+  ResetStack();
+  _heap.SetRoots(this);
+  auto* clock = _heap.Make<ObjNative>("clock", 0, ClockNative);
+  _globals[Interner::Global().Intern("clock")] = Value::Object(clock);
+}
+
+void VM::Interpret(StmtList statements) {
+  if (ObjProto* script = Compile(statements)) {
+    Interpret(script);
+  }
+}
+
+ObjProto* VM::Compile(StmtList statements) {
+  TraceSpan span("compile");
+  Compiler compiler(_heap, _error, _globals);
+  _compiler = &compiler;
+  ObjProto* script = compiler.Compile(statements);
+  _compiler = nullptr;
+  return script;
+}
+
+ObjProto* VM::Load(BytecodeCache& cache, std::string_view source) {
+  TraceSpan span("load bytecode");
+  _loader = &cache;
+  ObjProto* script = cache.Load(source, _heap);
+  _loader = nullptr;
+  return script;
+}
+
+void VM::Interpret(ObjProto* script) {
+  TraceSpan span("execute");
+  Tracer* tracer = Tracer::Active();
+  size_t depth = tracer != nullptr ? tracer->Depth() : 0;
+
+  auto* closure = _heap.Make<ObjClosure>(script);
+  Push(Value::Object(closure));
+  Call(closure, 0);
+  Run();
+  // A runtime error abandons the calls in progress without returning
+  if (tracer != nullptr) tracer->Unwind(depth);
+}
+
+void VM::ResetStack() {
+  _sp = _stack.get();
+  _frame_count = 0;
+  _open_upvalues = nullptr;
+}
+
+void VM::MarkRoots(Heap& heap) {
+  for (const Value* slot = _stack.get(); slot < _sp; slot++) {
+    heap.Mark(*slot);
+  }
+  for (size_t i = 0; i < _frame_count; i++) {
+    heap.Mark(_frames[i].closure);
+  }
+  for (ObjUpvalue* upvalue = _open_upvalues; upvalue != nullptr;
+       upvalue = upvalue->next_open) {
+    heap.Mark(upvalue);
+  }
+  for (const auto& global : _globals) {
+    heap.Mark(global.second);
+  }
+  if (_compiler != nullptr) {
+    _compiler->MarkRoots(heap);
+  }
+  if (_loader != nullptr) {
+    _loader->MarkRoots(heap);
+  }
+}
+
+void VM::RuntimeError(const std::string& message) {
+  const CallFrame& frame = _frames[_frame_count - 1];
+  const Chunk& chunk = frame.closure->GetProto()->GetChunk();
+  size_t offset = static_cast<size_t>(frame.ip - chunk.Code()) - 1;
+  _error.RuntimeError(chunk.GetLine(offset), message);
+  ResetStack();
+}
+
+bool VM::CallValue(Value callee, uint8_t argc, InlineCache* cache) {
+  if (callee.IsObject()) {
+    switch (callee.AsObject()->GetType()) {
+      case ObjType::CLOSURE:
+        return Call(AsObj<ObjClosure>(callee), argc);
+      case ObjType::NATIVE: {
+        auto* native = AsObj<ObjNative>(callee);
+        if (argc != native->Arity()) {
+          RuntimeError("Expected " + std::to_string(native->Arity()) +
+                       " arguments but got " + std::to_string(argc) + ".");
+          return false;
+        }
+        Value result = native->Call(std::span<const Value>(_sp - argc, argc));
+        _sp -= argc + 1;
+        Push(result);
+        return true;
+      }
+      case ObjType::CLASS: {
+        auto* klass = AsObj<ObjClass>(callee);
+        _sp[-argc - 1] = Value::Object(_heap.Make<ObjInstance>(klass));
+        auto* init = cache != nullptr ? klass->FindMethod<ObjClosure>(
+                                            _init, *cache, _cache_stats)
+                                      : klass->FindMethod<ObjClosure>(_init);
+        if (init != nullptr) {
+          return Call(init, argc);
+        }
+        if (argc != 0) {
+          RuntimeError("Expected 0 arguments but got " +
+                       std::to_string(argc) + ".");
+          return false;
+        }
+        return true;
+      }
+      case ObjType::BOUND_METHOD: {
+        auto* bound = AsObj<ObjBoundMethod>(callee);
+        _sp[-argc - 1] = bound->GetReceiver();
+        return Call(bound->GetMethod<ObjClosure>(), argc);
+      }
+      default:
+        break;
+    }
+  }
+
+  RuntimeError("Can only call functions and classes.");
+  return false;
+}
+
+bool VM::Call(ObjClosure* closure, uint8_t argc) {
+  ObjProto* proto = closure->GetProto();
+  if (argc != proto->arity) {
+    RuntimeError("Expected " + std::to_string(proto->arity) +
+                 " arguments but got " + std::to_string(argc) + ".");
+    return false;
+  }
+  if (_frame_count == FRAMES_MAX) {
+    RuntimeError("Stack overflow.");
+    return false;
+  }
+
+  // Calls from the script are traced, not the script itself
+  if (Tracer* tracer = Tracer::Active(); tracer != nullptr && _frame_count > 0)
+      [[unlikely]] {
+    tracer->Begin(proto->Name(), "function");
+  }
+  CallFrame& frame = _frames[_frame_count++];
+  frame.closure = closure;
+  frame.ip = proto->GetChunk().Code();
+  frame.slots = _sp - argc - 1;
+  return true;
+}
+
+bool VM::GetMethod(const Symbol* name, InlineCache& cache) {
+  Value receiver = Peek(0);
+  if (!IsObjType(receiver, ObjType::INSTANCE)) {
+    RuntimeError("Only instances have properties.");
+    return false;
+  }
+
+  Obj* method = nullptr;
+  if (Value* field = AsObj<ObjInstance>(receiver)->GetProperty(
+          name, cache, _cache_stats, method)) {
+    _sp[-1] = *field;
+    Push(Value::Nil());
+    return true;
+  }
+  if (method == nullptr) {
+    RuntimeError("Undefined property '" + std::string(name->text) + "'.");
+    return false;
+  }
+  Push(Value::Object(method));
+  return true;
+}
+
+bool VM::Invoke(uint8_t argc) {
+  Value* args = _sp - argc;
+  Value method = args[-1];
+  std::copy(args, _sp, args - 1);
+  _sp--;
+
+  if (method.IsNil()) {
+    // The site's cache is keyed on receiver shapes, which a class stored
+    // in the field could share for its initializer: look that up uncached
+    return CallValue(Peek(argc), argc, nullptr);
+  }
+  // The receiver already sits in the callee's slot, where the method's
+  // frame expects `this`
+  _heap.CountElided();
+  return Call(AsObj<ObjClosure>(method), argc);
+}
+
+bool VM::BindMethod(Obj* method, const Symbol* name) {
+  if (method == nullptr) {
+    RuntimeError("Undefined property '" + std::string(name->text) + "'.");
+    return false;
+  }
+
+  auto* bound = _heap.Make<ObjBoundMethod>(Peek(0), method);
+  Pop();
+  Push(Value::Object(bound));
+  return true;
+}
+
+ObjUpvalue* VM::CaptureUpvalue(Value* local) {
+  ObjUpvalue* previous = nullptr;
+  ObjUpvalue* upvalue = _open_upvalues;
+  while (upvalue != nullptr && upvalue->location > local) {
+    previous = upvalue;
+    upvalue = upvalue->next_open;
+  }
+  if (upvalue != nullptr && upvalue->location == local) {
+    return upvalue;
+  }
+
+  auto* created = _heap.Make<ObjUpvalue>(local);
+  created->next_open = upvalue;
+  if (previous == nullptr) {
+    _open_upvalues = created;
+  } else {
+    previous->next_open = created;
+  }
+  return created;
+}
+
+void VM::CloseUpvalues(const Value* last) {
+  while (_open_upvalues != nullptr && _open_upvalues->location >= last) {
+    ObjUpvalue* upvalue = _open_upvalues;
+    upvalue->Close();
+    // The variable leaves the stack, where the marker would have found it
+    _heap.WriteBarrier(upvalue, upvalue->closed);
+    _open_upvalues = upvalue->next_open;
+  }
+}
+
+// Labels as values and computed goto are GNU extensions
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+bool VM::Run() {
+  CallFrame* frame;
+  const uint8_t* ip;
+  const Value* constants;
+  InlineCache* caches;
+
+#define LOAD_FRAME()                                                  \
+  do {                                                                \
+    frame = &_frames[_frame_count - 1];                               \
+    ip = frame->ip;                                                   \
+    constants = frame->closure->GetProto()->GetChunk().Constants().data(); \
+    caches = frame->closure->GetProto()->caches.data();               \
+  } while (false)
+#define READ_BYTE() (*ip++)
+#define READ_SHORT() (ip += 2, static_cast<uint16_t>((ip[-2] << 8) | ip[-1]))
+#define READ_CONSTANT() (constants[READ_SHORT()])
+#define READ_NAME() (AsObj<ObjString>(READ_CONSTANT())->GetSymbol())
+#define THROW(message)      \
+  do {                      \
+    frame->ip = ip;         \
+    RuntimeError(message);  \
+    return false;           \
+  } while (false)
+#define BINARY_OP(make, op)                             \
+  do {                                                  \
+    if (!Peek(0).IsNumber() || !Peek(1).IsNumber()) {   \
+      THROW("Operands must be numbers.");               \
+    }                                                   \
+    double b = Pop().AsNumber();                        \
+    double a = Pop().AsNumber();                        \
+    Push(Value::make(a op b));                          \
+  } while (false)
+
+#ifdef CPPLOX_COMPUTED_GOTO
+  static const void* dispatch_table[] = {
+#define CPPLOX_OPCODE_LABEL(name) &&op_##name,
+      CPPLOX_OPCODES(CPPLOX_OPCODE_LABEL)
+#undef CPPLOX_OPCODE_LABEL
+  };
+#define DISPATCH() goto* dispatch_table[READ_BYTE()]
+#define CASE(name) op_##name
+#else
+#define DISPATCH() continue
+#define CASE(name) case OpCode::name
+#endif
+
+  LOAD_FRAME();
+
+#ifdef CPPLOX_COMPUTED_GOTO
+  DISPATCH();
+#else
+  for (;;) {
+    switch (static_cast<OpCode>(READ_BYTE())) {
+#endif
+
+  CASE(CONSTANT) : {
+    Push(READ_CONSTANT());
+    DISPATCH();
+  }
+  CASE(NIL) : {
+    Push(Value::Nil());
+    DISPATCH();
+  }
+  CASE(TRUE) : {
+    Push(Value::Bool(true));
+    DISPATCH();
+  }
+  CASE(FALSE) : {
+    Push(Value::Bool(false));
+    DISPATCH();
+  }
+  CASE(POP) : {
+    Pop();
+    DISPATCH();
+  }
+  CASE(GET_LOCAL) : {
+    Push(frame->slots[READ_BYTE()]);
+    DISPATCH();
+  }
+  CASE(SET_LOCAL) : {
+    frame->slots[READ_BYTE()] = Peek(0);
+    DISPATCH();
+  }
+  CASE(GET_GLOBAL) : {
+    const Symbol* name = READ_NAME();
+    auto global = _globals.find(name);
+    if (global == _globals.end()) {
+      THROW("Undefined variable '" + std::string(name->text) + "'.");
+    }
+    Push(global->second);
+    DISPATCH();
+  }
+  CASE(DEFINE_GLOBAL) : {
+    _globals[READ_NAME()] = Pop();
+    DISPATCH();
+  }
+  CASE(SET_GLOBAL) : {
+    const Symbol* name = READ_NAME();
+    auto global = _globals.find(name);
+    if (global == _globals.end()) {
+      THROW("Undefined variable '" + std::string(name->text) + "'.");
+    }
+    global->second = Peek(0);
+    DISPATCH();
+  }
+  CASE(GET_UPVALUE) : {
+    Push(*frame->closure->Upvalue(READ_BYTE())->location);
+    DISPATCH();
+  }
+  CASE(SET_UPVALUE) : {
+    ObjUpvalue* upvalue = frame->closure->Upvalue(READ_BYTE());
+    *upvalue->location = Peek(0);
+    _heap.WriteBarrier(upvalue, Peek(0));
+    DISPATCH();
+  }
+  CASE(GET_PROPERTY) : {
+    const Symbol* name = READ_NAME();
+    InlineCache& cache = caches[READ_SHORT()];
+    if (!IsObjType(Peek(0), ObjType::INSTANCE)) {
+      THROW("Only instances have properties.");
+    }
+
+    Obj* method = nullptr;
+    if (Value* field = AsObj<ObjInstance>(Peek(0))->GetProperty(
+            name, cache, _cache_stats, method)) {
+      Pop();
+      Push(*field);
+      DISPATCH();
+    }
+    frame->ip = ip;
+    if (!BindMethod(method, name)) {
+      return false;
+    }
+    DISPATCH();
+  }
+  CASE(SET_PROPERTY) : {
+    const Symbol* name = READ_NAME();
+    InlineCache& cache = caches[READ_SHORT()];
+    if (!IsObjType(Peek(1), ObjType::INSTANCE)) {
+      THROW("Only instances have fields.");
+    }
+
+    AsObj<ObjInstance>(Peek(1))->SetProperty(name, Peek(0), cache,
+                                             _cache_stats);
+    _heap.WriteBarrier(Peek(1).AsObject(), Peek(0));
+    Value value = Pop();
+    Pop();
+    Push(value);
+    DISPATCH();
+  }
+  CASE(GET_SUPER) : {
+    const Symbol* name = READ_NAME();
+    auto* superclass = AsObj<ObjClass>(Pop());
+    frame->ip = ip;
+    if (!BindMethod(superclass->FindMethod<Obj>(name), name)) {
+      return false;
+    }
+    DISPATCH();
+  }
+  CASE(EQUAL) : {
+    Value b = Pop();
+    Value a = Pop();
+    Push(Value::Bool(ValuesEqual(a, b)));
+    DISPATCH();
+  }
+  CASE(NOT_EQUAL) : {
+    Value b = Pop();
+    Value a = Pop();
+    Push(Value::Bool(!ValuesEqual(a, b)));
+    DISPATCH();
+  }
+  CASE(GREATER) : {
+    BINARY_OP(Bool, >);
+    DISPATCH();
+  }
+  CASE(GREATER_EQUAL) : {
+    BINARY_OP(Bool, >=);
+    DISPATCH();
+  }
+  CASE(LESS) : {
+    BINARY_OP(Bool, <);
+    DISPATCH();
+  }
+  CASE(LESS_EQUAL) : {
+    BINARY_OP(Bool, <=);
+    DISPATCH();
+  }
+  CASE(ADD) : {
+    Value b = Peek(0);
+    Value a = Peek(1);
+    if (a.IsNumber() && b.IsNumber()) {
+      _sp -= 2;
+      Push(Value::Number(a.AsNumber() + b.AsNumber()));
+    } else if (IsObjType(a, ObjType::STRING) &&
+               IsObjType(b, ObjType::STRING)) {
+      std::string_view left = AsObj<ObjString>(a)->View();
+      std::string_view right = AsObj<ObjString>(b)->View();
+      std::string chars;
+      chars.reserve(left.size() + right.size());
+      chars.append(left).append(right);
+      auto* result = _heap.Make<ObjString>(std::move(chars));
+      _sp -= 2;
+      Push(Value::Object(result));
+    } else {
+      THROW("Operands must be two numbers or two strings.");
+    }
+    DISPATCH();
+  }
+  CASE(SUBTRACT) : {
+    BINARY_OP(Number, -);
+    DISPATCH();
+  }
+  CASE(MULTIPLY) : {
+    BINARY_OP(Number, *);
+    DISPATCH();
+  }
+  CASE(DIVIDE) : {
+    BINARY_OP(Number, /);
+    DISPATCH();
+  }
+  CASE(NOT) : {
+    Push(Value::Bool(Pop().IsFalsey()));
+    DISPATCH();
+  }
+  CASE(NEGATE) : {
+    if (!Peek(0).IsNumber()) {
+      THROW("Operand must be a number.");
+    }
+    Push(Value::Number(-Pop().AsNumber()));
+    DISPATCH();
+  }
+  CASE(PRINT) : {
+    _out << Stringify(Pop()) << '\n';
+    DISPATCH();
+  }
+  CASE(JUMP) : {
+    uint16_t offset = READ_SHORT();
+    ip += offset;
+    DISPATCH();
+  }
+  CASE(JUMP_IF_FALSE) : {
+    uint16_t offset = READ_SHORT();
+    if (Peek(0).IsFalsey()) ip += offset;
+    DISPATCH();
+  }
+  CASE(LOOP) : {
+    uint16_t offset = READ_SHORT();
+    ip -= offset;
+    DISPATCH();
+  }
+  CASE(CALL) : {
+    uint8_t argc = READ_BYTE();
+    InlineCache& cache = caches[READ_SHORT()];
+    frame->ip = ip;
+    if (!CallValue(Peek(argc), argc, &cache)) {
+      return false;
+    }
+    LOAD_FRAME();
+    DISPATCH();
+  }
+  CASE(GET_METHOD) : {
+    const Symbol* name = READ_NAME();
+    InlineCache& cache = caches[READ_SHORT()];
+    frame->ip = ip;
+    if (!GetMethod(name, cache)) {
+      return false;
+    }
+    DISPATCH();
+  }
+  CASE(SUPER_METHOD) : {
+    const Symbol* name = READ_NAME();
+    InlineCache& cache = caches[READ_SHORT()];
+    auto* superclass = AsObj<ObjClass>(Pop());
+    auto* method = superclass->FindMethod<ObjClosure>(name, cache,
+                                                      _cache_stats);
+    if (method == nullptr) {
+      THROW("Undefined property '" + std::string(name->text) + "'.");
+    }
+    Push(Value::Object(method));
+    DISPATCH();
+  }
+  CASE(INVOKE) : {
+    uint8_t argc = READ_BYTE();
+    frame->ip = ip;
+    if (!Invoke(argc)) {
+      return false;
+    }
+    LOAD_FRAME();
+    DISPATCH();
+  }
+  CASE(CLOSURE) : {
+    auto* proto = AsObj<ObjProto>(READ_CONSTANT());
+    auto* closure = _heap.Make<ObjClosure>(proto);
+    Push(Value::Object(closure));
+    for (size_t i = 0; i < proto->upvalue_count; i++) {
+      uint8_t is_local = READ_BYTE();
+      uint8_t index = READ_BYTE();
+      closure->Upvalue(i) = is_local ? CaptureUpvalue(frame->slots + index)
+                                     : frame->closure->Upvalue(index);
+      _heap.WriteBarrier(closure, closure->Upvalue(i));
+    }
+    DISPATCH();
+  }
+  CASE(CLOSE_UPVALUE) : {
+    CloseUpvalues(_sp - 1);
+    Pop();
+    DISPATCH();
+  }
+  CASE(RETURN) : {
+    Value result = Pop();
+    CloseUpvalues(frame->slots);
+    _frame_count--;
+    if (_frame_count == 0) {
+      // The script closure itself
+      Pop();
+      return true;
+    }
+    if (Tracer* tracer = Tracer::Active()) [[unlikely]] {
+      tracer->End();
+    }
+
+    _sp = frame->slots;
+    Push(result);
+    LOAD_FRAME();
+    DISPATCH();
+  }
+  CASE(CLASS) : {
+    Push(Value::Object(_heap.Make<ObjClass>(READ_NAME()->text, nullptr)));
+    DISPATCH();
+  }
+  CASE(INHERIT) : {
+    Value superclass = Peek(1);
+    if (!IsObjType(superclass, ObjType::CLASS)) {
+      THROW("Superclass must be a class.");
+    }
+    AsObj<ObjClass>(Peek(0))->Inherit(AsObj<ObjClass>(superclass));
+    _heap.WriteBarrier(Peek(0).AsObject(), superclass);
+    Pop();
+    DISPATCH();
+  }
+  CASE(METHOD) : {
+    const Symbol* name = READ_NAME();
+    AsObj<ObjClass>(Peek(1))->AddMethod(name, Peek(0).AsObject());
+    _heap.WriteBarrier(Peek(1).AsObject(), Peek(0));
+    Pop();
+    DISPATCH();
+  }
+
+#ifndef CPPLOX_COMPUTED_GOTO
+    }
+  }
+#endif
+
+#undef LOAD_FRAME
+#undef READ_BYTE
+#undef READ_SHORT
+#undef READ_CONSTANT
+#undef READ_NAME
+#undef THROW
+#undef BINARY_OP
+#undef DISPATCH
+#undef CASE
+}
+
+#pragma GCC diagnostic pop
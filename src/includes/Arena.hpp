@@ -0,0 +1,116 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator that owns everything built for one compilation unit.
+// Objects are never destroyed individually: Reset() drops them all at once
+// and keeps the first block around for the next unit. Only trivially
+// destructible types may live here, since no destructor will ever run.
+class Arena {
+ public:
+  explicit Arena(size_t block_size = 64 * 1024) : _block_size(block_size) {}
+  ~Arena() = default;
+
+  // No copy
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  // The arena moved from is left empty, as if newly made
+  Arena(Arena &&other) noexcept;
+  Arena &operator=(Arena &&other) noexcept;
+
+  [[gnu::always_inline]] void *Allocate(size_t size, size_t align) {
+    size_t offset = (_used + align - 1) & ~(align - 1);
+    if (offset + size > _capacity) {
+      return AllocateSlow(size, align);
+    }
+    _used = offset + size;
+    return _current + offset;
+  }
+
+  template <typename T, typename... Args>
+  [[gnu::always_inline]] T *Make(Args &&...args) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "Arena objects are never destroyed");
+    return new (Allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  template <typename T>
+  std::span<const T> CopyArray(const std::vector<T> &items) {
+    return CopyArray(std::span<const T>(items));
+  }
+
+  template <typename T>
+  std::span<const T> CopyArray(std::span<const T> items) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Arena arrays are copied bytewise");
+    if (items.empty()) {
+      return {};
+    }
+    auto *copy =
+        static_cast<T *>(Allocate(sizeof(T) * items.size(), alignof(T)));
+    std::memcpy(copy, items.data(), sizeof(T) * items.size());
+    return {copy, items.size()};
+  }
+
+  // For element types that can only be moved, e.g. tokens
+  template <typename T>
+  std::span<const T> MoveArray(std::vector<T> &items) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "Arena objects are never destroyed");
+    if (items.empty()) {
+      return {};
+    }
+    auto *moved =
+        static_cast<T *>(Allocate(sizeof(T) * items.size(), alignof(T)));
+    for (size_t i = 0; i < items.size(); i++) {
+      new (moved + i) T(std::move(items[i]));
+    }
+    return {moved, items.size()};
+  }
+
+  std::string_view CopyString(std::string_view text) {
+    if (text.empty()) {
+      return {};
+    }
+    auto *copy = static_cast<char *>(Allocate(text.size(), 1));
+    std::memcpy(copy, text.data(), text.size());
+    return {copy, text.size()};
+  }
+
+  // Frees every object at once
+  void Reset();
+
+  // Bytes handed out since the last Reset()
+  [[gnu::always_inline]] size_t BytesUsed() const {
+    return _retired + _used;
+  }
+  size_t BytesReserved() const;
+
+ private:
+  void *AllocateSlow(size_t size, size_t align);
+
+  struct Block {
+    std::unique_ptr<std::byte[]> memory;
+    size_t size;
+  };
+
+  size_t _block_size;
+  std::vector<Block> _blocks;
+  std::byte *_current = nullptr;
+  size_t _capacity = 0;
+  size_t _used = 0;
+  size_t _retired = 0;
+};
+
+#endif
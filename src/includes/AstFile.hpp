@@ -0,0 +1,139 @@
+#ifndef AST_FILE_HPP
+#define AST_FILE_HPP
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "Arena.hpp"
+#include "Source.hpp"
+#include "Stmt.hpp"
+
+// A parsed program saved as one position-independent block, so other
+// processes can share a parse instead of redoing it. Nodes are fixed-size
+// records in one array and refer to their children by index; names,
+// operators and string literals are indices into a string table holding
+// each distinct text once; argument, parameter and statement lists live
+// in a shared array of 32-bit words, each list its length followed by its
+// items. Children always come before their parents, so the tree can be
+// walked (or rebuilt) front to back and can never loop.
+//
+// What each kind keeps in a Node, with NONE for a missing child:
+//
+//   Expr ASSIGN    a: name,   b: value
+//        BINARY    a: left,   b: operator,  c: right
+//        CALL      a: callee, b: arguments
+//        GET       a: object, b: name
+//        GROUPING  a: expression
+//        LITERAL   `type` is a LiteralTag; a: bool, or the string, or the
+//                  low and high halves of a number in a and b
+//        LOGICAL   as BINARY
+//        SET       a: object, b: name,      c: value
+//        SUPER     a: method
+//        THIS      nothing
+//        UNARY     a: operator, b: right
+//        VARIABLE  a: name
+//   Stmt BLOCK     a: statements
+//        CLASS     a: name,   b: superclass (a VARIABLE), c: methods
+//        EXPRESSION, PRINT   a: expression
+//        FUNCTION  a: name,   b: parameters (strings), c: body
+//        IF        a: condition, b: then,   c: else
+//        RETURN    a: value
+//        VAR       a: name,   b: initializer
+//        WHILE     a: condition, b: body
+//
+// Operators keep their TokenType in `type`. Each node keeps one line,
+// that of its defining token; resolver slots and inline caches are not
+// saved.
+class AstFile {
+ public:
+  static constexpr uint32_t MAGIC = 0x41584f4c;  // "LOXA"
+  static constexpr uint32_t VERSION = 1;
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  enum class LiteralTag : uint8_t { NIL, BOOL, NUMBER, STRING };
+
+  struct Node {
+    // An Expr::Kind or, if `is_stmt`, a Stmt::Kind
+    uint8_t kind;
+    uint8_t is_stmt;
+    uint8_t type;
+    uint8_t reserved;
+    uint32_t line;
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+  };
+
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t node_count;
+    // In 32-bit words
+    uint32_t list_size;
+    uint32_t string_count;
+    uint32_t text_size;
+    // The list of top-level statements
+    uint32_t program;
+    uint32_t reserved;
+  };
+
+  // The file's bytes for `program`
+  static std::string Write(StmtList program);
+
+  // Maps the file at `path` and checks that every index in it is in
+  // range; throws std::runtime_error if it is not an AST file this
+  // version can read
+  explicit AstFile(const std::string& path);
+  ~AstFile() = default;
+
+  // No copy
+  AstFile(const AstFile&) = delete;
+  AstFile& operator=(const AstFile&) = delete;
+
+  // No move
+  AstFile(AstFile&&) = delete;
+  AstFile& operator=(AstFile&&) = delete;
+
+  [[gnu::always_inline]] std::span<const Node> Nodes() const {
+    return _nodes;
+  }
+
+  [[gnu::always_inline]] const Node& At(uint32_t index) const {
+    return _nodes[index];
+  }
+
+  [[gnu::always_inline]] std::span<const uint32_t> List(
+      uint32_t list) const {
+    return _lists.subspan(list + 1, _lists[list]);
+  }
+
+  [[gnu::always_inline]] std::string_view String(uint32_t string) const {
+    return _text.substr(_offsets[string],
+                        _offsets[string + 1] - _offsets[string]);
+  }
+
+  // Indices of the top-level statements
+  [[gnu::always_inline]] std::span<const uint32_t> Program() const {
+    return List(_program);
+  }
+
+  // The program as ordinary nodes in `arena`, for code that visits Expr
+  // and Stmt trees. Their lexemes point into the mapping, so this file has
+  // to outlive them.
+  StmtList Materialize(Arena& arena) const;
+
+ private:
+  void Validate() const;
+
+  Source _source;
+  std::span<const Node> _nodes;
+  std::span<const uint32_t> _lists;
+  // string_count + 1 of them: where each string starts, then the end
+  std::span<const uint32_t> _offsets;
+  std::string_view _text;
+  uint32_t _program = 0;
+};
+
+#endif
@@ -1,46 +1,43 @@
 #ifndef AST_PRINTER_HPP
 #define AST_PRINTER_HPP
 
+#include <fmt/core.h>
+
 #include <iostream>
 #include <sstream>
 
 #include "Expr.hpp"
 
-template <typename T, typename U>
-class AstPrinter : public Expr<T, U>::Visitor {
+class AstPrinter : public Expr::Visitor<std::string> {
  public:
-  [[gnu::always_inline]] void Print(const Expr<T, U>& expr) const {
+  [[gnu::always_inline]] void Print(const Expr& expr) {
     std::cout << expr.Accept(*this) << std::endl;
   }
 
- private:
-  template <typename K, typename = void>
-  struct has_accept : std::false_type {};
-
-  template <typename K>
-  struct has_accept<K, std::void_t<decltype(std::declval<K>().Accept(
-                           std::declval<typename Expr<T, U>::Visitor>()))>>
-      : std::true_type {};
+  [[gnu::always_inline]] std::string ToString(const Expr& expr) {
+    return expr.Accept(*this);
+  }
 
+ private:
   template <typename K>
-  [[gnu::always_inline]] void Parenthesize(std::stringstream& ss,
-                                           K&& expr) const {
-    if constexpr (has_accept<K>::value) {
+  [[gnu::always_inline]] void Parenthesize(std::stringstream& ss, K&& expr) {
+    using D = std::decay_t<K>;
+    if constexpr (std::is_base_of_v<Expr, D>) {
       ss << " " << expr.Accept(*this);
-    } else if constexpr (std::is_same_v<K, Token<U>>) {
-      ss << " " << expr.GetName()->lexeme;
-    } else if constexpr (std::is_same_v<K, PtrVecExpr<T, U>>) {
-      for (auto&& arg : expr) {
-        ss << " " << *arg.Accept(*this);
+    } else if constexpr (std::is_same_v<D, Token<>>) {
+      ss << " " << expr.lexeme;
+    } else if constexpr (std::is_same_v<D, ExprList>) {
+      for (const Expr* arg : expr) {
+        ss << " " << arg->Accept(*this);
       }
-    } else if constexpr (std::is_same_v<K, std::string>) {
+    } else {
       ss << " " << expr;
     }
   }
 
   template <typename... Args>
-  [[gnu::always_inline]] std::string Parenthesize(const std::string& name,
-                                                  Args&&... exprs) const {
+  [[gnu::always_inline]] std::string Parenthesize(std::string_view name,
+                                                  Args&&... exprs) {
     std::stringstream ss;
     ss << "(" << name;
     (Parenthesize(ss, std::forward<Args>(exprs)), ...);
@@ -49,67 +46,74 @@ class AstPrinter : public Expr<T, U>::Visitor {
   }
 
   [[gnu::always_inline]] std::string VisitAssignExpr(
-      const Assign<T, U>& expr) const override {
+      const Assign& expr) override {
     return Parenthesize("=", expr.GetName()->lexeme, *expr.GetValue());
   }
 
   [[gnu::always_inline]] std::string VisitBinaryExpr(
-      const Binary<T, U>& expr) const override {
+      const Binary& expr) override {
     return Parenthesize(expr.GetOperator()->lexeme, *expr.GetLeft(),
                         *expr.GetRight());
   }
 
-  [[gnu::always_inline]] std::string VisitCallExpr(
-      const Call<T, U>& expr) const override {
-    return Parenthesize("call", *expr.GetCallee(), *expr.GetArgs());
+  [[gnu::always_inline]] std::string VisitCallExpr(const Call& expr) override {
+    return Parenthesize("call", *expr.GetCallee(), expr.GetArgs());
   }
 
-  [[gnu::always_inline]] std::string VisitGetExpr(
-      const Get<T, U>& expr) const override {
+  [[gnu::always_inline]] std::string VisitGetExpr(const Get& expr) override {
     return Parenthesize(".", *expr.GetObject(), *expr.GetName());
   }
 
   [[gnu::always_inline]] std::string VisitGroupingExpr(
-      const Grouping<T, U>& expr) const override {
+      const Grouping& expr) override {
     return Parenthesize("group", *expr.GetExpr());
   }
 
   [[gnu::always_inline]] std::string VisitLiteralExpr(
-      const Literal<T, U>& expr) const override {
-    return std::string(*expr.GetValue());
+      const Literal& expr) override {
+    const LiteralValue& value = expr.GetValue();
+    if (auto* number = std::get_if<double>(&value)) {
+      return fmt::format("{}", *number);
+    }
+    if (auto* boolean = std::get_if<bool>(&value)) {
+      return *boolean ? "true" : "false";
+    }
+    if (auto* string = std::get_if<const Symbol*>(&value)) {
+      return std::string((*string)->text);
+    }
+    return "nil";
   }
 
   [[gnu::always_inline]] std::string VisitLogicalExpr(
-      const Logical<T, U>& expr) const override {
+      const Logical& expr) override {
     return Parenthesize(expr.GetOperator()->lexeme, *expr.GetLeft(),
                         *expr.GetRight());
   }
 
-  [[gnu::always_inline]] std::string VisitSetExpr(
-      const Set<T, U>& expr) const override {
+  [[gnu::always_inline]] std::string VisitSetExpr(const Set& expr) override {
     return Parenthesize("=", *expr.GetObject(), expr.GetName()->lexeme,
                         *expr.GetValue());
   }
 
   [[gnu::always_inline]] std::string VisitSuperExpr(
-      const Super<T, U>& expr) const override {
+      const Super& expr) override {
     return Parenthesize("super", *expr.GetMethod());
   }
 
   [[gnu::always_inline]] std::string VisitThisExpr(
-      [[maybe_unused]] const This<T, U>& expr) const override {
+      [[maybe_unused]] const This& expr) override {
     return "this";
   }
 
   [[gnu::always_inline]] std::string VisitUnaryExpr(
-      const Unary<T, U>& expr) const override {
+      const Unary& expr) override {
     return Parenthesize(expr.GetOperator()->lexeme, *expr.GetRight());
   }
 
   [[gnu::always_inline]] std::string VisitVariableExpr(
-      const Variable<T, U>& expr) const override {
-    return expr.GetName()->lexeme;
+      const Variable& expr) override {
+    return std::string(expr.GetName()->lexeme);
   }
 };
 
-#endif
\ No newline at end of file
+#endif
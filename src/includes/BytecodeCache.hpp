@@ -0,0 +1,66 @@
+#ifndef BYTECODE_CACHE_HPP
+#define BYTECODE_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "Heap.hpp"
+#include "Object.hpp"
+
+// Compiled scripts kept on disk between runs, so a script that has not
+// changed since it was last compiled starts without being scanned, parsed
+// or compiled again. Each script is one `.loxc` file in the cache
+// directory, named after the hash of its source. A header records that
+// hash, the source's size and the compiler's version, and a hash of the
+// rest of the file; a file whose header does not match is ignored, and
+// replaced the next time the script is compiled.
+//
+// The file holds every function of the script front to back: its name,
+// arity, upvalue and cache counts, code, line table and constants, with
+// nested functions written in place of the constant that refers to them.
+// Strings are stored as text and interned again on load.
+class BytecodeCache {
+ public:
+  // Bump whenever the compiler's output changes in a way the opcode table
+  // does not show
+  static constexpr uint32_t FORMAT_VERSION = 1;
+
+  explicit BytecodeCache(std::string directory)
+      : _directory(std::move(directory)) {}
+  ~BytecodeCache() = default;
+
+  // No copy
+  BytecodeCache(const BytecodeCache &) = delete;
+  BytecodeCache &operator=(const BytecodeCache &) = delete;
+
+  // No move
+  BytecodeCache(BytecodeCache &&) = delete;
+  BytecodeCache &operator=(BytecodeCache &&) = delete;
+
+  // Changes with FORMAT_VERSION and with the opcode table
+  static uint64_t CompilerVersion();
+
+  // Where the script with this source is cached
+  std::string PathFor(std::string_view source) const;
+
+  // The cached script for `source`, made on `heap`, or nullptr if there is
+  // no valid one. Call it through VM::Load(), which keeps the script being
+  // loaded alive.
+  ObjProto *Load(std::string_view source, Heap &heap);
+
+  // Writes `script`, the compiled `source`, to the cache. Another process
+  // may be doing the same: the file is written aside and renamed into
+  // place. False if it could not be written, which only costs the next run
+  // its warm start.
+  bool Store(std::string_view source, const ObjProto &script) const;
+
+  // The script being loaded
+  void MarkRoots(Heap &heap) const { heap.Mark(_loading); }
+
+ private:
+  std::string _directory;
+  ObjProto *_loading = nullptr;
+};
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef CHUNK_HPP
+#define CHUNK_HPP
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Value.hpp"
+
+// Every opcode, in encoding order. Operands follow the opcode byte:
+//   [c16] constant pool index, [s8] stack slot or upvalue index,
+//   [j16] unsigned jump distance, [n8] argument count, [i16] index of the
+//   site's inline cache in its ObjProto.
+// Kept as one list so the VM's dispatch table cannot drift from the enum.
+#define CPPLOX_OPCODES(X)                                                  \
+  X(CONSTANT)      /* [c16] push constant */                              \
+  X(NIL)                                                                   \
+  X(TRUE)                                                                  \
+  X(FALSE)                                                                 \
+  X(POP)                                                                   \
+  X(GET_LOCAL)     /* [s8] */                                             \
+  X(SET_LOCAL)     /* [s8] */                                             \
+  X(GET_GLOBAL)    /* [c16] name */                                       \
+  X(DEFINE_GLOBAL) /* [c16] name */                                       \
+  X(SET_GLOBAL)    /* [c16] name */                                       \
+  X(GET_UPVALUE)   /* [s8] */                                             \
+  X(SET_UPVALUE)   /* [s8] */                                             \
+  X(GET_PROPERTY)  /* [c16] name, [i16] */                                \
+  X(SET_PROPERTY)  /* [c16] name, [i16] */                                \
+  X(GET_SUPER)     /* [c16] name */                                       \
+  X(EQUAL)                                                                 \
+  X(NOT_EQUAL)                                                             \
+  X(GREATER)                                                               \
+  X(GREATER_EQUAL)                                                         \
+  X(LESS)                                                                  \
+  X(LESS_EQUAL)                                                            \
+  X(ADD)                                                                   \
+  X(SUBTRACT)                                                              \
+  X(MULTIPLY)                                                              \
+  X(DIVIDE)                                                                \
+  X(NOT)                                                                   \
+  X(NEGATE)                                                                \
+  X(PRINT)                                                                 \
+  X(JUMP)          /* [j16] forwards */                                   \
+  X(JUMP_IF_FALSE) /* [j16] forwards, leaves the condition */             \
+  X(LOOP)          /* [j16] backwards */                                  \
+  X(CALL)          /* [n8] [i16] */                                       \
+  X(GET_METHOD)    /* [c16] name, [i16] before the arguments */           \
+  X(SUPER_METHOD)  /* [c16] name, [i16] before the arguments */           \
+  X(INVOKE)        /* [n8] after either of the above */                   \
+  X(CLOSURE)       /* [c16] proto, then [local8 index8] per upvalue */    \
+  X(CLOSE_UPVALUE)                                                         \
+  X(RETURN)                                                                \
+  X(CLASS)         /* [c16] name */                                       \
+  X(INHERIT)                                                               \
+  X(METHOD)        /* [c16] name */
+
+enum class OpCode : uint8_t {
+#define CPPLOX_OPCODE_ENUM(name) name,
+  CPPLOX_OPCODES(CPPLOX_OPCODE_ENUM)
+#undef CPPLOX_OPCODE_ENUM
+};
+
+// Bytecode of one function with its constant pool. Source lines are kept
+// run-length encoded: one entry per run of bytes from the same line.
+class Chunk {
+ public:
+  // The instructions from `offset` up to the next run come from `line`
+  struct LineRun {
+    uint32_t offset;
+    uint32_t line;
+  };
+
+  Chunk() = default;
+
+  // No copy
+  Chunk(const Chunk &) = delete;
+  Chunk &operator=(const Chunk &) = delete;
+
+  [[gnu::always_inline]] void Write(uint8_t byte, uint32_t line) {
+    if (_lines.empty() || _lines.back().line != line) {
+      _lines.push_back({static_cast<uint32_t>(_code.size()), line});
+    }
+    _code.push_back(byte);
+  }
+
+  [[gnu::always_inline]] void Write(OpCode op, uint32_t line) {
+    Write(static_cast<uint8_t>(op), line);
+  }
+
+  // Index of `value` in the pool, reusing an identical number or object
+  size_t AddConstant(Value value);
+
+  // Line of the instruction starting at `offset`
+  uint32_t GetLine(size_t offset) const;
+
+  [[gnu::always_inline]] size_t Size() const { return _code.size(); }
+
+  [[gnu::always_inline]] const uint8_t *Code() const { return _code.data(); }
+
+  [[gnu::always_inline]] uint8_t &At(size_t offset) { return _code[offset]; }
+
+  [[gnu::always_inline]] const std::vector<Value> &Constants() const {
+    return _constants;
+  }
+
+  [[gnu::always_inline]] const std::vector<LineRun> &Lines() const {
+    return _lines;
+  }
+
+  // Bytes used by code, constants and the line table
+  size_t MemoryUsage() const;
+
+ private:
+  std::vector<uint8_t> _code;
+  std::vector<Value> _constants;
+  std::vector<LineRun> _lines;
+  // Pool position of each constant, by its bits
+  std::unordered_map<uint64_t, size_t> _constant_index;
+};
+
+#endif
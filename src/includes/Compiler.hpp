@@ -0,0 +1,173 @@
+#ifndef COMPILER_HPP
+#define COMPILER_HPP
+
+#include <robin_hood.h>
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Chunk.hpp"
+#include "Error.hpp"
+#include "Expr.hpp"
+#include "Heap.hpp"
+#include "Object.hpp"
+#include "Stmt.hpp"
+
+// Lowers a parsed program to bytecode for the VM. Locals are resolved to
+// stack slots and captured variables to upvalues while compiling, so the
+// VM never looks a local up by name. Constants (strings, names, nested
+// functions) are allocated on `heap`, which the VM running the result
+// has to share. A global that neither the program nor `globals` (the ones
+// earlier programs defined) declares is reported before anything runs.
+class Compiler : public Expr::Visitor<void>, public Stmt::Visitor<void> {
+ public:
+  using Globals =
+      robin_hood::unordered_flat_map<const Symbol*, Value, SymbolHash>;
+
+  Compiler(Heap& heap, Error& error, const Globals& globals)
+      : _heap(heap), _error(error), _globals(globals) {}
+
+  // No copy
+  Compiler(const Compiler&) = delete;
+  Compiler& operator=(const Compiler&) = delete;
+
+  // The top-level script as a function of no arguments, or nullptr after
+  // reporting a compile error
+  ObjProto* Compile(StmtList statements);
+
+  // The functions still being compiled are not referenced from anywhere
+  // else yet
+  void MarkRoots(Heap& heap) const;
+
+ private:
+  enum class FunctionKind : uint8_t { SCRIPT, FUNCTION, METHOD, INITIALIZER };
+
+  struct Local {
+    std::string_view name;
+    // -1 while the variable's initializer is being compiled
+    int depth;
+    bool captured;
+  };
+
+  struct UpvalueRef {
+    uint8_t index;
+    bool is_local;
+  };
+
+  // One per function being compiled, innermost last
+  struct FunctionState {
+    FunctionState(ObjProto* in_proto, FunctionKind in_kind)
+        : proto(in_proto), kind(in_kind) {}
+
+    ObjProto* proto;
+    FunctionKind kind;
+    std::vector<Local> locals;
+    std::vector<UpvalueRef> upvalues;
+    int scope_depth = 0;
+    // Constant pool index of each identifier used in this function
+    std::unordered_map<std::string_view, uint16_t> names;
+  };
+
+  struct ClassState {
+    bool has_superclass = false;
+  };
+
+  [[gnu::always_inline]] FunctionState& Current() { return _functions.back(); }
+
+  [[gnu::always_inline]] Chunk& CurrentChunk() {
+    return Current().proto->GetChunk();
+  }
+
+  // Instructions are tagged with `_line`, the line of the last token the
+  // compiler looked at
+  [[gnu::always_inline]] void Emit(OpCode op) {
+    CurrentChunk().Write(op, _line);
+  }
+
+  [[gnu::always_inline]] void EmitByte(uint8_t byte) {
+    CurrentChunk().Write(byte, _line);
+  }
+
+  void EmitShort(uint16_t value);
+  void EmitConstant(Value value);
+  void EmitReturn();
+  size_t EmitJump(OpCode op);
+  void PatchJump(size_t offset);
+  void EmitLoop(size_t loop_start);
+
+  uint16_t MakeConstant(Value value);
+  uint16_t NameConstant(const Token<>& name);
+  // A fresh inline cache in the current function, for one site
+  uint16_t MakeCache();
+
+  void CompileFunction(const Function& function, FunctionKind kind);
+
+  void BeginScope() { Current().scope_depth++; }
+  void EndScope();
+  void DeclareVariable(const Token<>& name);
+  void AddLocal(std::string_view name);
+  void MarkInitialized();
+  void DefineVariable(const Token<>& name);
+  void NamedVariable(const Token<>& name, bool assign);
+  // Calls of a method straight off its receiver
+  void Invoke(const Get& get, const Call& call);
+  void SuperInvoke(const Super& super, const Call& call);
+  // Pushes the call's arguments over the looked-up method and calls it
+  void InvokeWith(const Call& call);
+  // Reports a misplaced `super`; false if it was one
+  bool CheckSuper(const Token<>& keyword);
+
+  int ResolveLocal(FunctionState& function, const Token<>& name);
+  int ResolveUpvalue(size_t function, const Token<>& name);
+  int AddUpvalue(size_t function, uint8_t index, bool is_local);
+
+  // Report without unwinding; the rest of the program is still compiled.
+  // Limits that have no token at hand are reported at `_line`.
+  void ErrorAt(const Token<>& token, const std::string& message);
+  void ErrorAtLine(const std::string& message);
+
+  [[gnu::always_inline]] void Compile(const Expr* expr) { expr->Accept(*this); }
+
+  [[gnu::always_inline]] void Compile(const Stmt* stmt) { stmt->Accept(*this); }
+
+  void VisitAssignExpr(const Assign& expr) override;
+  void VisitBinaryExpr(const Binary& expr) override;
+  void VisitCallExpr(const Call& expr) override;
+  void VisitGetExpr(const Get& expr) override;
+  void VisitGroupingExpr(const Grouping& expr) override;
+  void VisitLiteralExpr(const Literal& expr) override;
+  void VisitLogicalExpr(const Logical& expr) override;
+  void VisitSetExpr(const Set& expr) override;
+  void VisitSuperExpr(const Super& expr) override;
+  void VisitThisExpr(const This& expr) override;
+  void VisitUnaryExpr(const Unary& expr) override;
+  void VisitVariableExpr(const Variable& expr) override;
+
+  void VisitBlockStmt(const Block& stmt) override;
+  void VisitClassStmt(const Class& stmt) override;
+  void VisitExpressionStmt(const Expression& stmt) override;
+  void VisitFunctionStmt(const Function& stmt) override;
+  void VisitIfStmt(const If& stmt) override;
+  void VisitPrintStmt(const Print& stmt) override;
+  void VisitReturnStmt(const Return& stmt) override;
+  void VisitVarStmt(const Var& stmt) override;
+  void VisitWhileStmt(const While& stmt) override;
+
+  Heap& _heap;
+  Error& _error;
+  const Globals& _globals;
+  std::vector<FunctionState> _functions;
+  std::vector<ClassState> _classes;
+  uint32_t _line = 1;
+  bool _had_error = false;
+
+  // Globals this program declares, and every use of a global; the uses
+  // are checked once the whole program is compiled
+  std::unordered_set<std::string_view> _declared_globals;
+  std::vector<const Token<>*> _global_uses;
+};
+
+#endif
@@ -4,22 +4,35 @@
 #include <iostream>
 #include <string>
 
+// Collects the diagnostics of one script. Each run owns its own reporter,
+// so scripts checked side by side don't share an error flag; `out` can be a
+// string stream when diagnostics have to be buffered and printed later.
 class Error {
  public:
   Error() = default;
+  explicit Error(std::ostream &out) : _out(&out) {}
   ~Error() = default;
-  [[gnu::always_inline]] static void Report(unsigned int line,
-                                            const std::string &where,
-                                            const std::string &message) {
-    std::cerr << "[line " << line << "] Error" << where << ": " << message
-              << std::endl;
+  [[gnu::always_inline]] void Report(unsigned int line,
+                                     const std::string &where,
+                                     const std::string &message) {
+    *_out << "[line " << line << "] Error" << where << ": " << message
+          << std::endl;
     had_error = true;
   }
-  [[gnu::always_inline]] static void SendError(unsigned int line,
-                                               const std::string &message) {
+  [[gnu::always_inline]] void SendError(unsigned int line,
+                                        const std::string &message) {
     Report(line, "", message);
   }
-  inline static bool had_error = false;
+  [[gnu::always_inline]] void RuntimeError(unsigned int line,
+                                           const std::string &message) {
+    *_out << message << "\n[line " << line << "]" << std::endl;
+    had_runtime_error = true;
+  }
+  bool had_error = false;
+  bool had_runtime_error = false;
+
+ private:
+  std::ostream *_out = &std::cerr;
 };
 
-#endif
\ No newline at end of file
+#endif
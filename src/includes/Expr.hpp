@@ -1,402 +1,376 @@
 #ifndef EXPR_HPP
 #define EXPR_HPP
 
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <variant>
+
+#include "InlineCache.hpp"
+#include "Interner.hpp"
 #include "Token.hpp"
 
+// Nodes live in an Arena and are never destroyed one by one, so every node
+// has to stay trivially destructible: children are plain pointers into the
+// same arena and argument lists are arena spans.
+
 // Forward Declarations
-template <typename T, typename U>
 class Assign;
-template <typename T, typename U>
 class Binary;
-template <typename T, typename U>
 class Call;
-template <typename T, typename U>
 class Get;
-template <typename T, typename U>
 class Grouping;
-template <typename T, typename U>
 class Literal;
-template <typename T, typename U>
 class Logical;
-template <typename T, typename U>
 class Set;
-template <typename T, typename U>
 class Super;
-template <typename T, typename U>
 class This;
-template <typename T, typename U>
 class Unary;
-template <typename T, typename U>
 class Variable;
 
 // ------------- EXPR CLASS -------------
-template <typename T, typename U>
 class Expr {
  public:
+  enum class Kind : uint8_t {
+    ASSIGN,
+    BINARY,
+    CALL,
+    GET,
+    GROUPING,
+    LITERAL,
+    LOGICAL,
+    SET,
+    SUPER,
+    THIS,
+    UNARY,
+    VARIABLE
+  };
+
+  template <typename R>
   class Visitor {
    public:
-    virtual T VisitAssignExpr(const Assign<T, U>& expr) const = 0;
-    virtual T VisitBinaryExpr(const Binary<T, U>& expr) const = 0;
-    virtual T VisitCallExpr(const Call<T, U>& expr) const = 0;
-    virtual T VisitGetExpr(const Get<T, U>& expr) const = 0;
-    virtual T VisitGroupingExpr(const Grouping<T, U>& expr) const = 0;
-    virtual T VisitLiteralExpr(const Literal<T, U>& expr) const = 0;
-    virtual T VisitLogicalExpr(const Logical<T, U>& expr) const = 0;
-    virtual T VisitSetExpr(const Set<T, U>& expr) const = 0;
-    virtual T VisitSuperExpr(const Super<T, U>& expr) const = 0;
-    virtual T VisitThisExpr(const This<T, U>& expr) const = 0;
-    virtual T VisitUnaryExpr(const Unary<T, U>& expr) const = 0;
-    virtual T VisitVariableExpr(const Variable<T, U>& expr) const = 0;
+    virtual R VisitAssignExpr(const Assign& expr) = 0;
+    virtual R VisitBinaryExpr(const Binary& expr) = 0;
+    virtual R VisitCallExpr(const Call& expr) = 0;
+    virtual R VisitGetExpr(const Get& expr) = 0;
+    virtual R VisitGroupingExpr(const Grouping& expr) = 0;
+    virtual R VisitLiteralExpr(const Literal& expr) = 0;
+    virtual R VisitLogicalExpr(const Logical& expr) = 0;
+    virtual R VisitSetExpr(const Set& expr) = 0;
+    virtual R VisitSuperExpr(const Super& expr) = 0;
+    virtual R VisitThisExpr(const This& expr) = 0;
+    virtual R VisitUnaryExpr(const Unary& expr) = 0;
+    virtual R VisitVariableExpr(const Variable& expr) = 0;
+
+   protected:
+    ~Visitor() = default;
   };
 
-  virtual ~Expr() = default;
-  virtual std::unique_ptr<Expr> Clone() = 0;
-  virtual T Accept(const Visitor& visitor) const = 0;
+  // Dispatches on the kind tag, so nodes need no vtable
+  template <typename R>
+  R Accept(Visitor<R>& visitor) const;
+
+  [[gnu::always_inline]] Kind GetKind() const { return _kind; }
+
+  // No copy
+  Expr(const Expr&) = delete;
+  Expr& operator=(const Expr&) = delete;
+
+ protected:
+  explicit Expr(Kind kind) noexcept : _kind(kind) {}
+  Expr(Expr&& other) noexcept = default;
+  ~Expr() = default;
+
+ private:
+  Kind _kind;
 };
 
-template <typename T, typename U>
-using PtrVecExpr = std::vector<std::unique_ptr<Expr<T, U>>>;
+using ExprList = std::span<const Expr* const>;
+// Strings are interned, so equal strings compare equal as pointers
+using LiteralValue =
+    std::variant<std::nullptr_t, bool, double, const Symbol*>;
+
+// Where a name lives at run time, worked out by the Resolver: the local
+// `index` in the environment `depth` hops out from the innermost one, or
+// entry `index` of the global table. Nodes that refer to variables keep
+// one. Apart from the inline caches of Get, Set and Call sites, it is the
+// only part of a node written after parsing.
+struct Slot {
+  static constexpr uint32_t GLOBAL = UINT32_MAX;
+
+  uint32_t depth = GLOBAL;
+  uint32_t index = 0;
+
+  [[gnu::always_inline]] bool IsGlobal() const { return depth == GLOBAL; }
+};
 
 // ------------- ASSIGN CLASS -------------
-template <typename T, typename U>
-class Assign : virtual public Expr<T, U> {
+class Assign : public Expr {
  public:
-  Assign(Token<U>& name, Expr<T, U>& value) noexcept;
+  Assign(Token<>&& name, const Expr* value) noexcept;
   Assign(Assign&& other) noexcept;
 
-  [[gnu::always_inline]] T Accept(
-      const typename Expr<T, U>::Visitor& visitor) const override {
-    return visitor.VisitAssignExpr(*this);
-  }
+  [[gnu::always_inline]] const Token<>* GetName() const { return &_name; }
 
-  [[gnu::always_inline]] std::unique_ptr<Expr<T, U>> Clone() override {
-    return std::make_unique<Assign<T, U>>(*_value, *_name);
-  }
+  [[gnu::always_inline]] const Expr* GetValue() const { return _value; }
 
-  [[gnu::always_inline]] const Token<U>* GetName() const { return _name.get(); }
+  [[gnu::always_inline]] Slot GetSlot() const { return _slot; }
 
-  [[gnu::always_inline]] const Expr<T, U>* GetValue() const {
-    return _value.get();
-  }
+  [[gnu::always_inline]] void Resolve(Slot slot) const { _slot = slot; }
 
  private:
-  std::unique_ptr<Expr<T, U>> _value;
-  std::unique_ptr<Token<U>> _name;
+  const Expr* _value;
+  Token<> _name;
+  mutable Slot _slot;
 };
 
 // ------------- BINARY CLASS -------------
-template <typename T, typename U>
-class Binary : virtual public Expr<T, U> {
+class Binary : public Expr {
  public:
-  Binary(Expr<T, U>& left, Token<U>& oper, Expr<T, U>& right) noexcept;
+  Binary(const Expr* left, Token<>&& oper, const Expr* right) noexcept;
   Binary(Binary&& other) noexcept;
 
-  [[gnu::always_inline]] T Accept(
-      const typename Expr<T, U>::Visitor& visitor) const override {
-    return visitor.VisitBinaryExpr(*this);
+  [[gnu::always_inline]] const Token<>* GetOperator() const {
+    return &_operator;
   }
 
-  [[gnu::always_inline]] std::unique_ptr<Expr<T, U>> Clone() override {
-    return std::make_unique<Binary<T, U>>(*_left, *_operator, *_right);
-  }
-
-  [[gnu::always_inline]] const Token<U>* GetOperator() const {
-    return _operator.get();
-  }
-
-  [[gnu::always_inline]] const Expr<T, U>* GetLeft() const {
-    return _left.get();
-  }
+  [[gnu::always_inline]] const Expr* GetLeft() const { return _left; }
 
-  [[gnu::always_inline]] const Expr<T, U>* GetRight() const {
-    return _right.get();
-  }
+  [[gnu::always_inline]] const Expr* GetRight() const { return _right; }
 
  private:
-  std::unique_ptr<Expr<T, U>> _left;
-  std::unique_ptr<Token<U>> _operator;
-  std::unique_ptr<Expr<T, U>> _right;
+  const Expr* _left;
+  Token<> _operator;
+  const Expr* _right;
 };
 
 // ------------- CALL CLASS -------------
-template <typename T, typename U>
-class Call : public Expr<T, U> {
+class Call : public Expr {
  public:
-  Call(Expr<T, U>& callee, Token<U>& paren,
-       PtrVecExpr<T, U>& arguments) noexcept;
+  Call(const Expr* callee, Token<>&& paren, ExprList arguments) noexcept;
   Call(Call&& other) noexcept;
 
-  [[gnu::always_inline]] T Accept(
-      const typename Expr<T, U>::Visitor& visitor) const override {
-    return visitor.VisitCallExpr(*this);
-  }
-
-  [[gnu::always_inline]] std::unique_ptr<Expr<T, U>> Clone() override {
-    return std::make_unique<Call<T, U>>(*_callee, *_paren, *_arguments);
-  }
+  [[gnu::always_inline]] const Expr* GetCallee() const { return _callee; }
 
-  [[gnu::always_inline]] const Expr<T, U>* GetCallee() const {
-    return _callee.get();
-  }
+  [[gnu::always_inline]] const Token<>* GetParen() const { return &_paren; }
 
-  [[gnu::always_inline]] const Token<U>* GetParen() const {
-    return _paren.get();
-  }
+  [[gnu::always_inline]] ExprList GetArgs() const { return _arguments; }
 
-  [[gnu::always_inline]] const PtrVecExpr<T, U>* GetArgs() const {
-    return _arguments.get();
-  }
+  // Where the tree-walker looks up `init` when the callee is a class
+  [[gnu::always_inline]] InlineCache& GetCache() const { return _cache; }
 
  private:
-  std::unique_ptr<Expr<T, U>> _callee;
-  std::unique_ptr<Token<U>> _paren;
-  std::unique_ptr<PtrVecExpr<T, U>> _arguments;
+  const Expr* _callee;
+  Token<> _paren;
+  ExprList _arguments;
+  mutable InlineCache _cache;
 };
 
 // ------------- GET CLASS -------------
-template <typename T, typename U>
-class Get : public Expr<T, U> {
+class Get : public Expr {
  public:
-  Get(Expr<T, U>& object, Token<U>& name) noexcept;
+  Get(const Expr* object, Token<>&& name, const Symbol* symbol) noexcept;
   Get(Get&& other) noexcept;
 
-  [[gnu::always_inline]] T Accept(
-      const typename Expr<T, U>::Visitor& visitor) const override {
-    return visitor.VisitGetExpr(*this);
-  }
+  [[gnu::always_inline]] const Expr* GetObject() const { return _object; }
 
-  [[gnu::always_inline]] std::unique_ptr<Expr<T, U>> Clone() override {
-    return std::make_unique<Get<T, U>>(*_object, *_name);
-  }
+  [[gnu::always_inline]] const Token<>* GetName() const { return &_name; }
 
-  [[gnu::always_inline]] const Expr<T, U>* GetObject() const {
-    return _object.get();
-  }
+  [[gnu::always_inline]] const Symbol* GetSymbol() const { return _symbol; }
 
-  [[gnu::always_inline]] const Token<U>* GetName() const { return _name.get(); }
+  // Where the tree-walker finds the field's slot, or else the method, for
+  // the shapes seen here
+  [[gnu::always_inline]] InlineCache& GetCache() const { return _cache; }
 
  private:
-  std::unique_ptr<Expr<T, U>> _object;
-  std::unique_ptr<Token<U>> _name;
+  const Expr* _object;
+  Token<> _name;
+  const Symbol* _symbol;
+  mutable InlineCache _cache;
 };
 
 // ------------- GROUPING CLASS -------------
-template <typename T, typename U>
-class Grouping : public Expr<T, U> {
+class Grouping : public Expr {
  public:
-  Grouping(Expr<T, U>& expression) noexcept;
+  explicit Grouping(const Expr* expression) noexcept;
   Grouping(Grouping&& other) noexcept;
 
-  [[gnu::always_inline]] T Accept(
-      const typename Expr<T, U>::Visitor& visitor) const override {
-    return visitor.VisitGroupingExpr(*this);
-  }
-
-  [[gnu::always_inline]] std::unique_ptr<Expr<T, U>> Clone() override {
-    return std::make_unique<Grouping<T, U>>(*_expression);
-  }
-
-  [[gnu::always_inline]] const Expr<T, U>* GetExpr() const {
-    return _expression.get();
-  }
+  [[gnu::always_inline]] const Expr* GetExpr() const { return _expression; }
 
  private:
-  std::unique_ptr<Expr<T, U>> _expression;
+  const Expr* _expression;
 };
 
 // ------------- LITERAL CLASS -------------
-template <typename T, typename U>
-class Literal : public Expr<T, U> {
+class Literal : public Expr {
  public:
-  Literal(T& value, size_t size) noexcept;
+  explicit Literal(LiteralValue value) noexcept;
   Literal(Literal&& other) noexcept;
 
-  [[gnu::always_inline]] T Accept(
-      const typename Expr<T, U>::Visitor& visitor) const override {
-    return visitor.VisitLiteralExpr(*this);
+  [[gnu::always_inline]] const LiteralValue& GetValue() const {
+    return _value;
   }
 
-  [[gnu::always_inline]] std::unique_ptr<Expr<T, U>> Clone() override {
-    return std::make_unique<Literal<T, U>>(*_value, _size);
-  }
-
-  [[gnu::always_inline]] T* GetValue() const { return _value.get(); }
-
-  [[gnu::always_inline]] size_t GetSize() const { return _size; }
-
  private:
-  std::unique_ptr<T> _value;
-  size_t _size;
+  LiteralValue _value;
 };
 
 // ------------- LOGICAL CLASS -------------
-template <typename T, typename U>
-class Logical : public Expr<T, U> {
+class Logical : public Expr {
  public:
-  Logical(Expr<T, U>& left, Token<U>& oper, Expr<T, U>& right) noexcept;
+  Logical(const Expr* left, Token<>&& oper, const Expr* right) noexcept;
   Logical(Logical&& other) noexcept;
 
-  [[gnu::always_inline]] T Accept(
-      const typename Expr<T, U>::Visitor& visitor) const override {
-    return visitor.VisitLogicalExpr(*this);
-  }
-
-  [[gnu::always_inline]] std::unique_ptr<Expr<T, U>> Clone() override {
-    return std::make_unique<Logical<T, U>>(*_left, *_operator, *_right);
-  }
-
-  [[gnu::always_inline]] const Expr<T, U>* GetLeft() const {
-    return _left.get();
-  }
+  [[gnu::always_inline]] const Expr* GetLeft() const { return _left; }
 
-  [[gnu::always_inline]] const Token<U>* GetOperator() const {
-    return _operator.get();
+  [[gnu::always_inline]] const Token<>* GetOperator() const {
+    return &_operator;
   }
 
-  [[gnu::always_inline]] const Expr<T, U>* GetRight() const {
-    return _right.get();
-  }
+  [[gnu::always_inline]] const Expr* GetRight() const { return _right; }
 
  private:
-  std::unique_ptr<Expr<T, U>> _left;
-  std::unique_ptr<Token<U>> _operator;
-  std::unique_ptr<Expr<T, U>> _right;
+  const Expr* _left;
+  Token<> _operator;
+  const Expr* _right;
 };
 
 // ------------- SET CLASS -------------
-template <typename T, typename U>
-class Set : public Expr<T, U> {
+class Set : public Expr {
  public:
-  Set(Expr<T, U>& object, Token<U>& name, Expr<T, U>& value) noexcept;
+  Set(const Expr* object, Token<>&& name, const Symbol* symbol,
+      const Expr* value) noexcept;
   Set(Set&& other) noexcept;
 
-  [[gnu::always_inline]] T Accept(
-      const typename Expr<T, U>::Visitor& visitor) const override {
-    return visitor.VisitSetExpr(*this);
-  }
+  [[gnu::always_inline]] const Expr* GetObject() const { return _object; }
 
-  [[gnu::always_inline]] std::unique_ptr<Expr<T, U>> Clone() override {
-    return std::make_unique<Set<T, U>>(std::move(*this));
-  }
+  [[gnu::always_inline]] const Token<>* GetName() const { return &_name; }
 
-  [[gnu::always_inline]] const Expr<T, U>* GetObject() const {
-    return _object.get();
-  }
+  [[gnu::always_inline]] const Symbol* GetSymbol() const { return _symbol; }
 
-  [[gnu::always_inline]] const Token<U>* GetName() const { return _name.get(); }
+  [[gnu::always_inline]] const Expr* GetValue() const { return _value; }
 
-  [[gnu::always_inline]] const Expr<T, U>* GetValue() const {
-    return _value.get();
-  }
+  // Where the tree-walker finds the field's slot, or the shape that adding
+  // it moves to, for the shapes seen here
+  [[gnu::always_inline]] InlineCache& GetCache() const { return _cache; }
 
  private:
-  std::unique_ptr<Expr<T, U>> _object;
-  std::unique_ptr<Token<U>> _name;
-  std::unique_ptr<Expr<T, U>> _value;
+  const Expr* _object;
+  Token<> _name;
+  const Symbol* _symbol;
+  const Expr* _value;
+  mutable InlineCache _cache;
 };
 
 // ------------- SUPER CLASS -------------
-template <typename T, typename U>
-class Super : public Expr<T, U> {
+class Super : public Expr {
  public:
-  Super(Token<U>& keyword, Token<U>& method) noexcept;
+  Super(Token<>&& keyword, Token<>&& method, const Symbol* symbol) noexcept;
   Super(Super&& other) noexcept;
 
-  [[gnu::always_inline]] T Accept(
-      const typename Expr<T, U>::Visitor& visitor) const override {
-    return visitor.VisitSuperExpr(*this);
+  [[gnu::always_inline]] const Token<>* GetKeyword() const {
+    return &_keyword;
   }
 
-  [[gnu::always_inline]] std::unique_ptr<Expr<T, U>> Clone() override {
-    return std::make_unique<Super<T, U>>(std::move(*this));
-  }
+  [[gnu::always_inline]] const Token<>* GetMethod() const { return &_method; }
 
-  [[gnu::always_inline]] const Token<U>* GetKeyword() const {
-    return _keyword.get();
-  }
+  [[gnu::always_inline]] const Symbol* GetSymbol() const { return _symbol; }
 
-  [[gnu::always_inline]] const Token<U>* GetMethod() const {
-    return _method.get();
-  }
+  // Where `super` lives; `this` is always one environment closer
+  [[gnu::always_inline]] Slot GetSlot() const { return _slot; }
+
+  [[gnu::always_inline]] void Resolve(Slot slot) const { _slot = slot; }
 
  private:
-  std::unique_ptr<Token<U>> _keyword;
-  std::unique_ptr<Token<U>> _method;
+  Token<> _keyword;
+  Token<> _method;
+  const Symbol* _symbol;
+  mutable Slot _slot;
 };
 
 // ------------- THIS CLASS -------------
-template <typename T, typename U>
-class This : public Expr<T, U> {
+class This : public Expr {
  public:
-  This(Token<U>& keyword) noexcept;
+  explicit This(Token<>&& keyword) noexcept;
   This(This&& other) noexcept;
 
-  [[gnu::always_inline]] T Accept(
-      const typename Expr<T, U>::Visitor& visitor) const override {
-    return visitor.VisitThisExpr(*this);
+  [[gnu::always_inline]] const Token<>* GetKeyword() const {
+    return &_keyword;
   }
 
-  [[gnu::always_inline]] std::unique_ptr<Expr<T, U>> Clone() override {
-    return std::make_unique<This<T, U>>(std::move(*this));
-  }
+  [[gnu::always_inline]] Slot GetSlot() const { return _slot; }
 
-  [[gnu::always_inline]] const Token<U>* GetKeyword() const {
-    return _keyword.get();
-  }
+  [[gnu::always_inline]] void Resolve(Slot slot) const { _slot = slot; }
 
  private:
-  std::unique_ptr<Token<U>> _keyword;
+  Token<> _keyword;
+  mutable Slot _slot;
 };
 
 // ------------- UNARY CLASS -------------
-template <typename T, typename U>
-class Unary : public Expr<T, U> {
+class Unary : public Expr {
  public:
-  Unary(Token<U>& oper, Expr<T, U>& right) noexcept;
+  Unary(Token<>&& oper, const Expr* right) noexcept;
   Unary(Unary&& other) noexcept;
 
-  [[gnu::always_inline]] T Accept(
-      const typename Expr<T, U>::Visitor& visitor) const override {
-    return visitor.VisitUnaryExpr(*this);
+  [[gnu::always_inline]] const Token<>* GetOperator() const {
+    return &_operator;
   }
 
-  [[gnu::always_inline]] std::unique_ptr<Expr<T, U>> Clone() override {
-    return std::make_unique<Unary<T, U>>(std::move(*this));
-  }
-
-  [[gnu::always_inline]] const Token<U>* GetOperator() const {
-    return _operator.get();
-  }
-
-  [[gnu::always_inline]] const Expr<T, U>* GetRight() const {
-    return _right.get();
-  }
+  [[gnu::always_inline]] const Expr* GetRight() const { return _right; }
 
  private:
-  std::unique_ptr<const Token<U>> _operator;
-  std::unique_ptr<const Expr<T, U>> _right;
+  Token<> _operator;
+  const Expr* _right;
 };
 
 // ------------- VARIABLE CLASS -------------
-template <typename T, typename U>
-class Variable : public Expr<T, U> {
+class Variable : public Expr {
  public:
-  Variable(Token<U>& name) noexcept;
+  explicit Variable(Token<>&& name) noexcept;
   Variable(Variable&& other) noexcept;
 
-  [[gnu::always_inline]] T Accept(
-      const typename Expr<T, U>::Visitor& visitor) const override {
-    return visitor.VisitVariableExpr(*this);
-  }
+  [[gnu::always_inline]] const Token<>* GetName() const { return &_name; }
 
-  [[gnu::always_inline]] std::unique_ptr<Expr<T, U>> Clone() override {
-    return std::make_unique<Variable<T, U>>(std::move(*this));
-  }
+  [[gnu::always_inline]] Slot GetSlot() const { return _slot; }
 
-  [[gnu::always_inline]] const Token<U>* GetName() const { return _name.get(); }
+  [[gnu::always_inline]] void Resolve(Slot slot) const { _slot = slot; }
 
  private:
-  std::unique_ptr<Token<U>> _name;
+  Token<> _name;
+  mutable Slot _slot;
 };
 
-#endif
\ No newline at end of file
+// ------------- DISPATCH -------------
+template <typename R>
+[[gnu::always_inline]] inline R Expr::Accept(Visitor<R>& visitor) const {
+  switch (_kind) {
+    case Kind::ASSIGN:
+      return visitor.VisitAssignExpr(static_cast<const Assign&>(*this));
+    case Kind::BINARY:
+      return visitor.VisitBinaryExpr(static_cast<const Binary&>(*this));
+    case Kind::CALL:
+      return visitor.VisitCallExpr(static_cast<const Call&>(*this));
+    case Kind::GET:
+      return visitor.VisitGetExpr(static_cast<const Get&>(*this));
+    case Kind::GROUPING:
+      return visitor.VisitGroupingExpr(static_cast<const Grouping&>(*this));
+    case Kind::LITERAL:
+      return visitor.VisitLiteralExpr(static_cast<const Literal&>(*this));
+    case Kind::LOGICAL:
+      return visitor.VisitLogicalExpr(static_cast<const Logical&>(*this));
+    case Kind::SET:
+      return visitor.VisitSetExpr(static_cast<const Set&>(*this));
+    case Kind::SUPER:
+      return visitor.VisitSuperExpr(static_cast<const Super&>(*this));
+    case Kind::THIS:
+      return visitor.VisitThisExpr(static_cast<const This&>(*this));
+    case Kind::UNARY:
+      return visitor.VisitUnaryExpr(static_cast<const Unary&>(*this));
+    case Kind::VARIABLE:
+      return visitor.VisitVariableExpr(static_cast<const Variable&>(*this));
+  }
+  __builtin_unreachable();
+}
+
+#endif
@@ -0,0 +1,212 @@
+#ifndef HEAP_HPP
+#define HEAP_HPP
+
+#include <robin_hood.h>
+
+#include <chrono>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "Object.hpp"
+
+// Owns every runtime object of one interpreter. Objects are threaded onto
+// an intrusive list as they are made and reclaimed by a precise
+// mark-and-sweep collector: everything reachable from the owner's roots
+// survives a collection, everything else is freed.
+//
+// GC work may run at the end of any Make(), once the heap has grown to a
+// multiple of what was live after the previous collection. The object just
+// made is always kept, and so is everything it references, so passing
+// unrooted objects to a constructor is safe; any other object the owner
+// holds only in a C++ local has to be reachable from its roots before the
+// next Make().
+//
+// By default a collection stops the world. With a pause target set, it is
+// incremental instead: tri-color marking and then sweeping advance in
+// slices of about that long, interleaved with allocation. Marked objects
+// are black once traced and gray while queued; the rest are white. While
+// marking, the owner has to call WriteBarrier() whenever it stores a
+// reference into a heap object, so a black object never points at a white
+// one. Roots are not barriered: they are scanned again, along with
+// whatever they lead to, in a final atomic step before sweeping.
+class Heap {
+ public:
+  // Implemented by the heap's owner: marks every object it references
+  // directly (stacks, globals, the current environment...)
+  class Roots {
+   public:
+    virtual void MarkRoots(Heap& heap) = 0;
+
+   protected:
+    ~Roots() = default;
+  };
+
+  struct Stats {
+    size_t collections = 0;
+    size_t objects_freed = 0;
+    size_t bytes_freed = 0;
+    size_t objects_allocated = 0;
+    // Bound methods never made, for methods called straight off their
+    // receiver
+    size_t allocations_elided = 0;
+    // Whole collections, or incremental slices
+    size_t pause_count = 0;
+    std::chrono::nanoseconds total_pause{0};
+    std::chrono::nanoseconds max_pause{0};
+    // Every pause, in order, but only while SetRecordPauses() is on: a
+    // long session would otherwise grow it without bound
+    std::vector<std::chrono::nanoseconds> pauses;
+
+    // The pause that `fraction` of the recorded pauses are no longer than
+    std::chrono::nanoseconds Percentile(double fraction) const;
+  };
+
+  Heap() = default;
+  ~Heap();
+
+  // No copy
+  Heap(const Heap&) = delete;
+  Heap& operator=(const Heap&) = delete;
+
+  // No move
+  Heap(Heap&&) = delete;
+  Heap& operator=(Heap&&) = delete;
+
+  template <typename T, typename... Args>
+  T* Make(Args&&... args) {
+    T* object = new T(std::forward<Args>(args)...);
+    object->_next = _objects;
+    _objects = object;
+    _count++;
+    _stats.objects_allocated++;
+    _bytes_allocated += SizeOf(object);
+
+    if (_roots != nullptr && (_stress || _bytes_allocated > _next_gc)) {
+      Advance(object);
+    }
+    return object;
+  }
+
+  // The heap's string for `symbol`, made the first time it is asked for.
+  // Literals and names therefore share one object per distinct text; the
+  // table does not keep strings alive.
+  ObjString* Intern(const Symbol* symbol) {
+    auto found = _strings.find(symbol);
+    if (found != _strings.end()) {
+      return found->second;
+    }
+    // Made before it is entered: making it may collect, which prunes the
+    // table
+    ObjString* string = Make<ObjString>(symbol);
+    _strings.emplace(symbol, string);
+    return string;
+  }
+
+  // Nothing is collected until the owner registers its roots
+  void SetRoots(Roots* roots) { _roots = roots; }
+
+  // Do GC work on every allocation, to catch objects that are not rooted
+  // and stores that miss their barrier: a whole collection each time, or
+  // the smallest incremental slice
+  void SetStressMode(bool stress) { _stress = stress; }
+
+  // Zero, the default, collects stop-the-world; anything else makes
+  // collections incremental, in slices of about `pause`
+  void SetMaxPause(std::chrono::nanoseconds pause) { _max_pause = pause; }
+
+  // Keeps every pause in Stats::pauses, for percentiles; off by default,
+  // when only the count, total and maximum are kept
+  void SetRecordPauses(bool record) { _record_pauses = record; }
+
+  // Runs a full collection now, keeping `keep` and what it references. A
+  // cycle already in progress is finished first. Does nothing before
+  // SetRoots().
+  void Collect(Obj* keep = nullptr);
+
+  [[gnu::always_inline]] void Mark(Value value) {
+    if (value.IsObject()) Mark(value.AsObject());
+  }
+
+  [[gnu::always_inline]] void Mark(Obj* object) {
+    if (object == nullptr || object->_marked) return;
+    object->_marked = true;
+    _gray.push_back(object);
+  }
+
+  // `holder` now references `value`. Shading the value keeps a traced
+  // holder from hiding it from the marker.
+  [[gnu::always_inline]] void WriteBarrier(Obj* holder, Value value) {
+    if (_phase == Phase::MARKING && holder->_marked) Mark(value);
+  }
+
+  [[gnu::always_inline]] void WriteBarrier(Obj* holder, Obj* value) {
+    if (_phase == Phase::MARKING && holder->_marked) Mark(value);
+  }
+
+  [[gnu::always_inline]] size_t ObjectCount() const { return _count; }
+
+  // Approximate: containers that grow after an object is made are only
+  // counted again at the next collection
+  [[gnu::always_inline]] size_t BytesAllocated() const {
+    return _bytes_allocated;
+  }
+
+  [[gnu::always_inline]] const Stats& GetStats() const { return _stats; }
+
+  [[gnu::always_inline]] void CountElided() { _stats.allocations_elided++; }
+
+ private:
+  enum class Phase : uint8_t { IDLE, MARKING, SWEEPING };
+
+  // The heap never shrinks its threshold below this
+  static constexpr size_t MIN_HEAP = 1024 * 1024;
+  static constexpr size_t GROWTH_FACTOR = 2;
+  // While a cycle is in progress, allocation between slices
+  static constexpr size_t STEP_BYTES = 64 * 1024;
+  // Objects traced or swept between checks of the clock
+  static constexpr size_t SLICE_WORK = 64;
+
+  using Clock = std::chrono::steady_clock;
+
+  // An object's own size plus what its containers have reserved
+  static size_t SizeOf(const Obj* object);
+
+  // The GC work due at the end of Make(), `newest` being what it made
+  void Advance(Obj* newest);
+  void RecordPause(Clock::duration pause);
+
+  void StartMarking();
+  // False if the deadline passed with objects still gray
+  bool MarkUntil(Clock::time_point deadline);
+  // The atomic end of marking: roots again, then everything left gray
+  void FinishMarking(Obj* keep);
+  // False if the deadline passed with objects still unswept
+  bool SweepUntil(Clock::time_point deadline);
+  void FinishCycle();
+
+  void Blacken(Obj* object);
+
+  Obj* _objects = nullptr;
+  size_t _count = 0;
+  size_t _bytes_allocated = 0;
+  size_t _next_gc = MIN_HEAP;
+
+  Roots* _roots = nullptr;
+  bool _stress = false;
+  std::chrono::nanoseconds _max_pause{0};
+  bool _record_pauses = false;
+
+  Phase _phase = Phase::IDLE;
+  // Marked objects whose references have not been traced yet
+  std::vector<Obj*> _gray;
+  // While sweeping, the link to the next object to look at. Objects made
+  // since sweeping began are ahead of it and survive.
+  Obj** _sweep = nullptr;
+  Stats _stats;
+
+  robin_hood::unordered_flat_map<const Symbol*, ObjString*, SymbolHash>
+      _strings;
+};
+
+#endif
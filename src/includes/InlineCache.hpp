@@ -0,0 +1,84 @@
+#ifndef INLINE_CACHE_HPP
+#define INLINE_CACHE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+class Obj;
+class Shape;
+
+// Remembers what the lookup at one property access or call site resolved
+// to, keyed on the receiver's shape (at a call site, the called class's
+// root shape). A site that only sees one key stays monomorphic and hits
+// on its first entry; one that sees up to WAYS keys is polymorphic; past
+// that it is megamorphic, and each miss evicts the oldest entry. Evicting
+// rather than giving up matters for the tree-walker, whose caches live in
+// the syntax tree: a tree run again by a new interpreter finds them full
+// of shapes that no longer exist.
+//
+// Keys are shape ids rather than pointers: ids are never reused, so an
+// entry cannot be mistaken for a shape allocated where a freed one was. A
+// hit is only possible for a receiver whose shape is alive, and its class
+// keeps the cached method and transition alive.
+class InlineCache {
+ public:
+  static constexpr size_t WAYS = 4;
+  static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+  // Totals over every site an engine looked up through
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
+
+  // What a lookup found for one key
+  struct Target {
+    // The field's slot, or NO_SLOT if the name is not a field
+    uint32_t slot = NO_SLOT;
+    // Otherwise the class's method, nullptr if it has none
+    Obj* method = nullptr;
+    // At a Set site adding a field: the instance's shape afterwards
+    Shape* transition = nullptr;
+  };
+
+  // nullptr on a miss
+  [[gnu::always_inline]] const Target* Find(uint64_t key) const {
+    for (uint8_t i = 0; i < _size; i++) {
+      if (_entries[i].key == key) return &_entries[i].target;
+    }
+    return nullptr;
+  }
+
+  [[gnu::always_inline]] const Target* Add(uint64_t key,
+                                           const Target& target) {
+    Entry* entry;
+    if (_size < WAYS) {
+      entry = &_entries[_size++];
+    } else {
+      _megamorphic = true;
+      entry = &_entries[_evict];
+      _evict = static_cast<uint8_t>((_evict + 1) % WAYS);
+    }
+    *entry = {key, target};
+    return &entry->target;
+  }
+
+  [[gnu::always_inline]] size_t Size() const { return _size; }
+
+  [[gnu::always_inline]] bool IsMegamorphic() const { return _megamorphic; }
+
+ private:
+  struct Entry {
+    uint64_t key;
+    Target target;
+  };
+
+  std::array<Entry, WAYS> _entries{};
+  uint8_t _size = 0;
+  // The oldest entry, once the cache is full
+  uint8_t _evict = 0;
+  bool _megamorphic = false;
+};
+
+#endif
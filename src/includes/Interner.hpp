@@ -0,0 +1,82 @@
+#ifndef INTERNER_HPP
+#define INTERNER_HPP
+
+#include <robin_hood.h>
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+
+#include "Arena.hpp"
+
+// One distinct identifier or string literal. The interner hands out a
+// single Symbol per text, so two symbols are equal exactly when their
+// pointers are, and tables keyed by symbol never touch the characters.
+struct Symbol {
+  std::string_view text;
+  uint64_t hash;
+};
+
+// For tables keyed by `const Symbol*`: the hash was computed when the text
+// was interned
+struct SymbolHash {
+  [[gnu::always_inline]] size_t operator()(
+      const Symbol* symbol) const noexcept {
+    return static_cast<size_t>(symbol->hash);
+  }
+};
+
+// Maps text to its unique Symbol. Symbols and their text live until the
+// interner is destroyed, which for the global one is the end of the
+// process: syntax trees and both runtimes keep pointers to them.
+// Interning is thread safe; the table is split into independently locked
+// shards so parallel parses rarely wait on each other.
+class Interner {
+ public:
+  Interner() = default;
+  ~Interner() = default;
+
+  // No copy
+  Interner(const Interner&) = delete;
+  Interner& operator=(const Interner&) = delete;
+
+  // No move
+  Interner(Interner&&) = delete;
+  Interner& operator=(Interner&&) = delete;
+
+  struct Stats {
+    // Distinct symbols and the bytes of text held once for each
+    size_t symbols = 0;
+    size_t text_bytes = 0;
+    // Every Intern() call and the bytes of text it was given, i.e. what
+    // separate copies would have held
+    size_t requests = 0;
+    size_t requested_bytes = 0;
+    // Bytes reserved for symbols, their text and the lookup tables
+    size_t memory = 0;
+  };
+
+  // The table shared by everything that runs scripts
+  static Interner& Global();
+
+  const Symbol* Intern(std::string_view text);
+
+  Stats GetStats() const;
+
+ private:
+  static constexpr size_t SHARDS = 16;
+
+  struct Shard {
+    mutable std::mutex mutex;
+    robin_hood::unordered_flat_map<std::string_view, const Symbol*> table;
+    Arena arena{4 * 1024};
+    size_t text_bytes = 0;
+    size_t requests = 0;
+    size_t requested_bytes = 0;
+  };
+
+  std::array<Shard, SHARDS> _shards;
+};
+
+#endif
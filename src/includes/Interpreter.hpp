@@ -0,0 +1,156 @@
+#ifndef INTERPRETER_HPP
+#define INTERPRETER_HPP
+
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Error.hpp"
+#include "Expr.hpp"
+#include "Heap.hpp"
+#include "Object.hpp"
+#include "Resolver.hpp"
+#include "Stmt.hpp"
+#include "Value.hpp"
+
+// Evaluates the AST directly. Globals and every object they reach persist
+// across Interpret() calls, so the statements (and the source they were
+// parsed from) have to outlive the interpreter.
+//
+// Values held by the C++ stack are invisible to the collector, so any that
+// must survive evaluating another expression are pushed on `_temporaries`
+// (or `_args`) first.
+class Interpreter : public Expr::Visitor<Value>,
+                    public Stmt::Visitor<void>,
+                    private Heap::Roots {
+ public:
+  explicit Interpreter(Error& error, std::ostream& out = std::cout);
+  ~Interpreter() = default;
+
+  // No copy
+  Interpreter(const Interpreter&) = delete;
+  Interpreter& operator=(const Interpreter&) = delete;
+
+  // No move
+  Interpreter(Interpreter&&) = delete;
+  Interpreter& operator=(Interpreter&&) = delete;
+
+  // Resolves the statements, then runs them in order and stops at the
+  // first runtime error. Errors of either kind are reported through
+  // `error`; after a resolution error nothing runs.
+  void Interpret(StmtList statements);
+
+  [[gnu::always_inline]] Heap& GetHeap() { return _heap; }
+  [[gnu::always_inline]] const Heap& GetHeap() const { return _heap; }
+
+  // Hits and misses of the method caches at property and call sites
+  [[gnu::always_inline]] const InlineCache::Stats& GetCacheStats() const {
+    return _cache_stats;
+  }
+
+ private:
+  class RuntimeError : public std::runtime_error {
+   public:
+    RuntimeError(unsigned int in_line, const std::string& message)
+        : std::runtime_error(message), line(in_line) {}
+    const unsigned int line;
+  };
+
+  [[gnu::always_inline]] Value Evaluate(const Expr* expr) {
+    return expr->Accept(*this);
+  }
+
+  [[gnu::always_inline]] void Execute(const Stmt* stmt) {
+    stmt->Accept(*this);
+  }
+
+  void ExecuteBlock(StmtList statements, Environment* environment);
+  // `cache` is the call site's, for finding a class's initializer
+  Value CallValue(Value callee, std::span<const Value> args,
+                  const Token<>& paren, InlineCache& cache);
+  // `receiver` is bound to `this` for methods and is nullptr otherwise
+  Value CallFunction(ObjFunction* function, std::span<const Value> args,
+                     const Value* receiver, const Token<>& paren);
+  // Calls of a method straight off its receiver, which never bind it
+  Value Invoke(const Get& get, const Call& call);
+  Value SuperInvoke(const Super& super, const Call& call);
+  // Evaluates the call's arguments onto `_args`, returning where they start
+  size_t PushArgs(const Call& call);
+  void CheckArity(const Token<>& paren, size_t arity, size_t argc);
+  Value LookUp(const Token<>& name, Slot slot);
+  // Assigns a variable that has already been defined
+  void Store(const Token<>& name, Slot slot, Value value);
+  // Defines a variable in the current scope, or a global at the top level
+  void Define(std::string_view name, Value value);
+  double NumberOperand(const Token<>& oper, Value operand);
+
+  // Only objects need rooting; numbers and literals cannot be collected
+  [[gnu::always_inline]] void Protect(Value value) {
+    if (value.IsObject()) _temporaries.push_back(value);
+  }
+
+  [[gnu::always_inline]] void Unprotect(Value value) {
+    if (value.IsObject()) _temporaries.pop_back();
+  }
+
+  void MarkRoots(Heap& heap) override;
+
+  Value VisitAssignExpr(const Assign& expr) override;
+  Value VisitBinaryExpr(const Binary& expr) override;
+  Value VisitCallExpr(const Call& expr) override;
+  Value VisitGetExpr(const Get& expr) override;
+  Value VisitGroupingExpr(const Grouping& expr) override;
+  Value VisitLiteralExpr(const Literal& expr) override;
+  Value VisitLogicalExpr(const Logical& expr) override;
+  Value VisitSetExpr(const Set& expr) override;
+  Value VisitSuperExpr(const Super& expr) override;
+  Value VisitThisExpr(const This& expr) override;
+  Value VisitUnaryExpr(const Unary& expr) override;
+  Value VisitVariableExpr(const Variable& expr) override;
+
+  void VisitBlockStmt(const Block& stmt) override;
+  void VisitClassStmt(const Class& stmt) override;
+  void VisitExpressionStmt(const Expression& stmt) override;
+  void VisitFunctionStmt(const Function& stmt) override;
+  void VisitIfStmt(const If& stmt) override;
+  void VisitPrintStmt(const Print& stmt) override;
+  void VisitReturnStmt(const Return& stmt) override;
+  void VisitVarStmt(const Var& stmt) override;
+  void VisitWhileStmt(const While& stmt) override;
+
+  Error& _error;
+  std::ostream& _out;
+  Heap _heap;
+  Resolver _resolver;
+
+  // Indexed by the resolver's global slots. A global is in the table as
+  // soon as some code names it, but only defined once its declaration runs.
+  struct Global {
+    Value value;
+    bool defined = false;
+  };
+  std::vector<Global> _globals;
+  // nullptr at the top level, where declarations go to `_globals`
+  Environment* _environment = nullptr;
+
+  // `return` unwinds by flag rather than by exception: blocks and loops
+  // stop as soon as it is set, and the call that owns it clears it
+  bool _returning = false;
+  Value _return_value;
+
+  // Calls deeper than the VM's frames allow, less the script's own, are a
+  // stack overflow in both engines
+  static constexpr size_t CALLS_MAX = 63;
+  size_t _call_depth = 0;
+
+  // Arguments of the calls in progress, stacked like the parser's lists
+  std::vector<Value> _args;
+  // Values that are only held in C++ locals while something else runs
+  std::vector<Value> _temporaries;
+  InlineCache::Stats _cache_stats;
+  const Symbol* _init = Interner::Global().Intern("init");
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef KEYWORDS_HPP
+#define KEYWORDS_HPP
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+#include "Token.hpp"
+
+struct Keyword {
+  std::string_view text;
+  TokenType type;
+};
+
+inline constexpr Keyword keyword_list[] = {
+    {"and", TokenType::AND},       {"class", TokenType::CLASS},
+    {"else", TokenType::ELSE},     {"false", TokenType::FALSE},
+    {"for", TokenType::FOR},       {"fun", TokenType::FUN},
+    {"if", TokenType::IF},         {"nil", TokenType::NIL},
+    {"or", TokenType::OR},         {"print", TokenType::PRINT},
+    {"return", TokenType::RETURN}, {"super", TokenType::SUPER},
+    {"this", TokenType::THIS},     {"true", TokenType::TRUE},
+    {"var", TokenType::VAR},       {"while", TokenType::WHILE}};
+
+inline constexpr size_t keyword_min_length = 2;
+inline constexpr size_t keyword_max_length = 6;
+inline constexpr size_t keyword_table_size = 32;
+
+// Perfect hash over the first two bytes and the length. Every identifier
+// reaching it has at least keyword_min_length bytes.
+[[gnu::always_inline]] constexpr size_t KeywordHash(std::string_view text) {
+  return (static_cast<size_t>(text[0]) * 4 + static_cast<size_t>(text[1]) * 3 +
+          text.size()) &
+         (keyword_table_size - 1);
+}
+
+constexpr std::array<Keyword, keyword_table_size> BuildKeywordTable() {
+  std::array<Keyword, keyword_table_size> table{};
+  for (auto &slot : table) {
+    slot = {"", TokenType::IDENTIFIER};
+  }
+  for (const auto &keyword : keyword_list) {
+    auto &slot = table[KeywordHash(keyword.text)];
+    if (!slot.text.empty()) {
+      // Not a constant expression, so a collision fails the build
+      throw "KeywordHash is no longer perfect, pick new multipliers";
+    }
+    slot = keyword;
+  }
+  return table;
+}
+
+inline constexpr auto keyword_table = BuildKeywordTable();
+
+// Returns the keyword's TokenType, or IDENTIFIER for anything else. One
+// table probe and a compare of at most keyword_max_length bytes.
+[[gnu::always_inline]] constexpr TokenType ClassifyKeyword(
+    std::string_view text) {
+  if (text.size() < keyword_min_length || text.size() > keyword_max_length) {
+    return TokenType::IDENTIFIER;
+  }
+  const Keyword &candidate = keyword_table[KeywordHash(text)];
+  return candidate.text == text ? candidate.type : TokenType::IDENTIFIER;
+}
+
+static_assert(ClassifyKeyword("while") == TokenType::WHILE);
+static_assert(ClassifyKeyword("if") == TokenType::IF);
+static_assert(ClassifyKeyword("whale") == TokenType::IDENTIFIER);
+static_assert(ClassifyKeyword("i") == TokenType::IDENTIFIER);
+
+#endif
@@ -0,0 +1,481 @@
+#ifndef OBJECT_HPP
+#define OBJECT_HPP
+
+#include <robin_hood.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Chunk.hpp"
+#include "InlineCache.hpp"
+#include "Interner.hpp"
+#include "Shape.hpp"
+#include "Stmt.hpp"
+#include "Value.hpp"
+
+// Runtime objects are owned by a Heap and referenced from Values by raw
+// pointer. Names are views into the script source (or static strings), so
+// the source has to outlive the objects built from it; fields, methods and
+// globals are keyed by interned Symbol instead. Both engines share
+// strings, natives, classes and instances; functions are ObjFunction under
+// the tree-walker and ObjClosure (over an ObjProto) under the VM.
+
+enum class ObjType : uint8_t {
+  STRING,
+  FUNCTION,
+  NATIVE,
+  CLASS,
+  INSTANCE,
+  BOUND_METHOD,
+  ENVIRONMENT,
+  PROTO,
+  CLOSURE,
+  UPVALUE
+};
+
+// ------------- OBJ CLASS -------------
+class Obj {
+ public:
+  virtual ~Obj() = default;
+
+  // No copy
+  Obj(const Obj&) = delete;
+  Obj& operator=(const Obj&) = delete;
+
+  [[gnu::always_inline]] ObjType GetType() const { return _type; }
+
+ protected:
+  explicit Obj(ObjType type) noexcept : _type(type) {}
+
+ private:
+  friend class Heap;
+
+  const ObjType _type;
+  bool _marked = false;
+  Obj* _next = nullptr;
+};
+
+// ------------- STRING CLASS -------------
+// Either made at run time, and owning its characters, or the heap's one
+// string for an interned Symbol (see Heap::Intern), sharing its text
+class ObjString : public Obj {
+ public:
+  explicit ObjString(std::string chars)
+      : Obj(ObjType::STRING), _chars(std::move(chars)), _view(_chars) {}
+
+  explicit ObjString(const Symbol* symbol)
+      : Obj(ObjType::STRING), _view(symbol->text), _symbol(symbol) {}
+
+  [[gnu::always_inline]] std::string_view View() const { return _view; }
+
+  // nullptr unless the string is interned
+  [[gnu::always_inline]] const Symbol* GetSymbol() const { return _symbol; }
+
+ private:
+  std::string _chars;
+  std::string_view _view;
+  const Symbol* _symbol = nullptr;
+};
+
+// ------------- ENVIRONMENT CLASS -------------
+// One scope of local variables. Closures keep their defining scope alive,
+// so scopes are heap objects rather than stack frames. Variables are
+// addressed by the slot the Resolver gave them: declarations run in the
+// order they were resolved, so each one is appended at its own index.
+class Environment : public Obj {
+ public:
+  explicit Environment(Environment* enclosing = nullptr)
+      : Obj(ObjType::ENVIRONMENT), _enclosing(enclosing) {}
+
+  [[gnu::always_inline]] void Define(Value value) { _values.push_back(value); }
+
+  [[gnu::always_inline]] Value& At(uint32_t index) { return _values[index]; }
+
+  [[gnu::always_inline]] uint32_t Size() const {
+    return static_cast<uint32_t>(_values.size());
+  }
+
+  [[gnu::always_inline]] std::span<const Value> Values() const {
+    return _values;
+  }
+
+  // The scope `depth` hops out from this one
+  [[gnu::always_inline]] Environment* Ancestor(uint32_t depth) {
+    Environment* env = this;
+    for (; depth > 0; depth--) env = env->_enclosing;
+    return env;
+  }
+
+  [[gnu::always_inline]] Environment* GetEnclosing() const {
+    return _enclosing;
+  }
+
+ private:
+  Environment* _enclosing;
+  std::vector<Value> _values;
+};
+
+// ------------- FUNCTION CLASS -------------
+class ObjFunction : public Obj {
+ public:
+  ObjFunction(const Function* declaration, Environment* closure,
+              bool is_initializer)
+      : Obj(ObjType::FUNCTION),
+        _declaration(declaration),
+        _closure(closure),
+        _is_initializer(is_initializer) {}
+
+  [[gnu::always_inline]] const Function* GetDeclaration() const {
+    return _declaration;
+  }
+
+  [[gnu::always_inline]] Environment* GetClosure() const { return _closure; }
+
+  [[gnu::always_inline]] bool IsInitializer() const { return _is_initializer; }
+
+  [[gnu::always_inline]] size_t Arity() const {
+    return _declaration->GetParams().size();
+  }
+
+  [[gnu::always_inline]] std::string_view Name() const {
+    return _declaration->GetName()->lexeme;
+  }
+
+ private:
+  const Function* _declaration;
+  Environment* _closure;
+  bool _is_initializer;
+};
+
+// ------------- NATIVE CLASS -------------
+class ObjNative : public Obj {
+ public:
+  using Fn = Value (*)(std::span<const Value> args);
+
+  ObjNative(std::string_view name, size_t arity, Fn function)
+      : Obj(ObjType::NATIVE), _name(name), _arity(arity), _function(function) {}
+
+  [[gnu::always_inline]] std::string_view Name() const { return _name; }
+
+  [[gnu::always_inline]] size_t Arity() const { return _arity; }
+
+  [[gnu::always_inline]] Value Call(std::span<const Value> args) const {
+    return _function(args);
+  }
+
+ private:
+  std::string_view _name;
+  size_t _arity;
+  Fn _function;
+};
+
+// ------------- CLASS CLASS -------------
+class ObjClass : public Obj {
+ public:
+  ObjClass(std::string_view name, ObjClass* superclass)
+      : Obj(ObjType::CLASS),
+        _name(name),
+        _superclass(superclass),
+        _shape(std::make_unique<Shape>(this)) {}
+
+  [[gnu::always_inline]] std::string_view Name() const { return _name; }
+
+  // The shape of a new instance, with no fields yet; the root of the tree
+  // of every layout the class's instances have had
+  [[gnu::always_inline]] Shape* GetShape() const { return _shape.get(); }
+
+  [[gnu::always_inline]] ObjClass* GetSuperclass() const {
+    return _superclass;
+  }
+
+  // Only the VM sets the superclass after creation
+  [[gnu::always_inline]] void Inherit(ObjClass* superclass) {
+    _superclass = superclass;
+  }
+
+  // `method` is an ObjFunction or an ObjClosure, depending on the engine
+  [[gnu::always_inline]] void AddMethod(const Symbol* name, Obj* method) {
+    _methods[name] = method;
+  }
+
+  // Looks through the superclass chain; nullptr if no class defines it
+  template <typename T>
+  [[gnu::always_inline]] T* FindMethod(const Symbol* name) const {
+    return static_cast<T*>(FindMethodObj(name));
+  }
+
+  // The same lookup through a site's inline cache, keyed on the root
+  // shape. Methods never change once a class has instances, so a hit
+  // needs no further check.
+  template <typename T>
+  [[gnu::always_inline]] T* FindMethod(const Symbol* name, InlineCache& cache,
+                                       InlineCache::Stats& stats) const {
+    const InlineCache::Target* target = cache.Find(_shape->Id());
+    if (target != nullptr) {
+      stats.hits++;
+    } else {
+      stats.misses++;
+      target = cache.Add(_shape->Id(), {.method = FindMethodObj(name)});
+    }
+    return static_cast<T*>(target->method);
+  }
+
+  using Methods =
+      robin_hood::unordered_flat_map<const Symbol*, Obj*, SymbolHash>;
+
+  // The class's own methods, without inherited ones
+  [[gnu::always_inline]] const Methods& GetMethods() const { return _methods; }
+
+ private:
+  friend class ObjInstance;
+
+  Obj* FindMethodObj(const Symbol* name) const;
+
+  std::string_view _name;
+  ObjClass* _superclass;
+  Methods _methods;
+  std::unique_ptr<Shape> _shape;
+};
+
+// ------------- INSTANCE CLASS -------------
+// Fields live in the slots the instance's shape lays out: the first
+// INLINE_FIELDS inside the object, the rest in a side array. An instance
+// that outgrows the shape tree moves its fields into a table for good
+// (dictionary mode) and has no shape from then on.
+class ObjInstance : public Obj {
+ public:
+  static constexpr uint32_t INLINE_FIELDS = 4;
+
+  explicit ObjInstance(ObjClass* klass)
+      : Obj(ObjType::INSTANCE), _klass(klass), _shape(klass->GetShape()) {}
+
+  [[gnu::always_inline]] ObjClass* GetClass() const { return _klass; }
+
+  // nullptr in dictionary mode
+  [[gnu::always_inline]] const Shape* GetShape() const { return _shape; }
+
+  // nullptr if the instance has no such field
+  [[gnu::always_inline]] Value* FindField(const Symbol* name) {
+    if (_shape == nullptr) {
+      auto field = _dictionary->find(name);
+      return field == _dictionary->end() ? nullptr : &field->second;
+    }
+    uint32_t slot = _shape->Find(name);
+    return slot == Shape::NOT_FOUND ? nullptr : &Slot(slot);
+  }
+
+  void SetField(const Symbol* name, Value value);
+
+  // Reads property `name` through a Get site's cache: the field if the
+  // instance has one, otherwise nullptr with `method` set to the class's
+  // method (nullptr too if it has none)
+  [[gnu::always_inline]] Value* GetProperty(const Symbol* name,
+                                            InlineCache& cache,
+                                            InlineCache::Stats& stats,
+                                            Obj*& method) {
+    if (_shape == nullptr) {
+      stats.misses++;
+      if (Value* field = FindField(name)) return field;
+      method = _klass->FindMethodObj(name);
+      return nullptr;
+    }
+
+    const InlineCache::Target* target = cache.Find(_shape->Id());
+    if (target != nullptr) {
+      stats.hits++;
+    } else {
+      stats.misses++;
+      target = ResolveLoad(name, cache);
+    }
+    if (target->slot != InlineCache::NO_SLOT) return &Slot(target->slot);
+    method = target->method;
+    return nullptr;
+  }
+
+  // Stores field `name` through a Set site's cache
+  [[gnu::always_inline]] void SetProperty(const Symbol* name, Value value,
+                                          InlineCache& cache,
+                                          InlineCache::Stats& stats) {
+    const InlineCache::Target* target =
+        _shape == nullptr ? nullptr : cache.Find(_shape->Id());
+    if (target == nullptr) {
+      stats.misses++;
+      target = ResolveStore(name, cache);
+      if (target == nullptr) {
+        SetField(name, value);
+        return;
+      }
+    } else {
+      stats.hits++;
+    }
+
+    if (target->transition != nullptr) {
+      AddField(target->transition, value);
+    } else {
+      Slot(target->slot) = value;
+    }
+  }
+
+  // Calls `visit` with the value of every field
+  template <typename F>
+  void ForEachField(F visit) const {
+    if (_shape == nullptr) {
+      for (const auto& field : *_dictionary) visit(field.second);
+      return;
+    }
+    uint32_t count = _shape->FieldCount();
+    for (uint32_t slot = 0; slot < count && slot < INLINE_FIELDS; slot++) {
+      visit(_inline[slot]);
+    }
+    for (Value value : _overflow) visit(value);
+  }
+
+  // Bytes held outside the object itself
+  size_t FieldBytes() const;
+
+ private:
+  using Dictionary =
+      robin_hood::unordered_flat_map<const Symbol*, Value, SymbolHash>;
+
+  [[gnu::always_inline]] Value& Slot(uint32_t slot) {
+    return slot < INLINE_FIELDS ? _inline[slot]
+                                : _overflow[slot - INLINE_FIELDS];
+  }
+
+  // Appends the slot `next` adds to the current shape
+  [[gnu::always_inline]] void AddField(Shape* next, Value value) {
+    uint32_t slot = _shape->FieldCount();
+    if (slot < INLINE_FIELDS) {
+      _inline[slot] = value;
+    } else {
+      _overflow.push_back(value);
+    }
+    _shape = next;
+  }
+
+  // Caches what reading `name` finds on instances of the current shape
+  const InlineCache::Target* ResolveLoad(const Symbol* name,
+                                         InlineCache& cache);
+  // Caches what a store of `name` does to instances of the current
+  // shape; nullptr if it cannot be cached, in dictionary mode or because
+  // the store leaves the shape tree
+  const InlineCache::Target* ResolveStore(const Symbol* name,
+                                          InlineCache& cache);
+
+  ObjClass* _klass;
+  Shape* _shape;
+  std::array<Value, INLINE_FIELDS> _inline;
+  std::vector<Value> _overflow;
+  std::unique_ptr<Dictionary> _dictionary;
+};
+
+// ------------- BOUND METHOD CLASS -------------
+class ObjBoundMethod : public Obj {
+ public:
+  ObjBoundMethod(Value receiver, Obj* method)
+      : Obj(ObjType::BOUND_METHOD), _receiver(receiver), _method(method) {}
+
+  [[gnu::always_inline]] Value GetReceiver() const { return _receiver; }
+
+  template <typename T>
+  [[gnu::always_inline]] T* GetMethod() const {
+    return static_cast<T*>(_method);
+  }
+
+ private:
+  Value _receiver;
+  Obj* _method;
+};
+
+// ------------- PROTO CLASS -------------
+// A compiled function: its bytecode and what a closure over it captures
+class ObjProto : public Obj {
+ public:
+  explicit ObjProto(std::string_view name) : Obj(ObjType::PROTO), _name(name) {}
+
+  [[gnu::always_inline]] std::string_view Name() const { return _name; }
+
+  [[gnu::always_inline]] Chunk& GetChunk() { return _chunk; }
+  [[gnu::always_inline]] const Chunk& GetChunk() const { return _chunk; }
+
+  size_t arity = 0;
+  size_t upvalue_count = 0;
+  // One per GET_PROPERTY, SET_PROPERTY, CALL, GET_METHOD and
+  // SUPER_METHOD, indexed by the instruction's operand
+  std::vector<InlineCache> caches;
+
+ private:
+  std::string_view _name;
+  Chunk _chunk;
+};
+
+// ------------- UPVALUE CLASS -------------
+// A variable captured by a closure. While the variable is still on the VM
+// stack `location` points at its slot; once the slot goes away the value
+// is moved into `closed` and `location` points there instead.
+class ObjUpvalue : public Obj {
+ public:
+  explicit ObjUpvalue(Value* slot)
+      : Obj(ObjType::UPVALUE), location(slot) {}
+
+  [[gnu::always_inline]] void Close() {
+    closed = *location;
+    location = &closed;
+  }
+
+  Value* location;
+  Value closed;
+  // Open upvalues form a list sorted by stack slot, innermost first
+  ObjUpvalue* next_open = nullptr;
+};
+
+// ------------- CLOSURE CLASS -------------
+class ObjClosure : public Obj {
+ public:
+  explicit ObjClosure(ObjProto* proto)
+      : Obj(ObjType::CLOSURE),
+        _proto(proto),
+        _upvalues(proto->upvalue_count, nullptr) {}
+
+  [[gnu::always_inline]] ObjProto* GetProto() const { return _proto; }
+
+  [[gnu::always_inline]] ObjUpvalue*& Upvalue(size_t index) {
+    return _upvalues[index];
+  }
+
+  [[gnu::always_inline]] std::span<ObjUpvalue* const> Upvalues() const {
+    return _upvalues;
+  }
+
+ private:
+  ObjProto* _proto;
+  std::vector<ObjUpvalue*> _upvalues;
+};
+
+// ------------- HELPERS -------------
+[[gnu::always_inline]] inline bool IsObjType(Value value, ObjType type) {
+  return value.IsObject() && value.AsObject()->GetType() == type;
+}
+
+template <typename T>
+[[gnu::always_inline]] inline T* AsObj(Value value) {
+  return static_cast<T*>(value.AsObject());
+}
+
+// Lox equality: numbers by value, strings by content (by identity when both
+// are interned), the rest by identity
+bool ValuesEqual(Value a, Value b);
+
+// How `print` shows a value
+std::string Stringify(Value value);
+
+// clock(): seconds on a monotonic clock
+Value ClockNative(std::span<const Value> args);
+
+#endif
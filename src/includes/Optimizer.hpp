@@ -0,0 +1,79 @@
+#ifndef OPTIMIZER_HPP
+#define OPTIMIZER_HPP
+
+#include <optional>
+#include <vector>
+
+#include "Arena.hpp"
+#include "Expr.hpp"
+#include "Stmt.hpp"
+
+// Folds expressions whose operands are all literals into a single Literal:
+// arithmetic, comparisons, string concatenation, `!`/`-`, and `and`/`or`
+// whose left operand is constant. Groupings are dropped, since the tree
+// already encodes precedence. Only operations that cannot fail are folded,
+// so `1 - "a"` is left alone to raise its runtime error when it executes.
+//
+// Nodes are never modified: a subtree that changes is rebuilt in `arena`
+// and everything else is shared with the input tree.
+class Optimizer : public Expr::Visitor<const Expr*>,
+                  public Stmt::Visitor<const Stmt*> {
+ public:
+  explicit Optimizer(Arena& arena) : _arena(arena) {}
+
+  // No copy
+  Optimizer(const Optimizer&) = delete;
+  Optimizer& operator=(const Optimizer&) = delete;
+
+  StmtList Optimize(StmtList statements);
+  const Expr* Optimize(const Expr* expr);
+
+  // Expression and statement nodes reachable from `statements`
+  static size_t CountNodes(StmtList statements);
+
+ private:
+  const Expr* VisitAssignExpr(const Assign& expr) override;
+  const Expr* VisitBinaryExpr(const Binary& expr) override;
+  const Expr* VisitCallExpr(const Call& expr) override;
+  const Expr* VisitGetExpr(const Get& expr) override;
+  const Expr* VisitGroupingExpr(const Grouping& expr) override;
+  const Expr* VisitLiteralExpr(const Literal& expr) override;
+  const Expr* VisitLogicalExpr(const Logical& expr) override;
+  const Expr* VisitSetExpr(const Set& expr) override;
+  const Expr* VisitSuperExpr(const Super& expr) override;
+  const Expr* VisitThisExpr(const This& expr) override;
+  const Expr* VisitUnaryExpr(const Unary& expr) override;
+  const Expr* VisitVariableExpr(const Variable& expr) override;
+
+  const Stmt* VisitBlockStmt(const Block& stmt) override;
+  const Stmt* VisitClassStmt(const Class& stmt) override;
+  const Stmt* VisitExpressionStmt(const Expression& stmt) override;
+  const Stmt* VisitFunctionStmt(const Function& stmt) override;
+  const Stmt* VisitIfStmt(const If& stmt) override;
+  const Stmt* VisitPrintStmt(const Print& stmt) override;
+  const Stmt* VisitReturnStmt(const Return& stmt) override;
+  const Stmt* VisitVarStmt(const Var& stmt) override;
+  const Stmt* VisitWhileStmt(const While& stmt) override;
+
+  // nullptr stays nullptr, for optional children
+  const Stmt* Optimize(const Stmt* stmt);
+  const Function* OptimizeFunction(const Function& function);
+
+  // Returns `list` itself when no element changed
+  StmtList OptimizeList(StmtList list);
+
+  // The folded value, or nothing when the operation has to run to find out
+  // (a non-literal operand, or operand types that raise a runtime error)
+  std::optional<LiteralValue> FoldBinary(TokenType op, const LiteralValue& a,
+                                         const LiteralValue& b);
+
+  Arena& _arena;
+
+  // Rebuilt lists are collected here before moving into the arena, as in
+  // the parser
+  std::vector<const Stmt*> _stmts;
+  std::vector<const Expr*> _args;
+  std::vector<const Function*> _methods;
+};
+
+#endif
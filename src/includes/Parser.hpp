@@ -1,53 +1,139 @@
 #ifndef PARSER_HPP
 #define PARSER_HPP
 
-#include "Token.hpp"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Arena.hpp"
+#include "Error.hpp"
 #include "Expr.hpp"
+#include "Stmt.hpp"
+#include "TokenBuffer.hpp"
 
-template <typename T, typename U>
+// Walks a TokenBuffer by index; tokens are never copied out of the buffer.
+// Every node is built in `arena`, so the tree lives exactly as long as the
+// arena's current generation and is released with a single Reset().
 class Parser {
-public:
+ public:
+  // Deepest code may nest, counting each block, function body, loop or
+  // `if` body, parenthesized group, call argument, assigned value and
+  // unary operand as a level. Deeper input is a syntax error rather than
+  // a stack overflow here or in whatever walks the tree.
+  static constexpr size_t MAX_NESTING = 256;
+  // Of those, the most that may be blocks and bodies, so an expression
+  // always has room inside the deepest statement
+  static constexpr size_t MAX_STATEMENT_NESTING = MAX_NESTING / 2;
 
-private:
+  Parser(const TokenBuffer& tokens, Arena& arena, Error& error)
+      : _tokens(tokens), _arena(arena), _error(error) {}
 
-    [[gnu::always_inline]] bool Match(TokenType&& type) {
-        if (Check(type)) {
-            Advance();
-            return true;
-        }
-    }
+  // No copy
+  Parser(const Parser&) = delete;
+  Parser& operator=(const Parser&) = delete;
 
-    template <typename... Args>
-    [[gnu::always_inline]] bool Match(Args&&... token_types) {
-        return (Match(std::forward<Args>(token_types)), ...) || false;
-    }
+  // Parses a whole program. A syntax error is reported, the parser skips
+  // to the next statement boundary and carries on, so one pass reports
+  // every error in the file; the statements that failed are left out.
+  StmtList Parse();
 
-    [[gnu::always_inline]] bool Check(TokenType type) {
-        if (IsAtEnd()) return false;
-        return Peek()->type == type;
-    }
+  // Returns nullptr after reporting a syntax error
+  const Expr* ParseExpression();
 
-    [[gnu::always_inline]] Token<T>* Advance() {
-        if (!IsAtEnd()) current++;
-        return Previous();
+ private:
+  class ParseError : public std::runtime_error {
+   public:
+    using std::runtime_error::runtime_error;
+  };
+
+  template <typename... Args>
+  [[gnu::always_inline]] bool Match(Args... token_types) {
+    if ((Check(token_types) || ...)) {
+      Advance();
+      return true;
     }
+    return false;
+  }
 
+  [[gnu::always_inline]] bool Check(TokenType type) {
+    if (IsAtEnd()) return false;
+    return _tokens.Type(current) == type;
+  }
 
-    [[gnu::always_inline]] bool IsAtEnd() {
-        return Peek()->type == TokenType::TEOF;
-    }
+  [[gnu::always_inline]] size_t Advance() {
+    if (!IsAtEnd()) current++;
+    return Previous();
+  }
 
-    [[gnu::always_inline]] Token<T>* Peek() {
-        return Token<T>::GetTokens()->at(current);
-    }
+  [[gnu::always_inline]] bool IsAtEnd() {
+    return _tokens.Type(current) == TokenType::TEOF;
+  }
 
-    [[gnu::always_inline]] Token<T>* Previous() {
-        return Token<T>::GetTokens()->at(current - 1);
-    }
+  [[gnu::always_inline]] size_t Peek() { return current; }
+
+  [[gnu::always_inline]] size_t Previous() { return current - 1; }
+
+  // Interned name of an IDENTIFIER, or value of a STRING. Only names the
+  // runtime looks up by name (properties, methods) and string literals are
+  // interned; variables are resolved to slots instead.
+  const Symbol* SymbolAt(size_t index) const;
+
+  size_t Consume(TokenType type, const std::string& message);
+  ParseError ErrorAt(size_t index, const std::string& message);
+  void SkipNested(size_t depth);
+  void Synchronize();
+
+  // Moves the scratch entries pushed since `start` into the arena
+  template <typename T>
+  [[gnu::always_inline]] std::span<const T> Commit(std::vector<T>& scratch,
+                                                   size_t start) {
+    auto items = _arena.CopyArray(std::span<const T>(scratch).subspan(start));
+    scratch.resize(start);
+    return items;
+  }
+
+  const Stmt* Declaration();
+  const Stmt* ClassDeclaration();
+  const Function* FunctionDeclaration(const std::string& kind);
+  const Stmt* VarDeclaration();
+  const Stmt* Statement();
+  const Stmt* ForStatement();
+  const Stmt* IfStatement();
+  const Stmt* PrintStatement();
+  const Stmt* ReturnStatement();
+  const Stmt* WhileStatement();
+  const Stmt* ExpressionStatement();
+  StmtList BlockStatements();
+  const Stmt* Body();
+
+  const Expr* Expression();
+  const Expr* Assignment();
+  const Expr* Or();
+  const Expr* And();
+  const Expr* Equality();
+  const Expr* Comparison();
+  const Expr* Term();
+  const Expr* Factor();
+  const Expr* Unary();
+  const Expr* Call();
+  const Expr* FinishCall(const Expr* callee);
+  // Enters a nested expression; throws past MAX_NESTING
+  void Nest();
+  const Expr* Primary();
+
+  const TokenBuffer& _tokens;
+  Arena& _arena;
+  Error& _error;
+  size_t current = 0;
+  // Statements and expressions being parsed, one inside the other
+  size_t _nesting = 0;
 
-    Expr<T, U>* Expression();
-    Expr<T, U>* Equality();
-    inline static int current = 0;
+  // Lists are collected on shared stacks and copied into the arena once
+  // complete, so nested blocks and calls don't allocate a vector each
+  std::vector<const Stmt*> _stmts;
+  std::vector<const Expr*> _args;
+  std::vector<const Function*> _methods;
+  std::vector<Token<>> _params;
 };
 
-#endif
\ No newline at end of file
+#endif
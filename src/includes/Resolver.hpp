@@ -0,0 +1,119 @@
+#ifndef RESOLVER_HPP
+#define RESOLVER_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Error.hpp"
+#include "Expr.hpp"
+#include "Stmt.hpp"
+
+// Works out, before anything runs, where every variable reference of a
+// program lives, and records it in the node's Slot: locals by environment
+// depth and index, globals by their index in a table that persists across
+// Resolve() calls like the interpreter's globals do. Scoping errors the
+// VM's compiler reports are reported here for the tree-walker, along with
+// names that nothing in the program (or an earlier one) declares.
+//
+// The slots mirror the scopes the Interpreter creates: one environment per
+// block, one per call holding `this` (for methods) and then the
+// parameters, and one around a subclass's methods holding `super`.
+class Resolver : public Expr::Visitor<void>, public Stmt::Visitor<void> {
+ public:
+  explicit Resolver(Error& error) : _error(error) {}
+
+  // No copy
+  Resolver(const Resolver&) = delete;
+  Resolver& operator=(const Resolver&) = delete;
+
+  // False after reporting an error, in which case the statements must not
+  // run
+  bool Resolve(StmtList statements);
+
+  // Index of global `name` in the table, declaring it if it is new
+  uint32_t DeclareGlobal(std::string_view name);
+
+  // Index of a global that is already in the table
+  [[gnu::always_inline]] uint32_t GlobalSlot(std::string_view name) const {
+    return _global_slots.at(name);
+  }
+
+  [[gnu::always_inline]] size_t GlobalCount() const {
+    return _global_declared.size();
+  }
+
+ private:
+  enum class FunctionKind : uint8_t { NONE, FUNCTION, METHOD, INITIALIZER };
+  enum class ClassKind : uint8_t { NONE, CLASS, SUBCLASS };
+
+  struct Local {
+    std::string_view name;
+    // False while the variable's own initializer is being resolved
+    bool defined;
+  };
+
+  [[gnu::always_inline]] void Resolve(const Expr* expr) {
+    expr->Accept(*this);
+  }
+
+  [[gnu::always_inline]] void Resolve(const Stmt* stmt) {
+    stmt->Accept(*this);
+  }
+
+  void ResolveStatements(StmtList statements);
+  void ResolveFunction(const Function& function, FunctionKind kind);
+  Slot ResolveName(const Token<>& name);
+
+  void BeginScope() { _scopes.push_back(_locals.size()); }
+  void EndScope();
+  void Declare(const Token<>& name);
+  void MarkInitialized();
+
+  // Report without unwinding; the rest of the program is still resolved
+  void ErrorAt(const Token<>& token, const std::string& message);
+
+  void VisitAssignExpr(const Assign& expr) override;
+  void VisitBinaryExpr(const Binary& expr) override;
+  void VisitCallExpr(const Call& expr) override;
+  void VisitGetExpr(const Get& expr) override;
+  void VisitGroupingExpr(const Grouping& expr) override;
+  void VisitLiteralExpr(const Literal& expr) override;
+  void VisitLogicalExpr(const Logical& expr) override;
+  void VisitSetExpr(const Set& expr) override;
+  void VisitSuperExpr(const Super& expr) override;
+  void VisitThisExpr(const This& expr) override;
+  void VisitUnaryExpr(const Unary& expr) override;
+  void VisitVariableExpr(const Variable& expr) override;
+
+  void VisitBlockStmt(const Block& stmt) override;
+  void VisitClassStmt(const Class& stmt) override;
+  void VisitExpressionStmt(const Expression& stmt) override;
+  void VisitFunctionStmt(const Function& stmt) override;
+  void VisitIfStmt(const If& stmt) override;
+  void VisitPrintStmt(const Print& stmt) override;
+  void VisitReturnStmt(const Return& stmt) override;
+  void VisitVarStmt(const Var& stmt) override;
+  void VisitWhileStmt(const While& stmt) override;
+
+  Error& _error;
+  bool _had_error = false;
+  FunctionKind _function = FunctionKind::NONE;
+  ClassKind _class = ClassKind::NONE;
+
+  // Locals of every open scope, innermost last, and where each scope
+  // starts in that list. No scopes are open at the top level.
+  std::vector<Local> _locals;
+  std::vector<size_t> _scopes;
+
+  std::unordered_map<std::string_view, uint32_t> _global_slots;
+  std::vector<bool> _global_declared;
+  // First use of each global that was undeclared when it was seen; checked
+  // once the whole program has been resolved
+  std::vector<std::pair<uint32_t, const Token<>*>> _pending;
+};
+
+#endif
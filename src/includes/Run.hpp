@@ -1,10 +1,45 @@
 #ifndef RUN_HPP
 #define RUN_HPP
 
+#include <chrono>
 #include <string>
+#include <string_view>
+#include <vector>
+
+#include "Error.hpp"
+#include "InlineCache.hpp"
+
+class Arena;
+class Heap;
+class VM;
 
 class Run {
  public:
+  // Which evaluator runs scripts
+  enum class Engine { TREE, VM };
+
+  // Command-line switches for running scripts
+  struct Options {
+    Engine engine = Engine::TREE;
+    // Print the AST node count before and after constant folding
+    bool fold_stats = false;
+    // Print collection counts, pauses and bytes freed on exit
+    bool gc_stats = false;
+    // Collect on every allocation
+    bool gc_stress = false;
+    // Collect incrementally, pausing for about this long at a time; zero
+    // stops the world for each collection
+    std::chrono::nanoseconds gc_max_pause{0};
+    // Print inline cache hits and misses on exit
+    bool ic_stats = false;
+    // Directory of compiled scripts the VM starts from when a script has
+    // not changed; empty compiles every time. Only the VM reads it.
+    std::string bytecode_cache;
+    // Where to write a Chrome trace of the run's phases and calls; empty
+    // traces nothing
+    std::string trace;
+  };
+
   Run() = default;
   ~Run() = default;
 
@@ -16,9 +51,34 @@ class Run {
   Run(Run &&) = delete;
   Run &operator=(Run &&) = delete;
 
-  static void Execute(const std::string &source);
-  static void ExecutePrompt();
-  static void ExecuteFile(const std::string &path);
+  // Runs `source` on `engine` (an Interpreter or a VM) after constant
+  // folding. The tree is built in `arena`, and both have to live as long
+  // as the engine can still reach code from it.
+  template <typename E>
+  static void Execute(std::string_view source, const Options &options,
+                      Error &error, Arena &arena, E &engine);
+  // Runs `source` on `vm` from the bytecode cache, compiling and caching
+  // it first if the cache has no current copy
+  static void ExecuteCached(std::string_view source, const Options &options,
+                            Error &error, Arena &arena, VM &vm);
+  static void ExecutePrompt(const Options &options);
+  static void ExecuteFile(const std::string &path, const Options &options);
+  // Parses the value of `--engine=`
+  static Engine ParseEngine(std::string_view name);
+  // Parses the value of `--gc-max-pause=`, in milliseconds
+  static std::chrono::nanoseconds ParsePause(std::string_view milliseconds);
+  // Applies the collector options to an engine's heap
+  static void ConfigureHeap(Heap &heap, const Options &options);
+  static void PrintGcStats(const Heap &heap);
+  static void PrintCacheStats(const InlineCache::Stats &stats);
+  // Prints the token stream of a file or stdin ("-") without ever holding
+  // the whole input in memory
+  static void DumpTokens(const std::string &path);
+  // Parses a script and saves its tree as an AstFile at `output`
+  static void EmitAst(const std::string &path, const std::string &output);
+  // Checks many scripts in parallel, then prints each file's diagnostics
+  // in the order given and the aggregate throughput
+  static void ExecuteBatch(const std::vector<std::string> &paths);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,32 @@
+#ifndef SCAN_KERNELS_HPP
+#define SCAN_KERNELS_HPP
+
+#include <cstdint>
+
+// Bulk helpers for the scanner's byte loops: whitespace runs, comment
+// bodies and string bodies. All of them work on [begin, end), return the
+// position they stopped at (end when nothing was found) and add the
+// newlines they stepped over to `lines`.
+//
+// Get() picks the widest implementation the CPU supports the first time it
+// is called; the others stay reachable for tests and benchmarks.
+struct ScanKernels {
+  // First byte that is not ' ', '\t', '\r' or '\n'
+  const char *(*skip_whitespace)(const char *begin, const char *end,
+                                 uint32_t &lines);
+  // First '\n', which is left for the caller to consume
+  const char *(*find_newline)(const char *begin, const char *end);
+  // First '"'
+  const char *(*find_quote)(const char *begin, const char *end,
+                            uint32_t &lines);
+  const char *name;
+
+  static const ScanKernels &Get();
+
+  static const ScanKernels &Scalar();
+  // Null when the build target or the CPU lacks the instruction set
+  static const ScanKernels *Sse2();
+  static const ScanKernels *Avx2();
+};
+
+#endif
@@ -1,44 +1,69 @@
 #ifndef SCANNER_HPP
 #define SCANNER_HPP
 
-#include <robin_hood.h>
-
 #include <string>
+#include <string_view>
 
-#include "Token.hpp"
-
-using TokenVoid = Token<const void *>;
-using TokenString = Token<std::unique_ptr<const std::string>>;
-using TokenDouble = Token<std::unique_ptr<const double>>;
+#include "Error.hpp"
+#include "Keywords.hpp"
+#include "ScanKernels.hpp"
+#include "TokenBuffer.hpp"
 
+// The scanner does not copy its input: every token it emits refers back to
+// `in_source`, which has to stay alive for as long as the tokens are in use.
+// All scanning state lives in the instance, so separate scanners can run on
+// separate threads. Diagnostics go to `in_error`, or to a reporter owned by
+// the scanner when none is given.
 class Scanner {
  public:
-  explicit Scanner(const std::string &in_source);
+  explicit Scanner(std::string_view in_source = {}, Error *in_error = nullptr);
   ~Scanner() = default;
-  void ScanTokens();
-  inline bool IsAtEnd() {
-    return static_cast<size_t>(current) >= source.size();
+
+  // No copy
+  Scanner(const Scanner &) = delete;
+  Scanner &operator=(const Scanner &) = delete;
+
+  // No move
+  Scanner(Scanner &&) = delete;
+  Scanner &operator=(Scanner &&) = delete;
+
+  const TokenBuffer &ScanTokens();
+  // Scans one window of a longer input. Tokens that might continue past
+  // the window are left unscanned unless `last` is set, and the offset of
+  // the first unconsumed byte is returned so the caller can carry it over
+  // into the next window. Line numbers and an open comment carry over
+  // between calls; EOF is only emitted for the last window.
+  size_t ScanWindow(std::string_view window, bool last);
+  [[gnu::always_inline]] const TokenBuffer &GetTokens() const {
+    return tokens;
   }
+  [[gnu::always_inline]] const Error &GetError() const { return *error; }
+  // Value of a Lox number literal (digits with an optional fraction).
+  // Locale independent and allocation free; literals too large for a double
+  // become infinity and ones too small become zero.
+  static double ParseNumber(std::string_view lexeme);
+  inline bool IsAtEnd() { return current >= source.size(); }
 
  private:
-  inline char Advance() { return source.at(current++); }
+  // Callers check IsAtEnd() first, so none of these need source.at()
+  inline char Advance() { return source[current++]; }
   inline char Peek() {
     if (IsAtEnd()) {
       return '\0';
     }
-    return source.at(current);
+    return source[current];
   }
   inline char PeekNext() {
-    if (static_cast<size_t>(current) + 1 >= source.size()) {
+    if (current + 1 >= source.size()) {
       return '\0';
     }
-    return source.at(current + 1);
+    return source[current + 1];
   }
   inline bool Match(char expected) {
     if (IsAtEnd()) {
       return false;
     }
-    if (source.at(current) != expected) {
+    if (source[current] != expected) {
       return false;
     }
 
@@ -51,31 +76,40 @@ class Scanner {
   }
   inline bool IsAlphaNumeric(char c) { return (IsAlpha(c) || IsDigit(c)); }
 
+  // Whether the current token ran into the end of a window that is not the
+  // end of the input
+  inline bool Truncated() { return partial && IsAtEnd(); }
+  // Gives up on the current token so the next window rescans it
+  inline void Suspend() {
+    current = start;
+    line = start_line;
+    suspended = true;
+  }
+
   void ScanToken();
   void AddToken(const TokenType &type);
-  void AddToken(const TokenType &type, const void *literal);
-  void AddToken(const TokenType &type,
-                std::unique_ptr<const std::string> literal);
-  void AddToken(const TokenType &type, std::unique_ptr<const double> literal);
+  void AddToken(const TokenType &type, double literal);
+  void SkipWhitespace();
+  void SkipComment();
   void String();
   void Number();
   void Identifier();
 
  private:
-  inline static int start = 0;
-  inline static int current = 0;
-  inline static int line = 1;
+  size_t start = 0;
+  size_t current = 0;
+  uint32_t line = 1;
+
+  uint32_t start_line = 1;
+  bool partial = false;
+  bool suspended = false;
+  bool in_comment = false;
 
-  inline static robin_hood::unordered_flat_map<std::string, TokenType>
-      keywords = {{"and", TokenType::AND},       {"class", TokenType::CLASS},
-                  {"else", TokenType::ELSE},     {"false", TokenType::FALSE},
-                  {"for", TokenType::FOR},       {"fun", TokenType::FUN},
-                  {"if", TokenType::IF},         {"nil", TokenType::NIL},
-                  {"or", TokenType::OR},         {"print", TokenType::PRINT},
-                  {"return", TokenType::RETURN}, {"super", TokenType::SUPER},
-                  {"this", TokenType::THIS},     {"true", TokenType::TRUE},
-                  {"var", TokenType::VAR},       {"while", TokenType::WHILE}};
-  std::string source;
+  std::string_view source;
+  TokenBuffer tokens;
+  const ScanKernels &kernels = ScanKernels::Get();
+  Error own_error;
+  Error *error;
 };
 
 #endif
@@ -0,0 +1,84 @@
+#ifndef SHAPE_HPP
+#define SHAPE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "Interner.hpp"
+
+class ObjClass;
+
+// The layout shared by instances of one class that were given the same
+// fields in the same order: which slot holds which field. Each class owns
+// a root shape with no fields; adding a field moves an instance along a
+// transition to a child shape, made the first time any instance takes
+// that step and shared by every instance that follows. The tree of shapes
+// lives as long as its class, which every instance keeps alive.
+//
+// Instances that would need a shape past MAX_FIELDS, or a transition from
+// a shape that already has MAX_TRANSITIONS, leave the tree and keep their
+// fields in a table instead (dictionary mode).
+class Shape {
+ public:
+  static constexpr uint32_t MAX_FIELDS = 64;
+  static constexpr size_t MAX_TRANSITIONS = 8;
+  static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+  explicit Shape(ObjClass* klass);
+  ~Shape() = default;
+
+  // No copy
+  Shape(const Shape&) = delete;
+  Shape& operator=(const Shape&) = delete;
+
+  // No move
+  Shape(Shape&&) = delete;
+  Shape& operator=(Shape&&) = delete;
+
+  // Unique over the whole process, unlike the shape's address
+  [[gnu::always_inline]] uint64_t Id() const { return _id; }
+
+  [[gnu::always_inline]] ObjClass* GetClass() const { return _klass; }
+
+  [[gnu::always_inline]] uint32_t FieldCount() const {
+    return static_cast<uint32_t>(_names.size());
+  }
+
+  // Field names in slot order
+  [[gnu::always_inline]] std::span<const Symbol* const> Names() const {
+    return _names;
+  }
+
+  // The slot of field `name`, or NOT_FOUND
+  [[gnu::always_inline]] uint32_t Find(const Symbol* name) const {
+    for (size_t slot = 0; slot < _names.size(); slot++) {
+      if (_names[slot] == name) return static_cast<uint32_t>(slot);
+    }
+    return NOT_FOUND;
+  }
+
+  // The shape with field `name` added after this one's, or nullptr if the
+  // instance has to go to dictionary mode instead
+  Shape* Transition(const Symbol* name);
+
+  // Bytes held by this shape and every shape reachable from it
+  size_t TreeBytes() const;
+
+ private:
+  Shape(const Shape& parent, const Symbol* name);
+
+  static std::atomic<uint64_t> _next_id;
+
+  ObjClass* _klass;
+  uint64_t _id;
+  std::vector<const Symbol*> _names;
+  // Few enough that a linear scan beats hashing
+  std::vector<std::pair<const Symbol*, std::unique_ptr<Shape>>> _transitions;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef SOURCE_HPP
+#define SOURCE_HPP
+
+#include <string>
+#include <string_view>
+
+// Read-only view of a script's bytes. Regular files are memory mapped and
+// scanned in place; pipes, character devices and stdin ("-") fall back to
+// read() into an owned buffer.
+class Source {
+ public:
+  explicit Source(const std::string &path);
+  ~Source();
+
+  // No copy
+  Source(const Source &) = delete;
+  Source &operator=(const Source &) = delete;
+
+  Source(Source &&other) noexcept;
+  Source &operator=(Source &&other) = delete;
+
+  [[gnu::always_inline]] std::string_view View() const {
+    return {_data, _size};
+  }
+
+  [[gnu::always_inline]] bool IsMapped() const { return _mapped; }
+
+ private:
+  void Map(int fd, size_t size);
+  void ReadAll(int fd);
+
+  const char *_data = nullptr;
+  size_t _size = 0;
+  bool _mapped = false;
+  std::string _buffer;
+};
+
+#endif
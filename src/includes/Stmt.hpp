@@ -0,0 +1,262 @@
+#ifndef STMT_HPP
+#define STMT_HPP
+
+#include <cstdint>
+#include <span>
+
+#include "Expr.hpp"
+#include "Token.hpp"
+
+// Statements share the arena rules of Expr: trivially destructible, children
+// by pointer, lists as arena spans.
+
+// Forward Declarations
+class Block;
+class Class;
+class Expression;
+class Function;
+class If;
+class Print;
+class Return;
+class Var;
+class While;
+
+// ------------- STMT CLASS -------------
+class Stmt {
+ public:
+  enum class Kind : uint8_t {
+    BLOCK,
+    CLASS,
+    EXPRESSION,
+    FUNCTION,
+    IF,
+    PRINT,
+    RETURN,
+    VAR,
+    WHILE
+  };
+
+  template <typename R>
+  class Visitor {
+   public:
+    virtual R VisitBlockStmt(const Block& stmt) = 0;
+    virtual R VisitClassStmt(const Class& stmt) = 0;
+    virtual R VisitExpressionStmt(const Expression& stmt) = 0;
+    virtual R VisitFunctionStmt(const Function& stmt) = 0;
+    virtual R VisitIfStmt(const If& stmt) = 0;
+    virtual R VisitPrintStmt(const Print& stmt) = 0;
+    virtual R VisitReturnStmt(const Return& stmt) = 0;
+    virtual R VisitVarStmt(const Var& stmt) = 0;
+    virtual R VisitWhileStmt(const While& stmt) = 0;
+
+   protected:
+    ~Visitor() = default;
+  };
+
+  // Dispatches on the kind tag, so nodes need no vtable
+  template <typename R>
+  R Accept(Visitor<R>& visitor) const;
+
+  [[gnu::always_inline]] Kind GetKind() const { return _kind; }
+
+  // No copy
+  Stmt(const Stmt&) = delete;
+  Stmt& operator=(const Stmt&) = delete;
+
+ protected:
+  explicit Stmt(Kind kind) noexcept : _kind(kind) {}
+  Stmt(Stmt&& other) noexcept = default;
+  ~Stmt() = default;
+
+ private:
+  Kind _kind;
+};
+
+using StmtList = std::span<const Stmt* const>;
+using ParamList = std::span<const Token<>>;
+using MethodList = std::span<const Function* const>;
+
+// ------------- BLOCK CLASS -------------
+class Block : public Stmt {
+ public:
+  explicit Block(StmtList statements) noexcept;
+  Block(Block&& other) noexcept;
+
+  [[gnu::always_inline]] StmtList GetStatements() const { return _statements; }
+
+ private:
+  StmtList _statements;
+};
+
+// ------------- CLASS CLASS -------------
+class Class : public Stmt {
+ public:
+  Class(Token<>&& name, const Variable* superclass,
+        MethodList methods) noexcept;
+  Class(Class&& other) noexcept;
+
+  [[gnu::always_inline]] const Token<>* GetName() const { return &_name; }
+
+  // nullptr when the class has no superclass
+  [[gnu::always_inline]] const Variable* GetSuperclass() const {
+    return _superclass;
+  }
+
+  [[gnu::always_inline]] MethodList GetMethods() const { return _methods; }
+
+ private:
+  Token<> _name;
+  const Variable* _superclass;
+  MethodList _methods;
+};
+
+// ------------- EXPRESSION CLASS -------------
+class Expression : public Stmt {
+ public:
+  explicit Expression(const Expr* expression) noexcept;
+  Expression(Expression&& other) noexcept;
+
+  [[gnu::always_inline]] const Expr* GetExpr() const { return _expression; }
+
+ private:
+  const Expr* _expression;
+};
+
+// ------------- FUNCTION CLASS -------------
+class Function : public Stmt {
+ public:
+  Function(Token<>&& name, const Symbol* symbol, ParamList params,
+           StmtList body) noexcept;
+  Function(Function&& other) noexcept;
+
+  [[gnu::always_inline]] const Token<>* GetName() const { return &_name; }
+
+  // The name a method is looked up by
+  [[gnu::always_inline]] const Symbol* GetSymbol() const { return _symbol; }
+
+  [[gnu::always_inline]] ParamList GetParams() const { return _params; }
+
+  [[gnu::always_inline]] StmtList GetBody() const { return _body; }
+
+ private:
+  Token<> _name;
+  const Symbol* _symbol;
+  ParamList _params;
+  StmtList _body;
+};
+
+// ------------- IF CLASS -------------
+class If : public Stmt {
+ public:
+  If(const Expr* condition, const Stmt* then_branch,
+     const Stmt* else_branch) noexcept;
+  If(If&& other) noexcept;
+
+  [[gnu::always_inline]] const Expr* GetCondition() const {
+    return _condition;
+  }
+
+  [[gnu::always_inline]] const Stmt* GetThen() const { return _then_branch; }
+
+  // nullptr when there is no else branch
+  [[gnu::always_inline]] const Stmt* GetElse() const { return _else_branch; }
+
+ private:
+  const Expr* _condition;
+  const Stmt* _then_branch;
+  const Stmt* _else_branch;
+};
+
+// ------------- PRINT CLASS -------------
+class Print : public Stmt {
+ public:
+  explicit Print(const Expr* expression) noexcept;
+  Print(Print&& other) noexcept;
+
+  [[gnu::always_inline]] const Expr* GetExpr() const { return _expression; }
+
+ private:
+  const Expr* _expression;
+};
+
+// ------------- RETURN CLASS -------------
+class Return : public Stmt {
+ public:
+  Return(Token<>&& keyword, const Expr* value) noexcept;
+  Return(Return&& other) noexcept;
+
+  [[gnu::always_inline]] const Token<>* GetKeyword() const {
+    return &_keyword;
+  }
+
+  // nullptr for a bare `return;`
+  [[gnu::always_inline]] const Expr* GetValue() const { return _value; }
+
+ private:
+  Token<> _keyword;
+  const Expr* _value;
+};
+
+// ------------- VAR CLASS -------------
+class Var : public Stmt {
+ public:
+  Var(Token<>&& name, const Expr* initializer) noexcept;
+  Var(Var&& other) noexcept;
+
+  [[gnu::always_inline]] const Token<>* GetName() const { return &_name; }
+
+  // nullptr when the variable is declared without a value
+  [[gnu::always_inline]] const Expr* GetInitializer() const {
+    return _initializer;
+  }
+
+ private:
+  Token<> _name;
+  const Expr* _initializer;
+};
+
+// ------------- WHILE CLASS -------------
+class While : public Stmt {
+ public:
+  While(const Expr* condition, const Stmt* body) noexcept;
+  While(While&& other) noexcept;
+
+  [[gnu::always_inline]] const Expr* GetCondition() const {
+    return _condition;
+  }
+
+  [[gnu::always_inline]] const Stmt* GetBody() const { return _body; }
+
+ private:
+  const Expr* _condition;
+  const Stmt* _body;
+};
+
+// ------------- DISPATCH -------------
+template <typename R>
+[[gnu::always_inline]] inline R Stmt::Accept(Visitor<R>& visitor) const {
+  switch (_kind) {
+    case Kind::BLOCK:
+      return visitor.VisitBlockStmt(static_cast<const Block&>(*this));
+    case Kind::CLASS:
+      return visitor.VisitClassStmt(static_cast<const Class&>(*this));
+    case Kind::EXPRESSION:
+      return visitor.VisitExpressionStmt(
+          static_cast<const Expression&>(*this));
+    case Kind::FUNCTION:
+      return visitor.VisitFunctionStmt(static_cast<const Function&>(*this));
+    case Kind::IF:
+      return visitor.VisitIfStmt(static_cast<const If&>(*this));
+    case Kind::PRINT:
+      return visitor.VisitPrintStmt(static_cast<const Print&>(*this));
+    case Kind::RETURN:
+      return visitor.VisitReturnStmt(static_cast<const Return&>(*this));
+    case Kind::VAR:
+      return visitor.VisitVarStmt(static_cast<const Var&>(*this));
+    case Kind::WHILE:
+      return visitor.VisitWhileStmt(static_cast<const While&>(*this));
+  }
+  __builtin_unreachable();
+}
+
+#endif
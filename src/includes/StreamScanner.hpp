@@ -0,0 +1,47 @@
+#ifndef STREAM_SCANNER_HPP
+#define STREAM_SCANNER_HPP
+
+#include <functional>
+#include <string>
+
+#include "Scanner.hpp"
+
+// Scans a file descriptor of unknown length in fixed-size chunks and hands
+// every batch of complete tokens to a consumer as soon as it is scanned.
+// Only the current window is kept in memory: a chunk plus whatever token
+// was cut off at the end of the previous one. So peak memory follows the
+// chunk size (or the longest single token) rather than the input size.
+class StreamScanner {
+ public:
+  // The batch and its lexemes are only valid during the call
+  using Consumer = std::function<void(const TokenBuffer &)>;
+
+  explicit StreamScanner(int fd, size_t chunk_size = 64 * 1024,
+                         Error *error = nullptr);
+  ~StreamScanner() = default;
+
+  // No copy
+  StreamScanner(const StreamScanner &) = delete;
+  StreamScanner &operator=(const StreamScanner &) = delete;
+
+  void ScanTokens(const Consumer &consumer);
+
+  [[gnu::always_inline]] const Error &GetError() const {
+    return _scanner.GetError();
+  }
+
+  [[gnu::always_inline]] size_t GetPeakWindowSize() const {
+    return _peak_window;
+  }
+
+ private:
+  size_t Read(char *into, size_t size);
+
+  int _fd;
+  size_t _chunk_size;
+  size_t _peak_window = 0;
+  std::string _window;
+  Scanner _scanner;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers, each with its own task deque. A worker takes new
+// work from the back of its own deque and, once that runs dry, steals from
+// the front of the others, so a few slow tasks don't leave threads idle.
+class ThreadPool {
+ public:
+  using Task = std::function<void()>;
+
+  explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+  ~ThreadPool();
+
+  // No copy
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // No move
+  ThreadPool(ThreadPool &&) = delete;
+  ThreadPool &operator=(ThreadPool &&) = delete;
+
+  // Tasks must not throw. Tasks submitted from a worker go to that worker's
+  // own deque
+  void Submit(Task task);
+  // Blocks until every submitted task has finished
+  void Wait();
+
+  [[gnu::always_inline]] size_t Size() const { return _threads.size(); }
+
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  bool Pop(size_t self, Task &task);
+  bool Steal(size_t self, Task &task);
+  void Loop(size_t self);
+
+  std::vector<std::unique_ptr<Worker>> _workers;
+  std::vector<std::thread> _threads;
+
+  std::mutex _mutex;
+  std::condition_variable _wake;
+  std::condition_variable _idle;
+  std::atomic<size_t> _queued = 0;
+  std::atomic<size_t> _pending = 0;
+  std::atomic<size_t> _next = 0;
+  bool _stop = false;
+};
+
+#endif
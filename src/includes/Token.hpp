@@ -3,10 +3,12 @@
 
 #include <fmt/core.h>
 
+#include <cstdint>
 #include <memory>
-#include <vector>
+#include <string_view>
+#include <type_traits>
 
-enum class TokenType {
+enum class TokenType : uint8_t {
   // Single-character tokens.
   LEFT_PAREN,
   RIGHT_PAREN,
@@ -82,26 +84,28 @@ struct formatter<TokenType> {
 };
 }  // namespace fmt
 
-template <typename T>
+// The lexeme is a view into the scanned source, so the source buffer must
+// outlive every token that was produced from it.
+template <typename T = std::nullptr_t>
 class Token {
  public:
   const TokenType type = TokenType::TEOF;
-  const std::string lexeme = "";
+  const std::string_view lexeme = "";
   T literal;
   const unsigned int line = 0;
 
-  Token(TokenType in_token, const std::string &in_lexeme, const T &in_literal,
+  Token(TokenType in_token, std::string_view in_lexeme, const T &in_literal,
         unsigned int in_line)
       : type(in_token), lexeme(in_lexeme), literal(in_literal), line(in_line) {}
-  Token(TokenType in_token, std::string &&in_lexeme, T &&in_literal,
+  Token(TokenType in_token, std::string_view in_lexeme, T &&in_literal,
         unsigned int in_line)
       : type(in_token),
-        lexeme(std::move(in_lexeme)),
+        lexeme(in_lexeme),
         literal(std::move(in_literal)),
         line(in_line) {}
   Token(Token &&input)
       : type(std::move(input.type)),
-        lexeme(std::move(input.lexeme)),
+        lexeme(input.lexeme),
         literal(std::move(input.literal)),
         line(std::move(input.line)) {}
   Token(const Token &input) = delete;
@@ -109,13 +113,11 @@ class Token {
   Token() = default;
   ~Token() = default;
 
-  static inline auto GetTokens() { return &tokens; }
-
-  static inline void ClearTokens() { tokens.clear(); }
-
   inline std::string ToString() const {
     if constexpr (std::is_same_v<T, std::nullptr_t>) {
       return fmt::format("{} {}", type, lexeme);
+    } else if constexpr (std::is_same_v<T, std::string_view>) {
+      return fmt::format("{} {} {}", type, lexeme, literal);
     } else {
       return fmt::format("{} {} {}", type, lexeme, *literal);
     }
@@ -125,11 +127,6 @@ class Token {
     stream << data.ToString();
     return stream;
   }
-
-  static std::vector<std::unique_ptr<Token<T>>> tokens;
 };
 
-template <typename T>
-std::vector<std::unique_ptr<Token<T>>> Token<T>::tokens;
-
 #endif
\ No newline at end of file
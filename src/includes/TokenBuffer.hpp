@@ -0,0 +1,85 @@
+#ifndef TOKEN_BUFFER_HPP
+#define TOKEN_BUFFER_HPP
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "Token.hpp"
+
+// All tokens of one scan, in source order, stored as parallel arrays.
+// A token is its index: type, offset, length and line live in separate
+// contiguous vectors, and lexemes are recovered by slicing the source
+// (which has to outlive the buffer). Number literals are the only values
+// that cannot be recovered from the lexeme cheaply, so they are kept in a
+// side table sorted by token index.
+class TokenBuffer {
+ public:
+  TokenBuffer() = default;
+  explicit TokenBuffer(std::string_view source) : _source(source) {}
+
+  [[gnu::always_inline]] void Push(TokenType type, uint32_t offset,
+                                   uint32_t length, uint32_t line) {
+    _types.push_back(type);
+    _offsets.push_back(offset);
+    _lengths.push_back(length);
+    _lines.push_back(line);
+  }
+
+  [[gnu::always_inline]] void PushNumber(uint32_t offset, uint32_t length,
+                                         uint32_t line, double value) {
+    _number_tokens.push_back(static_cast<uint32_t>(_types.size()));
+    _numbers.push_back(value);
+    Push(TokenType::NUMBER, offset, length, line);
+  }
+
+  [[gnu::always_inline]] size_t Size() const { return _types.size(); }
+
+  [[gnu::always_inline]] TokenType Type(size_t index) const {
+    return _types[index];
+  }
+
+  [[gnu::always_inline]] uint32_t Line(size_t index) const {
+    return _lines[index];
+  }
+
+  [[gnu::always_inline]] std::string_view Lexeme(size_t index) const {
+    return _source.substr(_offsets[index], _lengths[index]);
+  }
+
+  // Value of a STRING token: the lexeme without its surrounding quotes
+  [[gnu::always_inline]] std::string_view String(size_t index) const {
+    return _source.substr(_offsets[index] + 1, _lengths[index] - 2);
+  }
+
+  // Value of a NUMBER token
+  double Number(size_t index) const;
+
+  // Materialises a standalone token, e.g. for error messages
+  [[gnu::always_inline]] Token<std::nullptr_t> Get(size_t index) const {
+    return Token<std::nullptr_t>(Type(index), Lexeme(index), nullptr,
+                                 Line(index));
+  }
+
+  [[gnu::always_inline]] std::string_view GetSource() const { return _source; }
+
+  void Reset(std::string_view source);
+  void Reserve(size_t count);
+  void ShrinkToFit();
+
+  // Bytes reserved by the arrays and the literal side table
+  size_t MemoryUsage() const;
+
+ private:
+  std::string_view _source;
+
+  std::vector<TokenType> _types;
+  std::vector<uint32_t> _offsets;
+  std::vector<uint32_t> _lengths;
+  std::vector<uint32_t> _lines;
+
+  std::vector<uint32_t> _number_tokens;
+  std::vector<double> _numbers;
+};
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Records where a run spends its time, as nested spans and counter
+// samples, and writes them in the Chrome trace_event JSON format that
+// chrome://tracing and Perfetto open.
+//
+// At most one Tracer is active at a time, from its construction to its
+// destruction; instrumented code finds it through Active(). With none
+// active, a TraceSpan costs a load and a predicted branch, so the spans
+// stay compiled in. Spans nest on one thread: the tracer is not for the
+// worker threads of a batch run.
+class Tracer {
+ public:
+  // Becomes the active tracer
+  explicit Tracer(std::string path);
+  ~Tracer();
+
+  // No copy
+  Tracer(const Tracer&) = delete;
+  Tracer& operator=(const Tracer&) = delete;
+
+  // No move
+  Tracer(Tracer&&) = delete;
+  Tracer& operator=(Tracer&&) = delete;
+
+  [[gnu::always_inline]] static Tracer* Active() { return _active; }
+
+  // Opens a span inside the innermost open one. `category` groups spans
+  // in the viewer: "phase" for pipeline stages, "function" for Lox calls,
+  // "gc" for collector pauses.
+  void Begin(std::string_view name, const char* category);
+  // Closes the innermost open span
+  void End();
+  // Closes spans until only `depth` are open, for code that abandons
+  // calls without returning from them, like the VM on a runtime error
+  void Unwind(size_t depth);
+  [[gnu::always_inline]] size_t Depth() const { return _depth; }
+
+  // Samples the counter `name`; the viewer plots it as a track over time
+  void Count(std::string_view name, double value);
+
+  // Closes any spans still open and writes the trace to the path given
+  // on construction; throws std::runtime_error if it cannot
+  void Write();
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Event {
+    // 'B'egin, 'E'nd or 'C'ounter
+    char phase;
+    const char* category;
+    std::string name;
+    std::chrono::nanoseconds time;
+    double value;
+  };
+
+  [[gnu::always_inline]] std::chrono::nanoseconds Now() const {
+    return Clock::now() - _start;
+  }
+
+  static inline Tracer* _active = nullptr;
+
+  std::string _path;
+  Clock::time_point _start;
+  std::vector<Event> _events;
+  size_t _depth = 0;
+  Tracer* _previous;
+};
+
+// Traces the enclosing scope as a span of the active tracer, if any,
+// closing it however the scope is left
+class TraceSpan {
+ public:
+  [[gnu::always_inline]] explicit TraceSpan(std::string_view name,
+                                            const char* category = "phase")
+      : _tracer(Tracer::Active()) {
+    if (_tracer != nullptr) [[unlikely]] {
+      _tracer->Begin(name, category);
+    }
+  }
+
+  [[gnu::always_inline]] ~TraceSpan() {
+    if (_tracer != nullptr) [[unlikely]] {
+      _tracer->End();
+    }
+  }
+
+  // No copy
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+  // No move
+  TraceSpan(TraceSpan&&) = delete;
+  TraceSpan& operator=(TraceSpan&&) = delete;
+
+ private:
+  Tracer* _tracer;
+};
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef VM_HPP
+#define VM_HPP
+
+#include <robin_hood.h>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "Chunk.hpp"
+#include "Error.hpp"
+#include "Heap.hpp"
+#include "Object.hpp"
+#include "Stmt.hpp"
+#include "Value.hpp"
+
+// Threaded dispatch through a table of label addresses where the compiler
+// supports it (GCC and Clang); define CPPLOX_SWITCH_DISPATCH to force the
+// portable switch loop instead.
+#if defined(__GNUC__) && !defined(CPPLOX_SWITCH_DISPATCH)
+#define CPPLOX_COMPUTED_GOTO 1
+#endif
+
+class BytecodeCache;
+class Compiler;
+
+// Compiles statements to bytecode and runs them on a value stack. Globals
+// and the objects they reach persist across Interpret() calls, like the
+// tree-walker's, so the statements and their source have to outlive the
+// VM. The collector's roots are the stack, the frames, open upvalues,
+// globals and, while compiling, the functions being compiled.
+class VM : private Heap::Roots {
+ public:
+  explicit VM(Error& error, std::ostream& out = std::cout);
+  ~VM() = default;
+
+  // No copy
+  VM(const VM&) = delete;
+  VM& operator=(const VM&) = delete;
+
+  // No move
+  VM(VM&&) = delete;
+  VM& operator=(VM&&) = delete;
+
+  // Compile errors are reported and nothing runs; a runtime error stops
+  // the script and is reported through `error`
+  void Interpret(StmtList statements);
+
+  // The script compiled but not run, or nullptr after reporting a compile
+  // error. Nothing keeps it alive: it has to be run before anything else
+  // is allocated on the VM's heap.
+  ObjProto* Compile(StmtList statements);
+  // The script `cache` holds for `source`, or nullptr; as for Compile()
+  ObjProto* Load(BytecodeCache& cache, std::string_view source);
+  // Runs a script from Compile() or Load()
+  void Interpret(ObjProto* script);
+
+  [[gnu::always_inline]] Heap& GetHeap() { return _heap; }
+  [[gnu::always_inline]] const Heap& GetHeap() const { return _heap; }
+
+  // Hits and misses of the method caches at property and call sites
+  [[gnu::always_inline]] const InlineCache::Stats& GetCacheStats() const {
+    return _cache_stats;
+  }
+
+ private:
+  struct CallFrame {
+    ObjClosure* closure;
+    const uint8_t* ip;
+    // First stack slot of the frame: the callee, then its arguments
+    Value* slots;
+  };
+
+  static constexpr size_t FRAMES_MAX = 64;
+  static constexpr size_t STACK_MAX = FRAMES_MAX * 256;
+
+  [[gnu::always_inline]] void Push(Value value) { *_sp++ = value; }
+
+  [[gnu::always_inline]] Value Pop() { return *--_sp; }
+
+  [[gnu::always_inline]] Value Peek(size_t distance) const {
+    return _sp[-1 - static_cast<ptrdiff_t>(distance)];
+  }
+
+  // False after reporting a runtime error
+  bool Run();
+  // `cache` is the call site's, for finding a class's initializer; null
+  // looks it up uncached
+  bool CallValue(Value callee, uint8_t argc, InlineCache* cache);
+  bool Call(ObjClosure* closure, uint8_t argc);
+  // Looks up property `name` of the receiver on top of the stack before a
+  // call's arguments are pushed, without binding it if it is a method.
+  // The receiver stays as the method's `this` and the method is pushed
+  // over it; a field replaces the receiver, with nil pushed over it.
+  bool GetMethod(const Symbol* name, InlineCache& cache);
+  // Drops the slot GetMethod pushed under the `argc` arguments on top of
+  // the stack and calls what it held, or the field below it
+  bool Invoke(uint8_t argc);
+  // Replaces the receiver on top of the stack with `method` bound to it;
+  // a null `method` means the receiver has no property `name`
+  bool BindMethod(Obj* method, const Symbol* name);
+  ObjUpvalue* CaptureUpvalue(Value* local);
+  void CloseUpvalues(const Value* last);
+
+  void RuntimeError(const std::string& message);
+  void MarkRoots(Heap& heap) override;
+  void ResetStack();
+
+  Error& _error;
+  std::ostream& _out;
+  Heap _heap;
+
+  std::unique_ptr<Value[]> _stack;
+  Value* _sp;
+  std::array<CallFrame, FRAMES_MAX> _frames;
+  size_t _frame_count = 0;
+  ObjUpvalue* _open_upvalues = nullptr;
+
+  robin_hood::unordered_flat_map<const Symbol*, Value, SymbolHash> _globals;
+  // Set while statements are compiled
+  Compiler* _compiler = nullptr;
+  // Set while a script is loaded from it
+  BytecodeCache* _loader = nullptr;
+  InlineCache::Stats _cache_stats;
+  const Symbol* _init = Interner::Global().Intern("init");
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef VALUE_HPP
+#define VALUE_HPP
+
+#include <cstdint>
+#include <cstring>
+
+class Obj;
+
+// A Lox value in 8 bytes. Numbers are stored as their IEEE-754 bits; every
+// other value is encoded in the payload of a quiet NaN that arithmetic never
+// produces:
+//   nil, false, true  QNAN | 1, 2, 3
+//   object            SIGN | QNAN | pointer (the low 48 bits)
+// Boxing and unboxing are bit operations, so number arithmetic never
+// allocates or branches on anything but the tag test.
+class Value {
+ public:
+  constexpr Value() : _bits(QNAN | TAG_NIL) {}
+
+  [[gnu::always_inline]] static constexpr Value Nil() { return Value(); }
+
+  [[gnu::always_inline]] static constexpr Value Bool(bool b) {
+    return Value(b ? TRUE_BITS : FALSE_BITS);
+  }
+
+  [[gnu::always_inline]] static Value Number(double number) {
+    uint64_t bits;
+    std::memcpy(&bits, &number, sizeof(bits));
+    return Value(bits);
+  }
+
+  [[gnu::always_inline]] static Value Object(const Obj* object) {
+    return Value(SIGN_BIT | QNAN | reinterpret_cast<uintptr_t>(object));
+  }
+
+  [[gnu::always_inline]] bool IsNil() const {
+    return _bits == (QNAN | TAG_NIL);
+  }
+
+  [[gnu::always_inline]] bool IsBool() const {
+    return (_bits | 1) == TRUE_BITS;
+  }
+
+  [[gnu::always_inline]] bool IsNumber() const {
+    return (_bits & QNAN) != QNAN;
+  }
+
+  [[gnu::always_inline]] bool IsObject() const {
+    return (_bits & (QNAN | SIGN_BIT)) == (QNAN | SIGN_BIT);
+  }
+
+  [[gnu::always_inline]] bool AsBool() const { return _bits == TRUE_BITS; }
+
+  [[gnu::always_inline]] double AsNumber() const {
+    double number;
+    std::memcpy(&number, &_bits, sizeof(number));
+    return number;
+  }
+
+  [[gnu::always_inline]] Obj* AsObject() const {
+    return reinterpret_cast<Obj*>(
+        static_cast<uintptr_t>(_bits & ~(SIGN_BIT | QNAN)));
+  }
+
+  // nil and false are falsey, everything else is truthy
+  [[gnu::always_inline]] bool IsFalsey() const {
+    return IsNil() || _bits == FALSE_BITS;
+  }
+
+  [[gnu::always_inline]] uint64_t Bits() const { return _bits; }
+
+ private:
+  static constexpr uint64_t SIGN_BIT = 0x8000000000000000;
+  static constexpr uint64_t QNAN = 0x7ffc000000000000;
+  static constexpr uint64_t TAG_NIL = 1;
+  static constexpr uint64_t TAG_FALSE = 2;
+  static constexpr uint64_t TAG_TRUE = 3;
+  static constexpr uint64_t FALSE_BITS = QNAN | TAG_FALSE;
+  static constexpr uint64_t TRUE_BITS = QNAN | TAG_TRUE;
+
+  constexpr explicit Value(uint64_t bits) : _bits(bits) {}
+
+  uint64_t _bits;
+};
+
+static_assert(sizeof(Value) == 8, "Values are NaN-boxed into 64 bits");
+
+#endif
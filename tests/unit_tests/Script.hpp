@@ -0,0 +1,63 @@
+#ifndef SCRIPT_HPP
+#define SCRIPT_HPP
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "Arena.hpp"
+#include "Error.hpp"
+#include "Interpreter.hpp"
+#include "Parser.hpp"
+#include "Scanner.hpp"
+#include "VM.hpp"
+
+// Both engines have to agree on every script
+using Engines = ::testing::Types<Interpreter, VM>;
+
+// A program and the engine E that runs it. The engine is there to set up
+// before Run() and to inspect after it; the statements live as long as
+// the script, as does the source their tokens point into.
+template <typename E>
+class Script {
+ public:
+  // Scans and parses `source`
+  explicit Script(std::string source) : _source(std::move(source)) {
+    Scanner scanner(_source, &_error);
+    Parser parser(scanner.ScanTokens(), _arena, _error);
+    _statements = parser.Parse();
+  }
+
+  // Runs statements parsed elsewhere, which have to outlive the script
+  explicit Script(StmtList statements) : _statements(statements) {}
+
+  // No copy
+  Script(const Script &) = delete;
+  Script &operator=(const Script &) = delete;
+
+  // Interprets the program and returns what it printed, runtime errors
+  // included. A syntax error fails the test and nothing runs.
+  std::string Run() {
+    EXPECT_FALSE(_error.had_error) << _out.str();
+    if (_error.had_error) {
+      return "";
+    }
+    _engine.Interpret(_statements);
+    return _out.str();
+  }
+
+  [[gnu::always_inline]] E &GetEngine() { return _engine; }
+  [[gnu::always_inline]] StmtList GetStatements() const { return _statements; }
+
+ private:
+  std::ostringstream _out;
+  Error _error{_out};
+  std::string _source;
+  Arena _arena;
+  StmtList _statements;
+  E _engine{_error, _out};
+};
+
+#endif
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "Arena.hpp"
+
+namespace {
+
+struct Pair {
+  int32_t a;
+  double b;
+};
+
+struct Big {
+  char bytes[1000];
+};
+
+TEST(ARENA_TESTS, Objects_are_aligned_and_distinct) {
+  Arena arena(64);
+
+  auto *c = arena.Make<char>('x');
+  auto *p = arena.Make<Pair>(Pair{1, 2.5});
+  auto *q = arena.Make<Pair>(Pair{3, 4.5});
+
+  EXPECT_EQ('x', *c);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(p) % alignof(Pair));
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(q) % alignof(Pair));
+  EXPECT_EQ(1, p->a);
+  EXPECT_EQ(3, q->a);
+  EXPECT_NE(p, q);
+}
+
+TEST(ARENA_TESTS, Grows_past_block_size) {
+  Arena arena(64);
+  std::vector<Pair *> pairs;
+
+  for (int i = 0; i < 1000; i++) {
+    pairs.push_back(arena.Make<Pair>(Pair{i, 0.0}));
+  }
+  auto *big = arena.Make<Big>();
+
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(i, pairs[i]->a);
+  }
+  EXPECT_NE(nullptr, big);
+  EXPECT_GE(arena.BytesUsed(), 1000 * sizeof(Pair) + 1000);
+}
+
+TEST(ARENA_TESTS, Reset_reuses_the_first_block) {
+  Arena arena(1024);
+
+  auto *first = arena.Make<Pair>(Pair{1, 1.0});
+  for (int i = 0; i < 1000; i++) {
+    arena.Make<Pair>(Pair{i, 0.0});
+  }
+  EXPECT_GT(arena.BytesReserved(), 1024u);
+
+  arena.Reset();
+
+  EXPECT_EQ(0u, arena.BytesUsed());
+  EXPECT_EQ(1024u, arena.BytesReserved());
+  EXPECT_EQ(first, arena.Make<Pair>(Pair{2, 2.0}));
+}
+
+TEST(ARENA_TESTS, Copies_arrays_and_strings) {
+  Arena arena;
+  std::vector<int> items = {1, 2, 3};
+
+  auto span = arena.CopyArray(items);
+  items[0] = 42;
+  auto text = arena.CopyString("hello");
+
+  ASSERT_EQ(3u, span.size());
+  EXPECT_EQ(1, span[0]);
+  EXPECT_EQ(3, span[2]);
+  EXPECT_TRUE(arena.CopyArray(std::vector<int>{}).empty());
+  EXPECT_EQ("hello", text);
+
+  // Nothing to copy, and maybe no block to copy it into yet
+  Arena empty;
+  EXPECT_TRUE(empty.CopyString("").empty());
+  EXPECT_EQ(0u, empty.BytesReserved());
+}
+
+TEST(ARENA_TESTS, Moved_from_arenas_start_over) {
+  Arena arena(64);
+  auto *first = arena.Make<Pair>(Pair{1, 1.0});
+
+  Arena moved(std::move(arena));
+  EXPECT_EQ(0u, arena.BytesUsed());
+  EXPECT_EQ(0u, arena.BytesReserved());
+  EXPECT_EQ(sizeof(Pair), moved.BytesUsed());
+
+  // Neither may write into the other's block
+  auto *theirs = moved.Make<Pair>(Pair{2, 2.0});
+  auto *ours = arena.Make<Pair>(Pair{3, 3.0});
+  EXPECT_NE(theirs, ours);
+  EXPECT_EQ(1, first->a);
+  EXPECT_EQ(2, theirs->a);
+
+  Arena assigned;
+  assigned = std::move(moved);
+  EXPECT_EQ(0u, moved.BytesUsed());
+  EXPECT_EQ(0u, moved.BytesReserved());
+  EXPECT_NE(theirs + 1, moved.Make<Pair>(Pair{4, 4.0}));
+  EXPECT_EQ(2 * sizeof(Pair), assigned.BytesUsed());
+}
+
+}  // namespace
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "BytecodeCache.hpp"
+#include "Parser.hpp"
+#include "Scanner.hpp"
+#include "VM.hpp"
+
+namespace {
+
+const std::string PROGRAM =
+    "class Greeter {\n"
+    "  init(name) { this.name = name; }\n"
+    "  greet() { return \"hi \" + this.name; }\n"
+    "}\n"
+    "class Loud < Greeter {\n"
+    "  greet() { return super.greet() + \"!\"; }\n"
+    "}\n"
+    "fun counter() {\n"
+    "  var count = 0;\n"
+    "  fun next() { count = count + 1; return count; }\n"
+    "  return next;\n"
+    "}\n"
+    "var next = counter();\n"
+    "next();\n"
+    "print next() * 1.5;\n"
+    "print Loud(\"lox\").greet();\n"
+    "print nil + 1;\n";
+
+const std::string OUTPUT =
+    "3\n"
+    "hi lox!\n"
+    "Operands must be two numbers or two strings.\n[line 17]\n";
+
+class BYTECODE_CACHE_TESTS : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    char path[] = "/tmp/cpplox_cache_XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(path));
+    _directory = path;
+  }
+
+  void TearDown() override { std::filesystem::remove_all(_directory); }
+
+  // Compiles `source` on a fresh VM, caches it and runs it
+  std::string Compile(const std::string &source) {
+    std::ostringstream out;
+    Error error(out);
+    Scanner scanner(source, &error);
+    Arena arena;
+    Parser parser(scanner.ScanTokens(), arena, error);
+    StmtList statements = parser.Parse();
+
+    VM vm(error, out);
+    ObjProto *script = vm.Compile(statements);
+    EXPECT_NE(nullptr, script);
+    BytecodeCache cache(_directory);
+    EXPECT_TRUE(cache.Store(source, *script));
+    vm.Interpret(script);
+    return out.str();
+  }
+
+  // Runs the cached `source` on a fresh VM; "miss" if it is not cached
+  std::string Load(const std::string &source, bool stress = false) {
+    std::ostringstream out;
+    Error error(out);
+    VM vm(error, out);
+    vm.GetHeap().SetStressMode(stress);
+    BytecodeCache cache(_directory);
+    ObjProto *script = vm.Load(cache, source);
+    if (script == nullptr) return "miss";
+    vm.Interpret(script);
+    return out.str();
+  }
+
+  std::string PathFor(const std::string &source) {
+    return BytecodeCache(_directory).PathFor(source);
+  }
+
+  std::string _directory;
+};
+
+TEST_F(BYTECODE_CACHE_TESTS, Warm_start_runs_the_cached_script) {
+  EXPECT_EQ(OUTPUT, Compile(PROGRAM));
+  EXPECT_TRUE(std::filesystem::exists(PathFor(PROGRAM)));
+  // Line numbers come back with the code
+  EXPECT_EQ(OUTPUT, Load(PROGRAM));
+}
+
+TEST_F(BYTECODE_CACHE_TESTS, Loading_survives_collection) {
+  Compile(PROGRAM);
+  EXPECT_EQ(OUTPUT, Load(PROGRAM, true));
+}
+
+TEST_F(BYTECODE_CACHE_TESTS, Changed_sources_miss) {
+  Compile(PROGRAM);
+  EXPECT_EQ("miss", Load(PROGRAM + "print 1;\n"));
+  EXPECT_EQ("miss", Load(""));
+}
+
+TEST_F(BYTECODE_CACHE_TESTS, Damaged_files_are_ignored) {
+  Compile(PROGRAM);
+  std::string path = PathFor(PROGRAM);
+  auto size = std::filesystem::file_size(path);
+
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    auto last = static_cast<std::streamoff>(size - 1);
+    file.seekg(last);
+    char byte = static_cast<char>(file.get());
+    file.seekp(last);
+    file.put(static_cast<char>(~byte));
+  }
+  EXPECT_EQ("miss", Load(PROGRAM));
+
+  std::filesystem::resize_file(path, size / 2);
+  EXPECT_EQ("miss", Load(PROGRAM));
+
+  // Compiling again replaces it
+  Compile(PROGRAM);
+  EXPECT_EQ(OUTPUT, Load(PROGRAM));
+}
+
+TEST_F(BYTECODE_CACHE_TESTS, Files_are_named_by_content) {
+  EXPECT_EQ(PathFor("print 1;"), PathFor(std::string("print 1;")));
+  EXPECT_NE(PathFor("print 1;"), PathFor("print 2;"));
+  EXPECT_TRUE(PathFor("print 1;").ends_with(".loxc"));
+}
+
+}  // namespace
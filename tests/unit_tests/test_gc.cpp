@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "Heap.hpp"
+#include "Script.hpp"
+
+namespace {
+
+class TestRoots : public Heap::Roots {
+ public:
+  void MarkRoots(Heap &heap) override {
+    for (Value value : values) {
+      heap.Mark(value);
+    }
+  }
+
+  std::vector<Value> values;
+};
+
+TEST(GC_TESTS, Frees_what_the_roots_do_not_reach) {
+  Heap heap;
+  TestRoots roots;
+  heap.SetRoots(&roots);
+
+  auto *klass = heap.Make<ObjClass>("Point", nullptr);
+  auto *kept = heap.Make<ObjInstance>(klass);
+  kept->SetField(Interner::Global().Intern("name"),
+                 Value::Object(heap.Make<ObjString>("kept")));
+  heap.Make<ObjInstance>(klass);
+  heap.Make<ObjString>("garbage");
+  roots.values.push_back(Value::Object(kept));
+  ASSERT_EQ(5u, heap.ObjectCount());
+
+  heap.Collect();
+  // The instance keeps its class and its field's string
+  EXPECT_EQ(3u, heap.ObjectCount());
+  EXPECT_EQ(1u, heap.GetStats().collections);
+  EXPECT_EQ(2u, heap.GetStats().objects_freed);
+  EXPECT_GT(heap.GetStats().bytes_freed, 0u);
+  EXPECT_EQ("kept", Stringify(*kept->FindField(
+                        Interner::Global().Intern("name"))));
+
+  roots.values.clear();
+  heap.Collect();
+  EXPECT_EQ(0u, heap.ObjectCount());
+  EXPECT_EQ(0u, heap.BytesAllocated());
+}
+
+TEST(GC_TESTS, Nothing_is_collected_without_roots) {
+  Heap heap;
+  heap.Make<ObjString>("unrooted");
+  heap.Collect();
+  EXPECT_EQ(1u, heap.ObjectCount());
+  EXPECT_EQ(0u, heap.GetStats().collections);
+}
+
+TEST(GC_TESTS, Interned_strings_are_not_roots) {
+  Heap heap;
+  TestRoots roots;
+  heap.SetRoots(&roots);
+
+  const Symbol *symbol = Interner::Global().Intern("weak");
+  heap.Intern(symbol);
+  heap.Collect();
+  EXPECT_EQ(0u, heap.ObjectCount());
+
+  // Made again on the next use
+  ObjString *string = heap.Intern(symbol);
+  EXPECT_EQ("weak", string->View());
+  roots.values.push_back(Value::Object(string));
+  heap.Collect();
+  EXPECT_EQ(string, heap.Intern(symbol));
+}
+
+TEST(GC_TESTS, Threshold_follows_the_live_heap) {
+  Heap heap;
+  TestRoots roots;
+  heap.SetRoots(&roots);
+
+  for (int i = 0; i < 100000; i++) {
+    heap.Make<ObjString>(std::string(64, 'x'));
+  }
+  EXPECT_GT(heap.GetStats().collections, 0u);
+  // Nothing is rooted, so each collection starts over from the minimum
+  EXPECT_LT(heap.BytesAllocated(), 2u * 1024 * 1024);
+}
+
+TEST(GC_TESTS, Barriers_keep_stores_made_while_marking) {
+  Heap heap;
+  TestRoots roots;
+  heap.SetRoots(&roots);
+  // The smallest slice on every allocation, so cycles span many of them
+  heap.SetMaxPause(std::chrono::milliseconds(1));
+  heap.SetStressMode(true);
+
+  auto *klass = heap.Make<ObjClass>("Bag", nullptr);
+  auto *bag = heap.Make<ObjInstance>(klass);
+  roots.values.push_back(Value::Object(bag));
+  std::vector<const Symbol *> names;
+  for (int i = 0; i < 1000; i++) {
+    names.push_back(Interner::Global().Intern("item" + std::to_string(i)));
+    // Only the bag references the string once Make() returns
+    Value item = Value::Object(heap.Make<ObjString>(std::to_string(i)));
+    bag->SetField(names.back(), item);
+    heap.WriteBarrier(bag, item);
+    heap.Make<ObjString>("garbage");
+  }
+  EXPECT_GT(heap.GetStats().collections, 1u);
+  EXPECT_GT(heap.GetStats().pause_count, heap.GetStats().collections);
+  // Only counted unless asked for
+  EXPECT_TRUE(heap.GetStats().pauses.empty());
+
+  heap.Collect();
+  EXPECT_EQ(1002u, heap.ObjectCount());
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(std::to_string(i), Stringify(*bag->FindField(names[i])));
+  }
+}
+
+TEST(GC_TESTS, Pause_percentiles) {
+  Heap::Stats stats;
+  EXPECT_EQ(std::chrono::nanoseconds(0), stats.Percentile(0.5));
+  for (int i = 100; i > 0; i--) {
+    stats.pauses.push_back(std::chrono::nanoseconds(i));
+  }
+  EXPECT_EQ(std::chrono::nanoseconds(50), stats.Percentile(0.50));
+  EXPECT_EQ(std::chrono::nanoseconds(99), stats.Percentile(0.99));
+  EXPECT_EQ(std::chrono::nanoseconds(100), stats.Percentile(1.0));
+
+  Heap heap;
+  TestRoots roots;
+  heap.SetRoots(&roots);
+  heap.SetRecordPauses(true);
+  heap.Collect();
+  heap.Collect();
+  EXPECT_EQ(2u, heap.GetStats().pause_count);
+  EXPECT_EQ(2u, heap.GetStats().pauses.size());
+}
+
+// Runs `source` on engine E with the collector in stress mode, incremental
+// when `max_pause` is set
+template <typename E>
+std::string RunStressed(const std::string &source,
+                        std::chrono::nanoseconds max_pause,
+                        size_t *collections) {
+  Script<E> script(source);
+  Heap &heap = script.GetEngine().GetHeap();
+  heap.SetStressMode(true);
+  heap.SetMaxPause(max_pause);
+  std::string output = script.Run();
+  *collections = heap.GetStats().collections;
+  return output;
+}
+
+template <typename E>
+class GC_ENGINE_TESTS : public ::testing::Test {};
+
+TYPED_TEST_SUITE(GC_ENGINE_TESTS, Engines);
+
+// Exercises every store the incremental collector needs a barrier for
+const char *const STRESS_PROGRAM =
+    "class Node {\n"
+    "  init(value, next) { this.value = value; this.next = next; }\n"
+    "  sum() {\n"
+    "    if (this.next == nil) return this.value;\n"
+    "    return this.value + this.next.sum();\n"
+    "  }\n"
+    "}\n"
+    "class Named < Node {\n"
+    "  init(name) { super.init(0, nil); this.name = \"n\" + name; }\n"
+    "  label() { return super.sum; }\n"
+    "}\n"
+    "fun counter() {\n"
+    "  var count = 0;\n"
+    "  fun step() { count = count + 1; return count; }\n"
+    "  return step;\n"
+    "}\n"
+    "var list = nil;\n"
+    "var step = counter();\n"
+    "for (var i = 0; i < 20; i = i + 1) list = Node(step(), list);\n"
+    "print list.sum();\n"
+    "var s = \"\";\n"
+    "for (var i = 0; i < 5; i = i + 1) s = s + \"ab\" + \"c\";\n"
+    "print s;\n"
+    "var named = Named(\"x\" + \"y\");\n"
+    "print named.name;\n"
+    "print named.label()();\n"
+    "print Node(1, Node(2, nil)).sum;\n"
+    "fun box() {\n"
+    "  var held = nil;\n"
+    "  fun set(v) { held = v; }\n"
+    "  fun get() { return held; }\n"
+    "  set(\"a\" + \"b\");\n"
+    "  return get;\n"
+    "}\n"
+    "print box()();\n";
+const char *const STRESS_OUTPUT =
+    "210\nabcabcabcabcabc\nnxy\n0\n<fn sum>\nab\n";
+
+TYPED_TEST(GC_ENGINE_TESTS, Programs_survive_collecting_on_every_allocation) {
+  size_t collections = 0;
+  std::string output = RunStressed<TypeParam>(
+      STRESS_PROGRAM, std::chrono::nanoseconds(0), &collections);
+
+  EXPECT_EQ(STRESS_OUTPUT, output);
+  EXPECT_GT(collections, 50u);
+}
+
+TYPED_TEST(GC_ENGINE_TESTS, Programs_survive_incremental_collection) {
+  size_t collections = 0;
+  std::string output = RunStressed<TypeParam>(
+      STRESS_PROGRAM, std::chrono::milliseconds(1), &collections);
+
+  EXPECT_EQ(STRESS_OUTPUT, output);
+  EXPECT_GT(collections, 0u);
+}
+
+TYPED_TEST(GC_ENGINE_TESTS, Garbage_is_reclaimed_while_running) {
+  Script<TypeParam> script(
+      "class Box { init(v) { this.v = v; } }\n"
+      "var kept = Box(\"kept\");\n"
+      "for (var i = 0; i < 50000; i = i + 1) {\n"
+      "  var garbage = Box(\"item\" + \"s\");\n"
+      "}\n"
+      "print kept.v;\n");
+  EXPECT_EQ("kept\n", script.Run());
+
+  const Heap &heap = script.GetEngine().GetHeap();
+  EXPECT_GT(heap.GetStats().collections, 0u);
+  EXPECT_GT(heap.GetStats().objects_freed, 50000u);
+  EXPECT_LT(heap.ObjectCount(), 50000u);
+}
+
+}  // namespace
@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "Heap.hpp"
+#include "InlineCache.hpp"
+#include "Script.hpp"
+
+namespace {
+
+TEST(INLINE_CACHE_TESTS, Sites_go_polymorphic_then_megamorphic) {
+  Heap heap;
+  const Symbol *name = Interner::Global().Intern("get");
+  InlineCache cache;
+  InlineCache::Stats stats;
+
+  std::vector<ObjClass *> classes;
+  for (size_t i = 0; i <= InlineCache::WAYS; i++) {
+    auto *klass = heap.Make<ObjClass>("C", nullptr);
+    klass->AddMethod(name, klass);
+    classes.push_back(klass);
+  }
+
+  EXPECT_EQ(classes[0], classes[0]->FindMethod<Obj>(name, cache, stats));
+  EXPECT_EQ(classes[0], classes[0]->FindMethod<Obj>(name, cache, stats));
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+  EXPECT_EQ(1u, cache.Size());
+
+  for (ObjClass *klass : classes) {
+    EXPECT_EQ(klass, klass->FindMethod<Obj>(name, cache, stats));
+  }
+  EXPECT_EQ(InlineCache::WAYS, cache.Size());
+  EXPECT_TRUE(cache.IsMegamorphic());
+
+  // The last class evicted the first; the rest still hit
+  stats = {};
+  for (size_t i = 1; i < classes.size(); i++) {
+    EXPECT_EQ(classes[i], classes[i]->FindMethod<Obj>(name, cache, stats));
+  }
+  EXPECT_EQ(InlineCache::WAYS, stats.hits);
+  EXPECT_EQ(0u, stats.misses);
+  EXPECT_EQ(classes[0], classes[0]->FindMethod<Obj>(name, cache, stats));
+  EXPECT_EQ(1u, stats.misses);
+}
+
+TEST(INLINE_CACHE_TESTS, Missing_methods_are_cached_too) {
+  Heap heap;
+  auto *klass = heap.Make<ObjClass>("Empty", nullptr);
+  InlineCache cache;
+  InlineCache::Stats stats;
+
+  const Symbol *init = Interner::Global().Intern("init");
+  EXPECT_EQ(nullptr, klass->FindMethod<Obj>(init, cache, stats));
+  EXPECT_EQ(nullptr, klass->FindMethod<Obj>(init, cache, stats));
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+}
+
+template <typename E>
+class INLINE_CACHE_ENGINE_TESTS : public ::testing::Test {
+ protected:
+  // Runs `source` on a fresh engine, keeping its cache statistics
+  std::string Run(const std::string &source) {
+    Script<E> script(source);
+    std::string output = script.Run();
+    stats = script.GetEngine().GetCacheStats();
+    elided = script.GetEngine().GetHeap().GetStats().allocations_elided;
+    return output;
+  }
+
+  InlineCache::Stats stats;
+  size_t elided = 0;
+};
+
+TYPED_TEST_SUITE(INLINE_CACHE_ENGINE_TESTS, Engines);
+
+TYPED_TEST(INLINE_CACHE_ENGINE_TESTS, Monomorphic_sites_hit) {
+  EXPECT_EQ("1000\n", this->Run("class Counter {\n"
+                                "  init() { this.count = 0; }\n"
+                                "  add() { this.count = this.count + 1; }\n"
+                                "}\n"
+                                "var counter = Counter();\n"
+                                "for (var i = 0; i < 1000; i = i + 1) {\n"
+                                "  counter.add();\n"
+                                "}\n"
+                                "print counter.count;\n"));
+  // Each site misses once: `init`, the store in it, the three property
+  // accesses in the loop and the final read
+  EXPECT_EQ(3 * 999u, this->stats.hits);
+  EXPECT_EQ(6u, this->stats.misses);
+}
+
+TYPED_TEST(INLINE_CACHE_ENGINE_TESTS, Polymorphic_sites_find_each_method) {
+  EXPECT_EQ("3\n6\n", this->Run("class A { get() { return 1; } }\n"
+                               "class B < A { get() { return 2; } }\n"
+                               "class C < A {}\n"
+                               "fun sum(x, y, z) {\n"
+                               "  return x.get() + y.get() + z.get();\n"
+                               "}\n"
+                               "fun total(object) {\n"
+                               "  var t = 0;\n"
+                               "  for (var i = 0; i < 3; i = i + 1) {\n"
+                               "    t = t + object.get();\n"
+                               "  }\n"
+                               "  return t;\n"
+                               "}\n"
+                               "print sum(A(), C(), A());\n"
+                               "print total(B());\n"));
+}
+
+TYPED_TEST(INLINE_CACHE_ENGINE_TESTS, Megamorphic_sites_stay_correct) {
+  EXPECT_EQ("1\n2\n3\n4\n5\n6\n1\n6\n",
+            this->Run("class C1 { get() { return 1; } }\n"
+                      "class C2 { get() { return 2; } }\n"
+                      "class C3 { get() { return 3; } }\n"
+                      "class C4 { get() { return 4; } }\n"
+                      "class C5 { get() { return 5; } }\n"
+                      "class C6 { get() { return 6; } }\n"
+                      "fun show(object) { print object.get(); }\n"
+                      "show(C1()); show(C2()); show(C3());\n"
+                      "show(C4()); show(C5()); show(C6());\n"
+                      "show(C1()); show(C6());\n"));
+}
+
+TYPED_TEST(INLINE_CACHE_ENGINE_TESTS, Fields_shadow_cached_methods) {
+  EXPECT_EQ("method\nfield\n",
+            this->Run("class A { name() { return \"method\"; } }\n"
+                      "fun show(a) {\n"
+                      "  var value = a.name;\n"
+                      "  if (value == \"field\") print value;\n"
+                      "  else print value();\n"
+                      "}\n"
+                      "show(A());\n"
+                      "var shadowed = A();\n"
+                      "shadowed.name = \"field\";\n"
+                      "show(shadowed);\n"));
+}
+
+TYPED_TEST(INLINE_CACHE_ENGINE_TESTS, Invokes_skip_bound_methods) {
+  EXPECT_EQ("3\n7\nb\nbase 5\n",
+            this->Run("class Base {\n"
+                      "  describe(n) { return \"base \" + n; }\n"
+                      "}\n"
+                      "class Point < Base {\n"
+                      "  init(x) { this.x = x; }\n"
+                      "  plus(y) { return this.x + y; }\n"
+                      "  describe(n) { return super.describe(n); }\n"
+                      "}\n"
+                      "var p = Point(1);\n"
+                      "print p.plus(2);\n"
+                      "var bound = p.plus;\n"
+                      "print bound(6);\n"
+                      "fun b() { return \"b\"; }\n"
+                      "p.f = b;\n"
+                      "print p.f();\n"
+                      "print p.describe(\"5\");\n"));
+  // `plus` and `describe` off `p`, and `super.describe`; not the stored
+  // bound method, nor the function in a field
+  EXPECT_EQ(3u, this->elided);
+}
+
+TYPED_TEST(INLINE_CACHE_ENGINE_TESTS, Invoked_fields_can_hold_classes) {
+  // The same site meets a method on an instance with no fields, and then
+  // that instance's class stored in a field of another
+  EXPECT_EQ("init\nmethod\ninit\nmethod\n",
+            this->Run("class A {\n"
+                      "  init() { print \"init\"; }\n"
+                      "  make() { return \"method\"; }\n"
+                      "}\n"
+                      "class B {}\n"
+                      "fun call(o) { return o.make(); }\n"
+                      "var a = A();\n"
+                      "var b = B();\n"
+                      "b.make = A;\n"
+                      "print call(a);\n"
+                      "call(b);\n"
+                      "print call(a);\n"));
+}
+
+TYPED_TEST(INLINE_CACHE_ENGINE_TESTS, Invokes_report_errors) {
+  EXPECT_EQ("Expected 1 arguments but got 0.\n[line 2]\n",
+            this->Run("class A { f(x) {} }\n"
+                      "A().f();\n"));
+  EXPECT_EQ("Undefined property 'g'.\n[line 1]\n",
+            this->Run("class A {} A().g();\n"));
+  EXPECT_EQ("Only instances have properties.\n[line 1]\n",
+            this->Run("var x = 1; x.g();\n"));
+  EXPECT_EQ("Undefined property 'g'.\n[line 2]\n",
+            this->Run("class A {}\n"
+                      "class B < A { f() { super.g(); } }\n"
+                      "B().f();\n"));
+}
+
+TYPED_TEST(INLINE_CACHE_ENGINE_TESTS, Invokes_look_up_before_the_arguments) {
+  // An argument that shadows the method with a field is too late
+  EXPECT_EQ("method\nfield\n",
+            this->Run("class A { m(x) { return \"method\"; } }\n"
+                      "var a = A();\n"
+                      "fun field(x) { return \"field\"; }\n"
+                      "fun shadow() { a.m = field; return 0; }\n"
+                      "print a.m(shadow());\n"
+                      "print a.m(0);\n"));
+  // and one that fails is never evaluated
+  const std::string bad = "fun bad() { print \"bad\"; }\n";
+  EXPECT_EQ("Only instances have properties.\n[line 2]\n",
+            this->Run(bad + "nil.m(bad());\n"));
+  EXPECT_EQ("Undefined property 'm'.\n[line 3]\n",
+            this->Run(bad + "class A {}\n"
+                            "A().m(bad());\n"));
+  EXPECT_EQ("Undefined property 'm'.\n[line 3]\n",
+            this->Run(bad + "class A {}\n"
+                            "class B < A { f() { super.m(bad()); } }\n"
+                            "B().f();\n"));
+}
+
+TEST(INLINE_CACHE_TESTS, Tree_caches_outlive_the_interpreter) {
+  // The caches live in the tree, so a second interpreter running the same
+  // statements meets entries for classes the first one made
+  Script<Interpreter> first(
+      "class A { get() { return \"a\"; } }\n"
+      "var s = \"\";\n"
+      "for (var i = 0; i < 10; i = i + 1) s = s + A().get();\n"
+      "print s;\n");
+  EXPECT_EQ("aaaaaaaaaa\n", first.Run());
+
+  for (size_t i = 0; i < 2 * InlineCache::WAYS; i++) {
+    Script<Interpreter> script(first.GetStatements());
+    EXPECT_EQ("aaaaaaaaaa\n", script.Run());
+    // One miss each at the call and at the property
+    EXPECT_EQ(18u, script.GetEngine().GetCacheStats().hits);
+    EXPECT_EQ(2u, script.GetEngine().GetCacheStats().misses);
+  }
+}
+
+}  // namespace
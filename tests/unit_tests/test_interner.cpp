@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Heap.hpp"
+#include "Interner.hpp"
+#include "Parser.hpp"
+#include "Scanner.hpp"
+
+namespace {
+
+TEST(INTERNER_TESTS, Equal_text_gives_the_same_symbol) {
+  Interner interner;
+  std::string a = "counter";
+  std::string b = "count";
+  b += "er";
+
+  const Symbol *x = interner.Intern(a);
+  const Symbol *y = interner.Intern(b);
+  EXPECT_EQ(x, y);
+  EXPECT_NE(x, interner.Intern("count"));
+  EXPECT_EQ("counter", x->text);
+  // The symbol keeps its own copy of the text
+  EXPECT_NE(a.data(), x->text.data());
+
+  Interner::Stats stats = interner.GetStats();
+  EXPECT_EQ(2u, stats.symbols);
+  EXPECT_EQ(12u, stats.text_bytes);
+  EXPECT_EQ(3u, stats.requests);
+  EXPECT_EQ(19u, stats.requested_bytes);
+  EXPECT_GE(stats.memory, stats.text_bytes);
+}
+
+TEST(INTERNER_TESTS, Interning_is_thread_safe) {
+  Interner interner;
+  std::vector<std::vector<const Symbol *>> seen(4);
+  std::vector<std::thread> threads;
+  for (auto &symbols : seen) {
+    threads.emplace_back([&interner, &symbols] {
+      for (int i = 0; i < 1000; i++) {
+        symbols.push_back(interner.Intern("name" + std::to_string(i)));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(1000u, interner.GetStats().symbols);
+  EXPECT_EQ(4000u, interner.GetStats().requests);
+  for (const auto &symbols : seen) {
+    EXPECT_EQ(seen[0], symbols);
+  }
+}
+
+TEST(INTERNER_TESTS, Tree_shares_symbols_between_names_and_strings) {
+  std::string input = "a.name = \"name\"; print b.name; fun name() {}";
+  Scanner scanner(input);
+  std::ostringstream out;
+  Error error(out);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+  StmtList statements = parser.Parse();
+  ASSERT_EQ(3u, statements.size());
+
+  const auto *set = static_cast<const Set *>(
+      static_cast<const Expression *>(statements[0])->GetExpr());
+  const auto *get =
+      static_cast<const Get *>(static_cast<const Print *>(statements[1])
+                                   ->GetExpr());
+  const auto *string = std::get<const Symbol *>(
+      static_cast<const Literal *>(set->GetValue())->GetValue());
+  const auto *function = static_cast<const Function *>(statements[2]);
+
+  const Symbol *name = Interner::Global().Intern("name");
+  EXPECT_EQ(name, set->GetSymbol());
+  EXPECT_EQ(name, get->GetSymbol());
+  EXPECT_EQ(name, string);
+  EXPECT_EQ(name, function->GetSymbol());
+}
+
+TEST(INTERNER_TESTS, Heap_shares_one_string_per_symbol) {
+  Interner interner;
+  Heap heap;
+  ObjString *name = heap.Intern(interner.Intern("lox"));
+  EXPECT_EQ(name, heap.Intern(interner.Intern("lox")));
+  EXPECT_EQ("lox", name->View());
+  EXPECT_EQ(1u, heap.ObjectCount());
+
+  Value interned = Value::Object(name);
+  Value made = Value::Object(heap.Make<ObjString>("lox"));
+  Value other = Value::Object(heap.Intern(interner.Intern("lux")));
+  EXPECT_TRUE(ValuesEqual(interned, made));
+  EXPECT_FALSE(ValuesEqual(interned, other));
+}
+
+}  // namespace
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+#include "Interpreter.hpp"
+#include "Parser.hpp"
+#include "Scanner.hpp"
+#include "VM.hpp"
+
+namespace {
+
+// Runs `source` on engine E and returns what it printed followed by any
+// diagnostics
+template <typename E>
+std::string RunScript(const std::string &source) {
+  std::ostringstream out;
+  std::ostringstream diagnostics;
+  Error error(diagnostics);
+
+  Scanner scanner(source, &error);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+  StmtList statements = parser.Parse();
+  if (!error.had_error) {
+    E engine(error, out);
+    engine.Interpret(statements);
+  }
+  return out.str() + diagnostics.str();
+}
+
+// Both engines have to agree on every script
+template <typename E>
+class INTERPRETER_TESTS : public ::testing::Test {
+ protected:
+  static std::string Run(const std::string &source) {
+    return RunScript<E>(source);
+  }
+};
+
+using Engines = ::testing::Types<Interpreter, VM>;
+TYPED_TEST_SUITE(INTERPRETER_TESTS, Engines);
+
+TYPED_TEST(INTERPRETER_TESTS, Arithmetic_and_strings) {
+  EXPECT_EQ("7\n-1\n2.5\ntrue\nfalse\n",
+            this->Run("print 1 + 2 * 3;\n"
+                      "print -(4 - 3);\n"
+                      "print 5 / 2;\n"
+                      "print 1 < 2 and 2 <= 2;\n"
+                      "print !(nil == nil);\n"));
+  EXPECT_EQ("foobar\ntrue\n", this->Run("var a = \"foo\";\n"
+                                        "print a + \"bar\";\n"
+                                        "print a + \"bar\" == \"foobar\";\n"));
+}
+
+TYPED_TEST(INTERPRETER_TESTS, Scopes_and_control_flow) {
+  EXPECT_EQ("inner\nouter\n", this->Run("var a = \"outer\";\n"
+                                        "{ var a = \"inner\"; print a; }\n"
+                                        "print a;\n"));
+  EXPECT_EQ("0\n1\n2\ndone\n",
+            this->Run("for (var i = 0; i < 3; i = i + 1) print i;\n"
+                      "if (nil) print \"no\"; else print \"done\";\n"));
+  EXPECT_EQ("nil\n2\n", this->Run("print nil and 1;\nprint false or 2;\n"));
+}
+
+TYPED_TEST(INTERPRETER_TESTS, Functions_and_closures) {
+  EXPECT_EQ("55\n", this->Run("fun fib(n) {\n"
+                              "  if (n < 2) return n;\n"
+                              "  return fib(n - 2) + fib(n - 1);\n"
+                              "}\n"
+                              "print fib(10);\n"));
+  EXPECT_EQ("1\n2\n<fn makeCounter>\n",
+            this->Run("fun makeCounter() {\n"
+                      "  var i = 0;\n"
+                      "  fun count() { i = i + 1; return i; }\n"
+                      "  return count;\n"
+                      "}\n"
+                      "var counter = makeCounter();\n"
+                      "print counter();\n"
+                      "print counter();\n"
+                      "print makeCounter;\n"));
+  EXPECT_EQ("nil\n", this->Run("fun f() { while (true) { return; } }\n"
+                               "print f();\n"));
+}
+
+TYPED_TEST(INTERPRETER_TESTS, Closures_share_captured_variables) {
+  EXPECT_EQ("2\n2\n",
+            this->Run("var get; var set;\n"
+                      "{\n"
+                      "  var a = 1;\n"
+                      "  fun g() { return a; }\n"
+                      "  fun s() { a = 2; }\n"
+                      "  get = g; set = s;\n"
+                      "}\n"
+                      "set();\n"
+                      "print get();\n"
+                      "fun outer() {\n"
+                      "  var x = 1;\n"
+                      "  fun middle() {\n"
+                      "    fun inner() { return x; }\n"
+                      "    return inner;\n"
+                      "  }\n"
+                      "  x = 2;\n"
+                      "  return middle();\n"
+                      "}\n"
+                      "print outer()();\n"));
+}
+
+TYPED_TEST(INTERPRETER_TESTS, Classes_and_inheritance) {
+  EXPECT_EQ("Point instance\n3\n7\n",
+            this->Run("class Point {\n"
+                      "  init(x, y) { this.x = x; this.y = y; }\n"
+                      "  sum() { return this.x + this.y; }\n"
+                      "}\n"
+                      "var p = Point(1, 2);\n"
+                      "print p;\n"
+                      "print p.sum();\n"
+                      "var sum = p.sum;\n"
+                      "p.x = 5;\n"
+                      "print sum();\n"));
+  EXPECT_EQ("A.hi\nB.hi\nC instance\n",
+            this->Run("class A { hi() { print \"A.hi\"; } }\n"
+                      "class B < A {\n"
+                      "  hi() { super.hi(); print \"B.hi\"; }\n"
+                      "}\n"
+                      "B().hi();\n"
+                      "class C { init() { return; } }\n"
+                      "print C().init();\n"));
+}
+
+TYPED_TEST(INTERPRETER_TESTS, Runtime_errors) {
+  EXPECT_EQ("Operands must be numbers.\n[line 1]\n",
+            this->Run("print 1 - \"a\";"));
+  EXPECT_EQ("1\nUndefined variable 'b'.\n[line 2]\n",
+            this->Run("print 1;\nprint b;\nvar b = 2;"));
+  EXPECT_EQ("Expected 1 arguments but got 2.\n[line 1]\n",
+            this->Run("fun f(a) {} f(1, 2);"));
+  EXPECT_EQ("Can only call functions and classes.\n[line 1]\n",
+            this->Run("\"str\"();"));
+  EXPECT_EQ("Only instances have properties.\n[line 1]\n",
+            this->Run("print 1.x;"));
+  EXPECT_EQ("Superclass must be a class.\n[line 1]\n",
+            this->Run("var A = 1; class B < A {}"));
+}
+
+TYPED_TEST(INTERPRETER_TESTS, Deep_recursion_overflows_the_stack) {
+  EXPECT_EQ("Stack overflow.\n[line 1]\n",
+            this->Run("fun f(n) { return f(n + 1); } f(0);"));
+  // Both engines stop at the same depth
+  const std::string countdown =
+      "fun f(n) { if (n == 0) return 0; return f(n - 1) + 1; }\n";
+  EXPECT_EQ("62\n", this->Run(countdown + "print f(62);"));
+  EXPECT_EQ("Stack overflow.\n[line 1]\n",
+            this->Run(countdown + "print f(63);"));
+}
+
+TYPED_TEST(INTERPRETER_TESTS, Undeclared_names_are_reported_before_running) {
+  EXPECT_EQ("[line 2] Error at 'b': Undefined variable 'b'.\n",
+            this->Run("print 1;\nprint b;\nprint b;"));
+  EXPECT_EQ("[line 1] Error at 'g': Undefined variable 'g'.\n",
+            this->Run("fun f() { g = 1; }"));
+  // A function may use a global declared further down
+  EXPECT_EQ("2\n", this->Run("fun f() { return g + 1; }\n"
+                             "var g = 1;\n"
+                             "print f();\n"));
+}
+
+TYPED_TEST(INTERPRETER_TESTS, Locals_shadow_and_capture_by_scope) {
+  EXPECT_EQ("global\nglobal\nlocal\n",
+            this->Run("var a = \"global\";\n"
+                      "{\n"
+                      "  fun show() { print a; }\n"
+                      "  show();\n"
+                      "  var a = \"local\";\n"
+                      "  show();\n"
+                      "  print a;\n"
+                      "}\n"));
+  EXPECT_EQ("3\n1\n",
+            this->Run("class A { f() { return 1; } }\n"
+                      "class B < A {\n"
+                      "  init(x) { this.x = x; }\n"
+                      "  f() {\n"
+                      "    var y = 2;\n"
+                      "    { fun g() { return y + super.f(); } return g(); }\n"
+                      "  }\n"
+                      "}\n"
+                      "print B(0).f();\n"
+                      "{ var b = B(1); print b.x; }\n"));
+}
+
+}  // namespace
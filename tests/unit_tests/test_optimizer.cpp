@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+#include "AstPrinter.hpp"
+#include "Interpreter.hpp"
+#include "Optimizer.hpp"
+#include "Parser.hpp"
+#include "Scanner.hpp"
+
+namespace {
+
+std::string FoldAndPrint(const std::string &source) {
+  std::ostringstream out;
+  Error error(out);
+  Scanner scanner(source);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+
+  const Expr *expr = parser.ParseExpression();
+  if (expr == nullptr) {
+    return out.str();
+  }
+  Optimizer optimizer(arena);
+  AstPrinter printer;
+  return printer.ToString(*optimizer.Optimize(expr));
+}
+
+TEST(OPTIMIZER_TESTS, Folds_constant_arithmetic) {
+  EXPECT_EQ("7", FoldAndPrint("1 + 2 * 3"));
+  EXPECT_EQ("-6", FoldAndPrint("-(4 + 2)"));
+  EXPECT_EQ("2.5", FoldAndPrint("(10 / 4)"));
+  EXPECT_EQ("inf", FoldAndPrint("1 / 0"));
+  EXPECT_EQ("(+ (* x 2) 3)", FoldAndPrint("(x * (1 + 1)) + 3"));
+}
+
+TEST(OPTIMIZER_TESTS, Folds_comparisons_and_equality) {
+  EXPECT_EQ("true", FoldAndPrint("1 + 2 * 3 < 8"));
+  EXPECT_EQ("false", FoldAndPrint("2 >= 3"));
+  EXPECT_EQ("true", FoldAndPrint("\"a\" + \"b\" == \"ab\""));
+  EXPECT_EQ("false", FoldAndPrint("1 == \"1\""));
+  EXPECT_EQ("true", FoldAndPrint("nil != false"));
+  EXPECT_EQ("false", FoldAndPrint("!(nil == nil)"));
+  EXPECT_EQ("false", FoldAndPrint("!0"));
+}
+
+TEST(OPTIMIZER_TESTS, Folds_string_concatenation) {
+  EXPECT_EQ("foobarbaz", FoldAndPrint("\"foo\" + (\"bar\" + \"baz\")"));
+  EXPECT_EQ("(+ foobar s)", FoldAndPrint("\"foo\" + \"bar\" + s"));
+  EXPECT_EQ("(+ (+ s foo) bar)", FoldAndPrint("s + \"foo\" + \"bar\""));
+}
+
+TEST(OPTIMIZER_TESTS, Short_circuits_constant_left_operands) {
+  EXPECT_EQ("(call f)", FoldAndPrint("true and f()"));
+  EXPECT_EQ("nil", FoldAndPrint("nil and f()"));
+  EXPECT_EQ("1", FoldAndPrint("1 or f()"));
+  EXPECT_EQ("(call f)", FoldAndPrint("false or f()"));
+  EXPECT_EQ("(or a 3)", FoldAndPrint("a or 1 + 2"));
+}
+
+TEST(OPTIMIZER_TESTS, Leaves_failing_operations_to_run_time) {
+  EXPECT_EQ("(- 1 a)", FoldAndPrint("1 - \"a\""));
+  EXPECT_EQ("(+ 1 nil)", FoldAndPrint("1 + nil"));
+  EXPECT_EQ("(- true)", FoldAndPrint("-true"));
+}
+
+TEST(OPTIMIZER_TESTS, Rewrites_statements_and_counts_nodes) {
+  std::ostringstream out;
+  Error error(out);
+  Scanner scanner(
+      "fun f() { return (2 * 3) + 1; }\n"
+      "class A { m() { print \"a\" + \"b\"; } }\n"
+      "var unchanged = f;\n"
+      "for (var i = 0; i < 2 * 2; i = i + 1) print i;\n"
+      "print f();\n"
+      "A().m();\n");
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+  StmtList statements = parser.Parse();
+
+  Optimizer optimizer(arena);
+  StmtList optimized = optimizer.Optimize(statements);
+  EXPECT_EQ(statements[2], optimized[2]);
+  EXPECT_GT(Optimizer::CountNodes(statements),
+            Optimizer::CountNodes(optimized));
+
+  Interpreter interpreter(error, out);
+  interpreter.Interpret(optimized);
+  EXPECT_EQ("0\n1\n2\n3\n7\nab\n", out.str());
+}
+
+TEST(OPTIMIZER_TESTS, Unchanged_trees_are_shared) {
+  Scanner scanner("var a = b + c; while (a) { a = a - 1; }");
+  std::ostringstream out;
+  Error error(out);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+  StmtList statements = parser.Parse();
+
+  size_t used = arena.BytesUsed();
+  Optimizer optimizer(arena);
+  StmtList optimized = optimizer.Optimize(statements);
+  EXPECT_EQ(statements.data(), optimized.data());
+  EXPECT_EQ(used, arena.BytesUsed());
+}
+
+}  // namespace
@@ -0,0 +1,288 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+#include "AstPrinter.hpp"
+#include "Parser.hpp"
+#include "Scanner.hpp"
+
+namespace {
+
+std::string ParseAndPrint(const std::string &source, Error &error) {
+  Scanner scanner(source);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+
+  const Expr *expr = parser.ParseExpression();
+  if (expr == nullptr) {
+    return "";
+  }
+  AstPrinter printer;
+  return printer.ToString(*expr);
+}
+
+TEST(PARSER_TESTS, Precedence_and_grouping) {
+  std::ostringstream out;
+  Error error(out);
+
+  EXPECT_EQ("(* (- 123) (group 45.67))",
+            ParseAndPrint("-123 * (45.67)", error));
+  EXPECT_EQ("(== (< (+ 1 (* 2 3)) 4) false)",
+            ParseAndPrint("1 + 2 * 3 < 4 == false", error));
+  EXPECT_EQ("(! (group (!= nil str)))",
+            ParseAndPrint("!(nil != \"str\")", error));
+  EXPECT_FALSE(error.had_error);
+}
+
+TEST(PARSER_TESTS, Binary_operators_are_left_associative) {
+  std::ostringstream out;
+  Error error(out);
+
+  EXPECT_EQ("(- (- a b) c)", ParseAndPrint("a - b - c", error));
+  EXPECT_EQ("(/ (/ 8 4) 2)", ParseAndPrint("8 / 4 / 2", error));
+}
+
+TEST(PARSER_TESTS, Reports_syntax_errors) {
+  std::ostringstream out;
+  Error error(out);
+
+  EXPECT_EQ("", ParseAndPrint("(1 + 2", error));
+  EXPECT_TRUE(error.had_error);
+  EXPECT_EQ("[line 1] Error at end: Expect ')' after expression.\n",
+            out.str());
+
+  out.str("");
+  EXPECT_EQ("", ParseAndPrint("1 + ;", error));
+  EXPECT_EQ("[line 1] Error at ';': Expect expression.\n", out.str());
+}
+
+TEST(PARSER_TESTS, Calls_properties_and_assignment) {
+  std::ostringstream out;
+  Error error(out);
+
+  EXPECT_EQ("(= (call (. a b) c d) e f)",
+            ParseAndPrint("a.b(c, d).e = f", error));
+  EXPECT_EQ("(= x (or a (and b c)))", ParseAndPrint("x = a or b and c", error));
+  EXPECT_EQ("(call (super init) this)",
+            ParseAndPrint("super.init(this)", error));
+  EXPECT_FALSE(error.had_error);
+
+  EXPECT_EQ("1", ParseAndPrint("1 = 2", error));
+  EXPECT_EQ("[line 1] Error at '=': Invalid assignment target.\n", out.str());
+}
+
+TEST(PARSER_TESTS, Declarations) {
+  std::ostringstream out;
+  Error error(out);
+  Scanner scanner(
+      "class B < A {\n"
+      "  init(x, y) { this.x = x; }\n"
+      "  get() { return this.x; }\n"
+      "}\n"
+      "fun f() {}\n"
+      "var v;\n");
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+
+  StmtList program = parser.Parse();
+  ASSERT_FALSE(error.had_error);
+  ASSERT_EQ(3u, program.size());
+
+  ASSERT_EQ(Stmt::Kind::CLASS, program[0]->GetKind());
+  const auto *klass = static_cast<const Class *>(program[0]);
+  EXPECT_EQ("B", klass->GetName()->lexeme);
+  EXPECT_EQ("A", klass->GetSuperclass()->GetName()->lexeme);
+  ASSERT_EQ(2u, klass->GetMethods().size());
+  const Function *init = klass->GetMethods()[0];
+  ASSERT_EQ(2u, init->GetParams().size());
+  EXPECT_EQ("y", init->GetParams()[1].lexeme);
+  EXPECT_EQ(1u, init->GetBody().size());
+  EXPECT_EQ(Stmt::Kind::RETURN,
+            klass->GetMethods()[1]->GetBody()[0]->GetKind());
+
+  ASSERT_EQ(Stmt::Kind::FUNCTION, program[1]->GetKind());
+  EXPECT_TRUE(static_cast<const Function *>(program[1])->GetBody().empty());
+  ASSERT_EQ(Stmt::Kind::VAR, program[2]->GetKind());
+  EXPECT_EQ(nullptr, static_cast<const Var *>(program[2])->GetInitializer());
+}
+
+TEST(PARSER_TESTS, For_loops_are_desugared) {
+  std::ostringstream out;
+  Error error(out);
+  Scanner scanner("for (var i = 0; i < 3; i = i + 1) print i;");
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+
+  StmtList program = parser.Parse();
+  ASSERT_EQ(1u, program.size());
+  ASSERT_EQ(Stmt::Kind::BLOCK, program[0]->GetKind());
+
+  StmtList outer = static_cast<const Block *>(program[0])->GetStatements();
+  ASSERT_EQ(2u, outer.size());
+  EXPECT_EQ(Stmt::Kind::VAR, outer[0]->GetKind());
+  ASSERT_EQ(Stmt::Kind::WHILE, outer[1]->GetKind());
+
+  const auto *loop = static_cast<const While *>(outer[1]);
+  AstPrinter printer;
+  EXPECT_EQ("(< i 3)", printer.ToString(*loop->GetCondition()));
+  ASSERT_EQ(Stmt::Kind::BLOCK, loop->GetBody()->GetKind());
+  StmtList body = static_cast<const Block *>(loop->GetBody())->GetStatements();
+  ASSERT_EQ(2u, body.size());
+  EXPECT_EQ(Stmt::Kind::PRINT, body[0]->GetKind());
+  EXPECT_EQ(Stmt::Kind::EXPRESSION, body[1]->GetKind());
+}
+
+TEST(PARSER_TESTS, Recovers_after_errors) {
+  std::ostringstream out;
+  Error error(out);
+  Scanner scanner(
+      "var = 1;\n"
+      "print 1;\n"
+      "{ var a = (; print 2; }\n"
+      "fun f(a,) {}\n"
+      "if (true) print 3;\n");
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+
+  StmtList program = parser.Parse();
+  EXPECT_TRUE(error.had_error);
+  EXPECT_EQ(
+      "[line 1] Error at '=': Expect variable name.\n"
+      "[line 3] Error at ';': Expect expression.\n"
+      "[line 4] Error at ')': Expect parameter name.\n",
+      out.str());
+
+  ASSERT_EQ(3u, program.size());
+  EXPECT_EQ(Stmt::Kind::PRINT, program[0]->GetKind());
+  ASSERT_EQ(Stmt::Kind::BLOCK, program[1]->GetKind());
+  StmtList block = static_cast<const Block *>(program[1])->GetStatements();
+  ASSERT_EQ(1u, block.size());
+  EXPECT_EQ(Stmt::Kind::PRINT, block[0]->GetKind());
+  EXPECT_EQ(Stmt::Kind::IF, program[2]->GetKind());
+}
+
+TEST(PARSER_TESTS, Rejects_expressions_nested_too_deep) {
+  std::ostringstream out;
+  Error error(out);
+
+  // The outermost expression is a level of its own
+  const size_t depth = Parser::MAX_NESTING - 1;
+  EXPECT_NE("", ParseAndPrint(std::string(depth, '(') + "1" +
+                                  std::string(depth, ')'),
+                              error));
+  EXPECT_NE("", ParseAndPrint(std::string(depth, '-') + "1", error));
+  EXPECT_FALSE(error.had_error);
+
+  // Far past the limit, where recursing would overflow the stack
+  const size_t deep = 200000;
+  EXPECT_EQ("", ParseAndPrint(std::string(deep, '(') + "1" +
+                                  std::string(deep, ')'),
+                              error));
+  EXPECT_TRUE(error.had_error);
+  EXPECT_EQ("[line 1] Error at '(': Expression nesting too deep.\n",
+            out.str());
+
+  out.str("");
+  EXPECT_EQ("", ParseAndPrint(std::string(deep, '-') + "1", error));
+  EXPECT_EQ("[line 1] Error at '-': Expression nesting too deep.\n",
+            out.str());
+
+  // The statement is dropped and parsing carries on after it
+  out.str("");
+  std::string source = "print " + std::string(deep, '(') + "1" +
+                       std::string(deep, ')') + ";\nprint 2;\n";
+  Scanner scanner(source);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+  StmtList program = parser.Parse();
+  EXPECT_EQ("[line 1] Error at '(': Expression nesting too deep.\n",
+            out.str());
+  ASSERT_EQ(1u, program.size());
+  EXPECT_EQ(Stmt::Kind::PRINT, program[0]->GetKind());
+}
+
+TEST(PARSER_TESTS, Rejects_statements_nested_too_deep) {
+  // Parses `source` as a program, returning its statement count
+  auto parse = [](const std::string &source, Error &error) {
+    Scanner scanner(source);
+    Arena arena;
+    Parser parser(scanner.ScanTokens(), arena, error);
+    return parser.Parse().size();
+  };
+  auto repeat = [](const std::string &text, size_t times) {
+    std::string repeated;
+    for (size_t i = 0; i < times; i++) repeated += text;
+    return repeated;
+  };
+  std::ostringstream out;
+  Error error(out);
+
+  const size_t depth = Parser::MAX_STATEMENT_NESTING;
+  EXPECT_EQ(1u, parse(repeat("{", depth - 1) + "print 1;" +
+                          repeat("}", depth - 1),
+                      error));
+  EXPECT_EQ(1u, parse(repeat("{", depth) + repeat("}", depth), error));
+  EXPECT_FALSE(error.had_error);
+
+  // Far past the limit; the error is reported once, and the statements
+  // around the one skipped still parse
+  const size_t deep = 100000;
+  EXPECT_EQ(2u, parse(repeat("{", deep) + "print 1;" + repeat("}", deep) +
+                          "\nprint 2;",
+                      error));
+  EXPECT_TRUE(error.had_error);
+  EXPECT_EQ("[line 1] Error at '{': Statement nesting too deep.\n",
+            out.str());
+
+  out.str("");
+  EXPECT_EQ(2u, parse(repeat("if (true) ", deep) + "print 1; else print 2;" +
+                          "\nprint 3;",
+                      error));
+  EXPECT_EQ("[line 1] Error at 'if': Statement nesting too deep.\n",
+            out.str());
+
+  out.str("");
+  EXPECT_EQ(2u, parse(repeat("fun f() {", deep) + repeat("}", deep) +
+                          "\nprint 1;",
+                      error));
+  EXPECT_EQ("[line 1] Error at '{': Statement nesting too deep.\n",
+            out.str());
+
+  out.str("");
+  EXPECT_EQ(2u, parse(repeat("while (true) {", deep) + repeat("}", deep) +
+                          "\nprint 1;",
+                      error));
+  EXPECT_EQ("[line 1] Error at '{': Statement nesting too deep.\n",
+            out.str());
+}
+
+TEST(PARSER_TESTS, Long_chains_build_in_linear_time) {
+  constexpr size_t terms = 100000;
+  std::string source = "0";
+  for (size_t i = 1; i < terms; i++) {
+    source += " + 1";
+  }
+
+  std::ostringstream out;
+  Error error(out);
+  Scanner scanner(source);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+
+  const Expr *expr = parser.ParseExpression();
+  ASSERT_NE(nullptr, expr);
+
+  size_t depth = 0;
+  while (expr->GetKind() == Expr::Kind::BINARY) {
+    expr = static_cast<const Binary *>(expr)->GetLeft();
+    depth++;
+  }
+  EXPECT_EQ(terms - 1, depth);
+  EXPECT_EQ(Expr::Kind::LITERAL, expr->GetKind());
+
+  arena.Reset();
+  EXPECT_EQ(0u, arena.BytesUsed());
+}
+
+}  // namespace
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+#include "Parser.hpp"
+#include "Resolver.hpp"
+#include "Scanner.hpp"
+
+namespace {
+
+// Resolves `source` and returns the diagnostics
+std::string Resolve(const std::string &source) {
+  std::ostringstream out;
+  Error error(out);
+  Scanner scanner(source);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+  Resolver resolver(error);
+  EXPECT_EQ(out.str().empty(), resolver.Resolve(parser.Parse()));
+  return out.str();
+}
+
+TEST(RESOLVER_TESTS, Scoping_errors) {
+  EXPECT_EQ("[line 1] Error at 'return': Can't return from top-level code.\n",
+            Resolve("return 1;"));
+  EXPECT_EQ(
+      "[line 1] Error at 'a': Can't read local variable in its own "
+      "initializer.\n",
+      Resolve("var a; { var a = a; }"));
+  EXPECT_EQ(
+      "[line 1] Error at 'a': Already a variable with this name in this "
+      "scope.\n",
+      Resolve("fun f(a, a) {}"));
+  EXPECT_EQ("[line 1] Error at 'this': Can't use 'this' outside of a class.\n",
+            Resolve("fun f() { print this; }"));
+  EXPECT_EQ(
+      "[line 1] Error at 'super': Can't use 'super' in a class with no "
+      "superclass.\n",
+      Resolve("class A { f() { super.f(); } }"));
+  EXPECT_EQ("[line 1] Error at 'A': A class can't inherit from itself.\n",
+            Resolve("class A < A {}"));
+  EXPECT_EQ(
+      "[line 1] Error at 'return': Can't return a value from an "
+      "initializer.\n",
+      Resolve("class A { init() { return 1; } }"));
+  // Globals may be redeclared
+  EXPECT_EQ("", Resolve("var a = 1; var a = a;"));
+}
+
+TEST(RESOLVER_TESTS, Assigns_depth_and_index) {
+  std::ostringstream out;
+  Error error(out);
+  Scanner scanner(
+      "var g;\n"
+      "fun f(a, b) {\n"
+      "  { var c; print b; print c; print g; }\n"
+      "}\n");
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+  StmtList statements = parser.Parse();
+  Resolver resolver(error);
+  ASSERT_TRUE(resolver.Resolve(statements));
+
+  auto *f = static_cast<const Function *>(statements[1]);
+  auto *block = static_cast<const Block *>(f->GetBody()[0]);
+  auto slot_of = [&](size_t i) {
+    auto *print = static_cast<const Print *>(block->GetStatements()[i]);
+    return static_cast<const Variable *>(print->GetExpr())->GetSlot();
+  };
+
+  // `b` is the second parameter, one scope out
+  EXPECT_EQ(1u, slot_of(1).depth);
+  EXPECT_EQ(1u, slot_of(1).index);
+  EXPECT_EQ(0u, slot_of(2).depth);
+  EXPECT_EQ(0u, slot_of(2).index);
+  EXPECT_TRUE(slot_of(3).IsGlobal());
+  EXPECT_EQ(resolver.GlobalSlot("g"), slot_of(3).index);
+}
+
+TEST(RESOLVER_TESTS, Globals_persist_between_programs) {
+  std::ostringstream out;
+  Error error(out);
+  Arena arena;
+  Resolver resolver(error);
+
+  Scanner first("var a = 1;");
+  EXPECT_TRUE(
+      resolver.Resolve(Parser(first.ScanTokens(), arena, error).Parse()));
+  Scanner second("print a; print b;");
+  EXPECT_FALSE(
+      resolver.Resolve(Parser(second.ScanTokens(), arena, error).Parse()));
+  EXPECT_EQ("[line 1] Error at 'b': Undefined variable 'b'.\n", out.str());
+  EXPECT_EQ(2u, resolver.GlobalCount());
+}
+
+}  // namespace
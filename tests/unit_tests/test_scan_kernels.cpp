@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ScanKernels.hpp"
+#include "Scanner.hpp"
+
+namespace {
+
+std::vector<const ScanKernels *> Implementations() {
+  std::vector<const ScanKernels *> kernels = {&ScanKernels::Scalar()};
+  if (ScanKernels::Sse2() != nullptr) kernels.push_back(ScanKernels::Sse2());
+  if (ScanKernels::Avx2() != nullptr) kernels.push_back(ScanKernels::Avx2());
+  return kernels;
+}
+
+// Mostly whitespace with the occasional stop character, so every kernel
+// sees long runs, short runs and hits in both vector and scalar tails
+std::string RandomText(std::mt19937 &rng, size_t size) {
+  static const char alphabet[] = "    \t\t\r\n\n\"ab/";
+  std::uniform_int_distribution<size_t> pick(0, sizeof(alphabet) - 2);
+  std::uniform_int_distribution<int> sparse(0, 40);
+  std::string text(size, ' ');
+  for (auto &c : text) {
+    c = sparse(rng) == 0 ? alphabet[pick(rng)] : alphabet[pick(rng) % 8];
+  }
+  return text;
+}
+
+TEST(SCAN_KERNELS_TESTS, Implementations_agree_with_scalar) {
+  std::mt19937 rng(1234);
+  const ScanKernels &scalar = ScanKernels::Scalar();
+
+  for (size_t size = 0; size < 200; size++) {
+    std::string text = RandomText(rng, size);
+    const char *begin = text.data();
+    const char *end = text.data() + text.size();
+
+    for (const ScanKernels *kernels : Implementations()) {
+      SCOPED_TRACE(kernels->name);
+      uint32_t expected_lines = 0;
+      uint32_t lines = 0;
+      EXPECT_EQ(scalar.skip_whitespace(begin, end, expected_lines),
+                kernels->skip_whitespace(begin, end, lines));
+      EXPECT_EQ(expected_lines, lines);
+
+      EXPECT_EQ(scalar.find_newline(begin, end),
+                kernels->find_newline(begin, end));
+
+      expected_lines = lines = 0;
+      EXPECT_EQ(scalar.find_quote(begin, end, expected_lines),
+                kernels->find_quote(begin, end, lines));
+      EXPECT_EQ(expected_lines, lines);
+    }
+  }
+}
+
+TEST(SCAN_KERNELS_TESTS, Scanner_counts_lines_in_bulk) {
+  std::string input =
+      "// a comment that is longer than one vector register\n"
+      "\n\n                                          \n"
+      "var text = \"spans\n\nthree lines\";\n"
+      "print text;";
+
+  auto scan = Scanner(input);
+  const TokenBuffer &tokens = scan.ScanTokens();
+
+  ASSERT_EQ(9u, tokens.Size());
+  EXPECT_EQ(TokenType::VAR, tokens.Type(0));
+  EXPECT_EQ(5u, tokens.Line(0));
+  EXPECT_EQ("spans\n\nthree lines", tokens.String(3));
+  EXPECT_EQ(7u, tokens.Line(3));
+  EXPECT_EQ(TokenType::PRINT, tokens.Type(5));
+  EXPECT_EQ(8u, tokens.Line(5));
+}
+
+}  // namespace
@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <clocale>
+#include <cmath>
+#include <string>
+
 #include "Scanner.hpp"
 
 namespace {
@@ -17,4 +21,55 @@ TEST(SCANNER_TESTS, ScanToken_Test) {
 
     EXPECT_NO_THROW(scan.ScanTokens());
 }
-} // namespace
\ No newline at end of file
+
+TEST(SCANNER_TESTS, ParseNumber_matches_strtod) {
+  for (const char *lexeme :
+       {"0", "7", "007", "123.456", "0.1", "0.30000000000000004",
+        "9007199254740993", "179769313486231570000000000000000000000000",
+        "2.2250738585072014", "4.9406564584124654"}) {
+    SCOPED_TRACE(lexeme);
+    EXPECT_EQ(std::strtod(lexeme, nullptr), Scanner::ParseNumber(lexeme));
+  }
+}
+
+TEST(SCANNER_TESTS, ParseNumber_out_of_range) {
+  std::string huge(400, '9');
+  EXPECT_TRUE(std::isinf(Scanner::ParseNumber(huge)));
+  EXPECT_TRUE(std::isinf(Scanner::ParseNumber(huge + ".5")));
+
+  std::string tiny = "0." + std::string(400, '0') + "1";
+  EXPECT_EQ(0.0, Scanner::ParseNumber(tiny));
+}
+
+TEST(SCANNER_TESTS, ParseNumber_ignores_locale) {
+  // A locale with ',' as the decimal separator used to break std::stod
+  const char *previous = std::setlocale(LC_NUMERIC, nullptr);
+  std::string saved = previous != nullptr ? previous : "C";
+  if (std::setlocale(LC_NUMERIC, "de_DE.UTF-8") == nullptr) {
+    GTEST_SKIP() << "de_DE.UTF-8 locale not installed";
+  }
+  EXPECT_EQ(1.5, Scanner::ParseNumber("1.5"));
+  std::setlocale(LC_NUMERIC, saved.c_str());
+}
+
+TEST(SCANNER_TESTS, Number_token_boundaries) {
+  std::string input = "1. .5 1.5.2 -3";
+
+  auto scan = Scanner(input);
+  const TokenBuffer &tokens = scan.ScanTokens();
+
+  // "1." is a number followed by a dot, and so is ".5" the other way round
+  ASSERT_EQ(10u, tokens.Size());
+  EXPECT_EQ(TokenType::NUMBER, tokens.Type(0));
+  EXPECT_EQ(1.0, tokens.Number(0));
+  EXPECT_EQ(TokenType::DOT, tokens.Type(1));
+  EXPECT_EQ(TokenType::DOT, tokens.Type(2));
+  EXPECT_EQ(5.0, tokens.Number(3));
+  EXPECT_EQ(1.5, tokens.Number(4));
+  EXPECT_EQ(TokenType::DOT, tokens.Type(5));
+  EXPECT_EQ(2.0, tokens.Number(6));
+  EXPECT_EQ(TokenType::MINUS, tokens.Type(7));
+  EXPECT_EQ(3.0, tokens.Number(8));
+  EXPECT_EQ(TokenType::TEOF, tokens.Type(9));
+}
+} // namespace
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "Heap.hpp"
+#include "Object.hpp"
+#include "Script.hpp"
+#include "Shape.hpp"
+
+namespace {
+
+const Symbol *Name(const std::string &text) {
+  return Interner::Global().Intern(text);
+}
+
+TEST(SHAPE_TESTS, Instances_built_alike_share_a_shape) {
+  Heap heap;
+  auto *klass = heap.Make<ObjClass>("Point", nullptr);
+  auto *a = heap.Make<ObjInstance>(klass);
+  auto *b = heap.Make<ObjInstance>(klass);
+  EXPECT_EQ(klass->GetShape(), a->GetShape());
+
+  a->SetField(Name("x"), Value::Number(1));
+  a->SetField(Name("y"), Value::Number(2));
+  b->SetField(Name("x"), Value::Number(3));
+  b->SetField(Name("y"), Value::Number(4));
+  EXPECT_EQ(a->GetShape(), b->GetShape());
+  EXPECT_EQ(2u, a->GetShape()->FieldCount());
+  EXPECT_EQ(1u, a->GetShape()->Find(Name("y")));
+  EXPECT_EQ(Shape::NOT_FOUND, a->GetShape()->Find(Name("z")));
+
+  // Overwriting a field keeps the shape
+  const Shape *shape = a->GetShape();
+  a->SetField(Name("x"), Value::Number(5));
+  EXPECT_EQ(shape, a->GetShape());
+  EXPECT_EQ(5, a->FindField(Name("x"))->AsNumber());
+  EXPECT_EQ(4, b->FindField(Name("y"))->AsNumber());
+}
+
+TEST(SHAPE_TESTS, Field_order_picks_the_shape) {
+  Heap heap;
+  auto *klass = heap.Make<ObjClass>("Point", nullptr);
+  auto *a = heap.Make<ObjInstance>(klass);
+  auto *b = heap.Make<ObjInstance>(klass);
+  a->SetField(Name("x"), Value::Number(1));
+  a->SetField(Name("y"), Value::Number(2));
+  b->SetField(Name("y"), Value::Number(2));
+  b->SetField(Name("x"), Value::Number(1));
+
+  EXPECT_NE(a->GetShape(), b->GetShape());
+  EXPECT_NE(a->GetShape()->Id(), b->GetShape()->Id());
+  EXPECT_EQ(1, b->FindField(Name("x"))->AsNumber());
+}
+
+TEST(SHAPE_TESTS, Fields_past_the_inline_slots) {
+  Heap heap;
+  auto *klass = heap.Make<ObjClass>("Wide", nullptr);
+  auto *instance = heap.Make<ObjInstance>(klass);
+  for (int i = 0; i < 20; i++) {
+    instance->SetField(Name("f" + std::to_string(i)), Value::Number(i));
+  }
+  ASSERT_NE(nullptr, instance->GetShape());
+  for (int i = 0; i < 20; i++) {
+    Value *field = instance->FindField(Name("f" + std::to_string(i)));
+    EXPECT_EQ(i, field->AsNumber());
+  }
+}
+
+TEST(SHAPE_TESTS, Too_many_fields_fall_back_to_a_dictionary) {
+  Heap heap;
+  auto *klass = heap.Make<ObjClass>("Huge", nullptr);
+  auto *instance = heap.Make<ObjInstance>(klass);
+  for (uint32_t i = 0; i <= Shape::MAX_FIELDS; i++) {
+    instance->SetField(Name("f" + std::to_string(i)), Value::Number(i));
+  }
+  EXPECT_EQ(nullptr, instance->GetShape());
+  for (uint32_t i = 0; i <= Shape::MAX_FIELDS; i++) {
+    Value *field = instance->FindField(Name("f" + std::to_string(i)));
+    EXPECT_EQ(i, field->AsNumber());
+  }
+}
+
+TEST(SHAPE_TESTS, Too_many_transitions_fall_back_to_a_dictionary) {
+  Heap heap;
+  auto *klass = heap.Make<ObjClass>("Bag", nullptr);
+  for (size_t i = 0; i < Shape::MAX_TRANSITIONS; i++) {
+    heap.Make<ObjInstance>(klass)->SetField(Name("k" + std::to_string(i)),
+                                            Value::Nil());
+  }
+
+  auto *odd = heap.Make<ObjInstance>(klass);
+  odd->SetField(Name("odd"), Value::Bool(true));
+  EXPECT_EQ(nullptr, odd->GetShape());
+  EXPECT_TRUE(odd->FindField(Name("odd"))->AsBool());
+  EXPECT_EQ(nullptr, odd->FindField(Name("k0")));
+}
+
+// Both engines, with caches that see shapes change under them
+template <typename E>
+class SHAPE_ENGINE_TESTS : public ::testing::Test {
+ protected:
+  static std::string Run(const std::string &source) {
+    return Script<E>(source).Run();
+  }
+};
+
+TYPED_TEST_SUITE(SHAPE_ENGINE_TESTS, Engines);
+
+TYPED_TEST(SHAPE_ENGINE_TESTS, Sites_follow_differently_built_instances) {
+  EXPECT_EQ("3\n30\n300\n",
+            this->Run("class P {}\n"
+                      "fun make(order, x, y) {\n"
+                      "  var p = P();\n"
+                      "  if (order) { p.x = x; p.y = y; }\n"
+                      "  else { p.y = y; p.x = x; }\n"
+                      "  return p;\n"
+                      "}\n"
+                      "fun sum(p) { return p.x + p.y; }\n"
+                      "print sum(make(true, 1, 2));\n"
+                      "print sum(make(false, 10, 20));\n"
+                      "var q = make(true, 100, 0);\n"
+                      "q.y = 200;\n"
+                      "print sum(q);\n"));
+}
+
+TYPED_TEST(SHAPE_ENGINE_TESTS, Dictionary_instances_at_cached_sites) {
+  // The same sites see the shaped instances first, then one that has
+  // left the shape tree
+  std::string fields;
+  for (uint32_t i = 0; i <= Shape::MAX_FIELDS; i++) {
+    fields += "w.f" + std::to_string(i) + " = " + std::to_string(i) + ";\n";
+  }
+  EXPECT_EQ("1\n2\n3\n",
+            this->Run("class V { get() { return this.v; } }\n"
+                      "fun check(o, v) { o.v = v; print o.get(); }\n"
+                      "check(V(), 1);\n"
+                      "check(V(), 2);\n"
+                      "var w = V();\n" +
+                      fields + "check(w, 3);\n"));
+}
+
+}  // namespace
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "Source.hpp"
+
+namespace {
+
+std::string WriteTempFile(const std::string &content) {
+  char path[] = "/tmp/cpplox_source_XXXXXX";
+  int fd = mkstemp(path);
+  close(fd);
+  std::ofstream(path, std::ios::binary) << content;
+  return path;
+}
+
+TEST(SOURCE_TESTS, Map_regular_file) {
+  auto path = WriteTempFile("var car = \"blue\";\n");
+  {
+    Source source(path);
+    EXPECT_TRUE(source.IsMapped());
+    EXPECT_EQ("var car = \"blue\";\n", source.View());
+  }
+  std::remove(path.c_str());
+}
+
+TEST(SOURCE_TESTS, Empty_file) {
+  auto path = WriteTempFile("");
+  {
+    Source source(path);
+    EXPECT_TRUE(source.View().empty());
+  }
+  std::remove(path.c_str());
+}
+
+TEST(SOURCE_TESTS, Read_from_pipe) {
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  const std::string content = "print 1 + 2;";
+  ASSERT_EQ(static_cast<ssize_t>(content.size()),
+            write(fds[1], content.data(), content.size()));
+  close(fds[1]);
+
+  Source source("/dev/fd/" + std::to_string(fds[0]));
+  EXPECT_FALSE(source.IsMapped());
+  EXPECT_EQ(content, source.View());
+  close(fds[0]);
+}
+
+TEST(SOURCE_TESTS, Move_keeps_view) {
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  ASSERT_EQ(3, write(fds[1], "nil", 3));
+  close(fds[1]);
+
+  Source source("/dev/fd/" + std::to_string(fds[0]));
+  Source moved(std::move(source));
+  EXPECT_EQ("nil", moved.View());
+  close(fds[0]);
+}
+
+TEST(SOURCE_TESTS, Missing_file_throws) {
+  EXPECT_THROW(Source("/nonexistent/script.lox"), std::runtime_error);
+}
+
+}  // namespace
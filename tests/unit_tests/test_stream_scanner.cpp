@@ -0,0 +1,81 @@
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Scanner.hpp"
+#include "StreamScanner.hpp"
+
+namespace {
+
+struct Scanned {
+  TokenType type;
+  std::string lexeme;
+  uint32_t line;
+
+  bool operator==(const Scanned &) const = default;
+};
+
+void PrintTo(const Scanned &token, std::ostream *os) {
+  *os << "[line " << token.line << "] " << fmt::format("{}", token.type)
+      << " " << token.lexeme;
+}
+
+std::vector<Scanned> Collect(const TokenBuffer &tokens) {
+  std::vector<Scanned> out;
+  for (size_t i = 0; i < tokens.Size(); i++) {
+    out.push_back({tokens.Type(i), std::string(tokens.Lexeme(i)),
+                   tokens.Line(i)});
+  }
+  return out;
+}
+
+class STREAM_SCANNER_TESTS : public ::testing::TestWithParam<size_t> {
+ protected:
+  void SetUp() override {
+    // Every kind of token that can be cut in half by a chunk boundary
+    for (int i = 0; i < 50; i++) {
+      source += "var identifier_" + std::to_string(i) + " = 12345.678;\n";
+      source += "// a comment long enough to span several tiny chunks\n";
+      source += "print \"a string\nthat spans lines\" + 1.5 >= 2 != 3;\n";
+      source += "if (a <= b / c) { x = 4. ; } // trailing\n";
+    }
+    char name[] = "/tmp/cpplox_stream_XXXXXX";
+    close(mkstemp(name));
+    path = name;
+    std::ofstream(path, std::ios::binary) << source;
+  }
+
+  void TearDown() override { std::remove(path.c_str()); }
+
+  std::string source;
+  std::string path;
+};
+
+TEST_P(STREAM_SCANNER_TESTS, Matches_whole_buffer_scan) {
+  auto whole = Scanner(source);
+  auto expected = Collect(whole.ScanTokens());
+
+  int fd = open(path.c_str(), O_RDONLY);
+  ASSERT_GE(fd, 0);
+  std::vector<Scanned> streamed;
+  StreamScanner scanner(fd, GetParam());
+  scanner.ScanTokens([&](const TokenBuffer &tokens) {
+    auto batch = Collect(tokens);
+    streamed.insert(streamed.end(), batch.begin(), batch.end());
+  });
+  close(fd);
+
+  EXPECT_EQ(expected, streamed);
+  // The window never holds more than a chunk plus one cut-off token
+  EXPECT_LE(scanner.GetPeakWindowSize(), GetParam() + 64);
+}
+
+INSTANTIATE_TEST_SUITE_P(CHUNK_SIZES, STREAM_SCANNER_TESTS,
+                         ::testing::Values(1, 2, 7, 64, 4096));
+
+}  // namespace
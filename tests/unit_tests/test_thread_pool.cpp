@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Scanner.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+
+TEST(THREAD_POOL_TESTS, Runs_every_task) {
+  ThreadPool pool(4);
+  std::atomic<int> sum = 0;
+  for (int i = 1; i <= 1000; i++) {
+    pool.Submit([&sum, i] { sum += i; });
+  }
+  pool.Wait();
+  EXPECT_EQ(500500, sum);
+}
+
+TEST(THREAD_POOL_TESTS, Tasks_can_submit_tasks) {
+  ThreadPool pool(3);
+  std::atomic<int> count = 0;
+  for (int i = 0; i < 10; i++) {
+    pool.Submit([&pool, &count] {
+      for (int j = 0; j < 10; j++) {
+        pool.Submit([&count] { count++; });
+      }
+    });
+  }
+  pool.Wait();
+  EXPECT_EQ(100, count);
+}
+
+TEST(THREAD_POOL_TESTS, Scanners_run_side_by_side) {
+  std::vector<std::string> sources;
+  for (int i = 0; i < 32; i++) {
+    std::string source;
+    for (int line = 0; line <= i; line++) {
+      source += "var x = 1;\n";
+    }
+    sources.push_back(source + "\"unterminated");
+  }
+
+  std::vector<size_t> token_counts(sources.size());
+  std::vector<uint32_t> last_lines(sources.size());
+  // Not vector<bool>, whose elements share bytes between threads
+  std::vector<int> errors(sources.size());
+  ThreadPool pool(4);
+  for (size_t i = 0; i < sources.size(); i++) {
+    pool.Submit([&, i] {
+      std::ostringstream diagnostics;
+      Error error(diagnostics);
+      Scanner scanner(sources[i], &error);
+      const TokenBuffer &tokens = scanner.ScanTokens();
+      token_counts[i] = tokens.Size();
+      last_lines[i] = tokens.Line(tokens.Size() - 1);
+      errors[i] = error.had_error;
+    });
+  }
+  pool.Wait();
+
+  for (size_t i = 0; i < sources.size(); i++) {
+    // Five tokens a line, EOF, and an error for the open string at the end
+    EXPECT_EQ(5 * (i + 1) + 1, token_counts[i]);
+    EXPECT_EQ(i + 2, last_lines[i]);
+    EXPECT_TRUE(errors[i]);
+  }
+}
+
+}  // namespace
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "Scanner.hpp"
+
+namespace {
+
+TEST(TOKEN_BUFFER_TESTS, Keeps_source_order_across_literal_types) {
+  std::string input = "var car = \"blue\" + 4.5;";
+
+  auto scan = Scanner(input);
+  const TokenBuffer &tokens = scan.ScanTokens();
+
+  ASSERT_EQ(8u, tokens.Size());
+  EXPECT_EQ(TokenType::VAR, tokens.Type(0));
+  EXPECT_EQ(TokenType::IDENTIFIER, tokens.Type(1));
+  EXPECT_EQ(TokenType::EQUAL, tokens.Type(2));
+  EXPECT_EQ(TokenType::STRING, tokens.Type(3));
+  EXPECT_EQ(TokenType::PLUS, tokens.Type(4));
+  EXPECT_EQ(TokenType::NUMBER, tokens.Type(5));
+  EXPECT_EQ(TokenType::SEMICOLON, tokens.Type(6));
+  EXPECT_EQ(TokenType::TEOF, tokens.Type(7));
+  EXPECT_EQ("", tokens.Lexeme(7));
+}
+
+TEST(TOKEN_BUFFER_TESTS, Lexemes_and_literals) {
+  std::string input = "print \"blue\" + 4.5 + 10;\nfoo";
+
+  auto scan = Scanner(input);
+  const TokenBuffer &tokens = scan.ScanTokens();
+
+  EXPECT_EQ("print", tokens.Lexeme(0));
+  EXPECT_EQ("\"blue\"", tokens.Lexeme(1));
+  EXPECT_EQ("blue", tokens.String(1));
+  EXPECT_EQ("4.5", tokens.Lexeme(3));
+  EXPECT_DOUBLE_EQ(4.5, tokens.Number(3));
+  EXPECT_DOUBLE_EQ(10.0, tokens.Number(5));
+  EXPECT_EQ(1u, tokens.Line(5));
+  EXPECT_EQ("foo", tokens.Lexeme(7));
+  EXPECT_EQ(2u, tokens.Line(7));
+  EXPECT_EQ(TokenType::TEOF, tokens.Type(tokens.Size() - 1));
+  EXPECT_EQ("IDENTIFIER foo", tokens.Get(7).ToString());
+}
+
+TEST(TOKEN_BUFFER_TESTS, Memory_per_token) {
+  std::string input;
+  for (int i = 0; i < 10000; i++) {
+    input += "var total = total + count * 3.25; // accumulate\n";
+  }
+
+  auto scan = Scanner(input);
+  TokenBuffer tokens = scan.ScanTokens();
+  tokens.ShrinkToFit();
+
+  double bytes_per_token = static_cast<double>(tokens.MemoryUsage()) /
+                           static_cast<double>(tokens.Size());
+  RecordProperty("bytes_per_token", std::to_string(bytes_per_token));
+  std::cout << "[          ] " << bytes_per_token << " bytes per token"
+            << std::endl;
+
+  // 13 bytes of arrays plus 12 bytes for one number in every 10 tokens
+  EXPECT_LE(bytes_per_token, 16.0);
+}
+
+}  // namespace
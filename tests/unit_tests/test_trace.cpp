@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Run.hpp"
+#include "Script.hpp"
+#include "Trace.hpp"
+
+namespace {
+
+const std::string PROGRAM =
+    "fun fib(n) { if (n < 2) return n; return fib(n - 2) + fib(n - 1); }\n"
+    "class Box { init(v) { this.v = v; } get() { return this.v; } }\n"
+    "fun fail(n) { if (n == 0) return nil + 1; return fail(n - 1); }\n"
+    "print fib(3) + Box(1).get();\n"
+    "fail(2);\n";
+
+class TRACE_TESTS : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    char path[] = "/tmp/cpplox_trace_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    _path = path;
+  }
+
+  void TearDown() override { std::remove(_path.c_str()); }
+
+  template <typename E>
+  std::string Trace(const std::string &source) {
+    Script<E> script(source);
+    Tracer tracer(_path);
+    script.Run();
+    EXPECT_EQ(0u, tracer.Depth());
+    tracer.Write();
+    return Read();
+  }
+
+  std::string Read() {
+    std::ifstream file(_path);
+    return std::string(std::istreambuf_iterator<char>(file), {});
+  }
+
+  // The names of the spans in the order they open
+  static std::vector<std::string> Spans(const std::string &trace) {
+    std::vector<std::string> names;
+    const std::string begin = "\"ph\":\"B\"";
+    const std::string name = "\"name\":\"";
+    for (size_t at = trace.find(begin); at != std::string::npos;
+         at = trace.find(begin, at + 1)) {
+      size_t start = trace.find(name, at) + name.size();
+      names.push_back(trace.substr(start, trace.find('"', start) - start));
+    }
+    return names;
+  }
+
+  static size_t Count(const std::string &trace, const std::string &text) {
+    size_t count = 0;
+    for (size_t at = trace.find(text); at != std::string::npos;
+         at = trace.find(text, at + 1)) {
+      count++;
+    }
+    return count;
+  }
+
+  std::string _path;
+};
+
+TEST_F(TRACE_TESTS, Spans_are_off_without_a_tracer) {
+  EXPECT_EQ(nullptr, Tracer::Active());
+  {
+    TraceSpan span("nothing");
+    Tracer outer(_path);
+    EXPECT_EQ(&outer, Tracer::Active());
+    {
+      Tracer inner(_path);
+      EXPECT_EQ(&inner, Tracer::Active());
+    }
+    EXPECT_EQ(&outer, Tracer::Active());
+  }
+  EXPECT_EQ(nullptr, Tracer::Active());
+}
+
+TEST_F(TRACE_TESTS, Tree_walker_traces_calls) {
+  std::string trace = Trace<Interpreter>(PROGRAM);
+  std::vector<std::string> expected = {
+      "resolve", "execute", "fib", "fib", "fib", "fib", "fib",
+      "init",    "get",     "fail", "fail", "fail"};
+  EXPECT_EQ(expected, Spans(trace));
+  // The runtime error left no call open
+  EXPECT_EQ(Count(trace, "\"ph\":\"B\""), Count(trace, "\"ph\":\"E\""));
+}
+
+TEST_F(TRACE_TESTS, VM_traces_calls) {
+  std::string trace = Trace<VM>(PROGRAM);
+  std::vector<std::string> expected = {
+      "compile", "execute", "fib", "fib", "fib", "fib", "fib",
+      "init",    "get",     "fail", "fail", "fail"};
+  EXPECT_EQ(expected, Spans(trace));
+  EXPECT_EQ(Count(trace, "\"ph\":\"B\""), Count(trace, "\"ph\":\"E\""));
+}
+
+TEST_F(TRACE_TESTS, Files_trace_every_phase) {
+  char script[] = "/tmp/cpplox_trace_script_XXXXXX";
+  int fd = mkstemp(script);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  std::ofstream(script) << "var x = 1 + 2;\nfun f() {}\nf();\n";
+
+  Run::Options options;
+  options.trace = _path;
+  options.gc_stress = true;
+  Run::ExecuteFile(script, options);
+  std::remove(script);
+
+  std::string trace = Read();
+  std::vector<std::string> spans = Spans(trace);
+  ASSERT_LE(6u, spans.size());
+  std::vector<std::string> phases(spans.begin(), spans.begin() + 6);
+  std::vector<std::string> expected = {"load", "scan",    "parse",
+                                       "fold", "resolve", "execute"};
+  EXPECT_EQ(expected, phases);
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"tokens\""));
+  // Collector pauses, with the heap size after each
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"collect\""));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"heap bytes\""));
+  EXPECT_EQ(nullptr, Tracer::Active());
+}
+
+TEST_F(TRACE_TESTS, Unwritable_paths_throw) {
+  Tracer tracer("/nonexistent/trace.json");
+  tracer.Begin("open", "phase");
+  EXPECT_THROW(tracer.Write(), std::runtime_error);
+  EXPECT_EQ(0u, tracer.Depth());
+}
+
+}  // namespace
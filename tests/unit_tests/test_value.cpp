@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+
+#include "Heap.hpp"
+#include "Object.hpp"
+#include "Value.hpp"
+
+namespace {
+
+TEST(VALUE_TESTS, Immediates_round_trip) {
+  EXPECT_TRUE(Value::Nil().IsNil());
+  EXPECT_FALSE(Value::Nil().IsBool());
+  EXPECT_FALSE(Value::Nil().IsNumber());
+
+  EXPECT_TRUE(Value::Bool(true).IsBool());
+  EXPECT_TRUE(Value::Bool(true).AsBool());
+  EXPECT_TRUE(Value::Bool(false).IsBool());
+  EXPECT_FALSE(Value::Bool(false).AsBool());
+
+  for (double number : {0.0, -0.0, 1.5, -1e308, 5e-324,
+                        std::numeric_limits<double>::infinity()}) {
+    Value value = Value::Number(number);
+    ASSERT_TRUE(value.IsNumber());
+    EXPECT_FALSE(value.IsObject());
+    EXPECT_EQ(std::signbit(number), std::signbit(value.AsNumber()));
+    EXPECT_EQ(number, value.AsNumber());
+  }
+}
+
+TEST(VALUE_TESTS, Computed_nan_is_still_a_number) {
+  volatile double zero = 0.0;
+  Value value = Value::Number(zero / zero);
+
+  EXPECT_TRUE(value.IsNumber());
+  EXPECT_TRUE(std::isnan(value.AsNumber()));
+  EXPECT_FALSE(ValuesEqual(value, value));
+}
+
+TEST(VALUE_TESTS, Objects_round_trip) {
+  Heap heap;
+  auto *string = heap.Make<ObjString>("lox");
+  Value value = Value::Object(string);
+
+  ASSERT_TRUE(value.IsObject());
+  EXPECT_FALSE(value.IsNumber());
+  EXPECT_FALSE(value.IsNil());
+  EXPECT_EQ(string, value.AsObject());
+  EXPECT_TRUE(IsObjType(value, ObjType::STRING));
+  EXPECT_EQ(1u, heap.ObjectCount());
+}
+
+TEST(VALUE_TESTS, Truthiness_and_equality) {
+  Heap heap;
+  Value a = Value::Object(heap.Make<ObjString>("same"));
+  Value b = Value::Object(heap.Make<ObjString>("same"));
+
+  EXPECT_TRUE(Value::Nil().IsFalsey());
+  EXPECT_TRUE(Value::Bool(false).IsFalsey());
+  EXPECT_FALSE(Value::Number(0).IsFalsey());
+  EXPECT_FALSE(a.IsFalsey());
+
+  EXPECT_TRUE(ValuesEqual(a, b));
+  EXPECT_TRUE(ValuesEqual(Value::Number(0.0), Value::Number(-0.0)));
+  EXPECT_FALSE(ValuesEqual(Value::Nil(), Value::Bool(false)));
+}
+
+TEST(VALUE_TESTS, Stringify) {
+  EXPECT_EQ("nil", Stringify(Value::Nil()));
+  EXPECT_EQ("true", Stringify(Value::Bool(true)));
+  EXPECT_EQ("3", Stringify(Value::Number(3)));
+  EXPECT_EQ("2.5", Stringify(Value::Number(2.5)));
+}
+
+}  // namespace
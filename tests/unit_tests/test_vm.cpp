@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+#include "Chunk.hpp"
+#include "Compiler.hpp"
+#include "Parser.hpp"
+#include "Scanner.hpp"
+#include "VM.hpp"
+
+namespace {
+
+std::string RunOnVM(const std::string &source) {
+  std::ostringstream out;
+  std::ostringstream diagnostics;
+  Error error(diagnostics);
+
+  Scanner scanner(source, &error);
+  Arena arena;
+  Parser parser(scanner.ScanTokens(), arena, error);
+  StmtList statements = parser.Parse();
+  if (!error.had_error) {
+    VM vm(error, out);
+    vm.Interpret(statements);
+  }
+  return out.str() + diagnostics.str();
+}
+
+TEST(VM_TESTS, Chunk_line_table_is_run_length_encoded) {
+  Chunk chunk;
+  chunk.Write(OpCode::NIL, 1);
+  chunk.Write(OpCode::POP, 1);
+  chunk.Write(OpCode::TRUE, 3);
+  chunk.Write(OpCode::RETURN, 7);
+
+  EXPECT_EQ(1u, chunk.GetLine(0));
+  EXPECT_EQ(1u, chunk.GetLine(1));
+  EXPECT_EQ(3u, chunk.GetLine(2));
+  EXPECT_EQ(7u, chunk.GetLine(3));
+}
+
+TEST(VM_TESTS, Chunk_reuses_constants) {
+  Chunk chunk;
+
+  EXPECT_EQ(0u, chunk.AddConstant(Value::Number(1.5)));
+  EXPECT_EQ(1u, chunk.AddConstant(Value::Number(2)));
+  EXPECT_EQ(0u, chunk.AddConstant(Value::Number(1.5)));
+  EXPECT_EQ(2u, chunk.Constants().size());
+}
+
+TEST(VM_TESTS, Compile_errors) {
+  EXPECT_EQ("[line 1] Error at 'return': Can't return from top-level code.\n",
+            RunOnVM("return 1;"));
+  EXPECT_EQ(
+      "[line 1] Error at 'a': Can't read local variable in its own "
+      "initializer.\n",
+      RunOnVM("{ var a = a; }"));
+  EXPECT_EQ(
+      "[line 1] Error at 'a': Already a variable with this name in this "
+      "scope.\n",
+      RunOnVM("{ var a; var a; }"));
+  EXPECT_EQ("[line 1] Error at 'this': Can't use 'this' outside of a class.\n",
+            RunOnVM("print this;"));
+  EXPECT_EQ(
+      "[line 1] Error at 'super': Can't use 'super' in a class with no "
+      "superclass.\n",
+      RunOnVM("class A { f() { super.f(); } }"));
+  EXPECT_EQ(
+      "[line 1] Error at 'return': Can't return a value from an "
+      "initializer.\n",
+      RunOnVM("class A { init() { return 1; } }"));
+}
+
+TEST(VM_TESTS, Deep_recursion_overflows_the_stack) {
+  EXPECT_EQ("Stack overflow.\n[line 1]\n",
+            RunOnVM("fun f() { f(); } f();"));
+}
+
+TEST(VM_TESTS, Globals_survive_between_runs) {
+  std::ostringstream out;
+  Error error(out);
+  VM vm(error, out);
+  Arena arena;
+
+  Scanner first("var a = 1; fun f() { return a + 1; }");
+  vm.Interpret(Parser(first.ScanTokens(), arena, error).Parse());
+  Scanner second("print f();");
+  vm.Interpret(Parser(second.ScanTokens(), arena, error).Parse());
+
+  EXPECT_EQ("2\n", out.str());
+}
+
+}  // namespace